@@ -7,6 +7,7 @@
 #include <string.h>
 #include "libsfp_int.h"
 #include "libsfp_print.h"
+#include "libsfp_cal.h"
 
 /**
  * @brief Create library handle with default parameters
@@ -25,6 +26,8 @@ int libsfp_init(libsfp_t **h)
   H(*h)->a0addr = LIBSFP_DEF_A0_ADDRESS;
   H(*h)->a2addr = LIBSFP_DEF_A2_ADDRESS;
 
+  H(*h)->probe_interval = LIBSFP_DEF_PROBE_INTERVAL;
+
   /* Assign default print callbacks */
   libsfp_print_callbacks_t *cbks = &(H(*h)->print_cb);
   cbks->name = libsfp_printname_default;
@@ -67,6 +70,7 @@ int libsfp_free(libsfp_t *h)
 int libsfp_set_readreg_callback(libsfp_t *h, libsfp_readregs_cb_t readregs)
 {
   H(h)->readregs = readregs;
+  H(h)->cache.state = 0;
   return 0;
 }
 
@@ -101,6 +105,7 @@ int libsfp_set_print_callbacks(libsfp_t *h, const libsfp_print_callbacks_t *clbk
 int libsfp_set_user_data(libsfp_t *h, void *udata)
 {
   H(h)->udata = udata;
+  H(h)->cache.state = 0;
   return 0;
 }
 
@@ -127,10 +132,71 @@ int libsfp_set_addresses(libsfp_t *h, uint8_t a0addr, uint8_t a2addr)
 {
   H(h)->a0addr = a0addr;
   H(h)->a2addr = a2addr;
+  H(h)->cache.state = 0;
+  H(h)->identified = 0;
+  return 0;
+}
+
+/**
+ * @brief Read module registers using read callback
+ *        (split to transactions not longer than handle max_read)
+ * @param h      library handle
+ * @param addr   bank address
+ * @param start  offset in bytes to start reading from
+ * @param count  count of bytes to read
+ * @param data   pointer to buffer to store data
+ * @return 0 on success
+ */
+int libsfp_readregs(libsfp_t *h, uint8_t addr,
+                    uint16_t start, uint16_t count, void *data)
+{
+  uint16_t n;
+
+  if (!H(h)->readregs)
+    return -1;
+
+  if (!H(h)->max_read)
+    return H(h)->readregs(H(h)->udata, addr, start, count, data);
+
+  while (count) {
+    n = (count > H(h)->max_read) ? H(h)->max_read : count;
+    if (H(h)->readregs(H(h)->udata, addr, start, n, data))
+      return -1;
+    start += n;
+    count -= n;
+    data = (uint8_t*)data + n;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Read A0 bank applying module quirks
+ * @param h   library handle
+ * @param a0  struct to store data
+ * @return 0 on success
+ */
+int libsfp_read_a0(libsfp_t *h, libsfp_A0_t *a0)
+{
+  /* Vendor OUI and PN are read first to find out read plan */
+  if (libsfp_quirks_identify(h, a0))
+    return -1;
+
+  if (READREG_A0(h, 0, LIBSFP_OFS_A0_VENDOR_OUI, a0))
+    return -1;
+
+  if (READREG_A0(h, LIBSFP_OFS_A0_VENDOR_REV,
+                 sizeof(libsfp_A0_t) - LIBSFP_OFS_A0_VENDOR_REV,
+                 &a0->base.vendor_rev))
+    return -1;
+
+  H(h)->dmtype = libsfp_quirks_dmtype(libsfp_get_quirk(h),
+                                      a0->ext.diag_mon_type);
+
   return 0;
 }
 
-int libsfp_is_laser_availble(libsfp_base_fields_t *bf)
+int libsfp_is_laser_availble(const libsfp_base_fields_t *bf)
 {
   if ( ((bf->connector >= 0x20) && (bf->connector <= 0x22)) ||
        ((bf->connector >= 0x2) && (bf->connector <= 0x6)) )
@@ -156,45 +222,28 @@ float libsfp_get_offset(libsfp_u16_field_t f)
 
 float libsfp_get_rxpwr(libsfp_u32_field_t f)
 {
-  uint32_t v = ((f.d[0])<<24) | ((f.d[1])<<16) | ((f.d[2])<<8) | (f.d[3]);
-  return (float)v;
+  return libsfp_cal_float(f);
 }
 
-float libsfp_get_temp(libsfp_u16_field_t tf, libsfp_calibration_fields_t *cal)
+float libsfp_get_temp(libsfp_u16_field_t tf, const libsfp_calibration_fields_t *cal)
 {
-  float f;
-
-  f = ((float)((tf.d[0])&0x7F)) + ((float)tf.d[1])/(float)256.0;
-  f = f*(float)((tf.d[0]&0x80)?-1.0:1.0);
-
-  if (cal)
-    f = (libsfp_get_slope(cal->t_slope)*f + libsfp_get_offset(cal->t_offset))/(float)1000.0;
-
-  return f;
+  libsfp_cal_t c;
+  libsfp_cal_init(&c, cal);
+  return libsfp_cal_temp(&c, libsfp_cal_raw(tf));
 }
 
-float libsfp_get_voltage(libsfp_u16_field_t v, libsfp_calibration_fields_t *cal)
+float libsfp_get_voltage(libsfp_u16_field_t v, const libsfp_calibration_fields_t *cal)
 {
-  float f;
-  f = ((float)( (v.d[0] << 8) | v.d[1]))/(float)10000.0;
-
-  if (cal)
-    f = (libsfp_get_slope(cal->v_slope)*f + libsfp_get_offset(cal->v_offset))/(float)10.0;
-
-  return f;
+  libsfp_cal_t c;
+  libsfp_cal_init(&c, cal);
+  return libsfp_cal_voltage(&c, libsfp_cal_raw(v));
 }
 
-float libsfp_get_biascurrent(libsfp_u16_field_t v, libsfp_calibration_fields_t *cal)
+float libsfp_get_biascurrent(libsfp_u16_field_t v, const libsfp_calibration_fields_t *cal)
 {
-  float f;
-  f = ((float)( (v.d[0] << 8) | v.d[1])*(float)0.002);
-
-  if (cal) {
-    f = (libsfp_get_slope(cal->txi_slope)*f +
-         libsfp_get_offset(cal->txi_offset))*(float)0.002;
-  }
-
-  return f;
+  libsfp_cal_t c;
+  libsfp_cal_init(&c, cal);
+  return libsfp_cal_bias(&c, libsfp_cal_raw(v));
 }
 
 /**
@@ -207,15 +256,17 @@ float libsfp_get_biascurrent(libsfp_u16_field_t v, libsfp_calibration_fields_t *
  * @return tx level (mWatt)
  */
 float libsfp_get_txpower(libsfp_u16_field_t v,
-                         libsfp_u16_field_t *slope, libsfp_u16_field_t *ofs)
+                         const libsfp_u16_field_t *slope, const libsfp_u16_field_t *ofs)
 {
-  float f;
-  f = (((float)( (v.d[0] << 8) | v.d[1]))/10000.0f);
+  libsfp_cal_t c;
+  libsfp_cal_init(&c, 0);
 
-  if ((slope) && (ofs))
-    f = (libsfp_get_slope(*slope)*f + libsfp_get_offset(*ofs))/10.0f;
+  if ((slope) && (ofs)) {
+    c.tx_b = libsfp_get_offset(*ofs)*c.tx_k;
+    c.tx_k *= libsfp_get_slope(*slope);
+  }
 
-  return f;
+  return libsfp_cal_txpower(&c, libsfp_cal_raw(v));
 }
 
 /**
@@ -227,20 +278,20 @@ float libsfp_get_txpower(libsfp_u16_field_t v,
  * @return RX power level (mWatts)
  *
  */
-float libsfp_get_rxpower(libsfp_u16_field_t v, libsfp_u32_field_t *rx_pwr)
+float libsfp_get_rxpower(libsfp_u16_field_t v, const libsfp_u32_field_t *rx_pwr)
 {
+  libsfp_cal_t c;
+  float unit;
   int i;
-  float f, sum = 0.0;
-  f = (float)((float)( (v.d[0] << 8) | v.d[1])/10000.0);
-
-  if (rx_pwr) {
-    for (i=0; i<4; ++i)
-      sum += libsfp_get_rxpwr(rx_pwr[i])*f;
-    sum += libsfp_get_rxpwr(rx_pwr[4]);
-    return sum;
-  }
 
-  return f;
+  libsfp_cal_init(&c, 0);
+  unit = c.rx[1];
+
+  if (rx_pwr)
+    for (i = 0; i < 5; ++i)
+      c.rx[4 - i] = libsfp_cal_float(rx_pwr[i])*unit;
+
+  return libsfp_cal_rxpower(&c, libsfp_cal_raw(v));
 }
 
 /**
@@ -249,12 +300,12 @@ float libsfp_get_rxpower(libsfp_u16_field_t v, libsfp_u32_field_t *rx_pwr)
  * @param size data size
  * @return Checksum;
  */
-uint8_t libsfp_calc_csum(void *d, uint16_t size)
+uint8_t libsfp_calc_csum(const void *d, uint16_t size)
 {
   uint16_t i;
   uint32_t csum=0;
   for (i=0; i<size; ++i)
-    csum += ((uint8_t*)d)[i];
+    csum += ((const uint8_t*)d)[i];
   return csum & 0xFF;
 }
 
@@ -287,10 +338,34 @@ int libsfp_is_csums_correct(libsfp_t *h, libsfp_A0_t *a0, libsfp_A2_t *a2)
  */
 int libsfp_readinfo(libsfp_t *h, libsfp_dump_t *dump)
 {
-  if (READREG_A0(h, 0, sizeof(libsfp_A0_t), &dump->a0))
+  libsfp_cache_t *c = &H(h)->cache;
+
+  if (H(h)->flags & LIBSFP_FLAGS_CACHE) {
+
+    if (libsfp_cache_update(h))
+      return -1;
+
+    dump->a0 = c->dump.a0;
+
+    if (c->state & LIBSFP_CACHE_NO_DDM)
+      return 0;
+
+    if (!(c->state & LIBSFP_CACHE_A2_VALID))
+      return -1;
+
+    /* Static part from shadow copy, the rest from module */
+    memcpy(&dump->a2, &c->dump.a2, LIBSFP_OFS_A2_DIAGNOSTICS);
+
+    return READREG_A2(h, LIBSFP_OFS_A2_DIAGNOSTICS,
+                      sizeof(libsfp_A2_t) - LIBSFP_OFS_A2_DIAGNOSTICS,
+                      &dump->a2.dg);
+  }
+
+  if (libsfp_read_a0(h, &dump->a0))
     return -1;
 
-  if (dump->a0.ext.diag_mon_type & LIBSFP_A0_DIAGMON_TYPE_DDM) {
+  /* Dump keeps raw data, quirks only decide whether A2 is read */
+  if (H(h)->dmtype & LIBSFP_A0_DIAGMON_TYPE_DDM) {
 
     if (READREG_A2(h, 0, sizeof(libsfp_A2_t), &dump->a2))
       return -1;
@@ -352,6 +427,17 @@ uint32_t libsfp_bitrate2speed_mode(uint8_t br)
   return smode;
 };
 
+uint32_t libsfp_transceiver2speed_mode(const uint8_t *tr)
+{
+  if ((tr[0]&0xF0))
+    return LIBSFP_SPEED_MODE_10G;
+
+  if ((tr[3]&0x0F))
+    return LIBSFP_SPEED_MODE_1G;
+
+  return LIBSFP_SPEED_MODE_UNKNOWN;
+}
+
 /**
  * @brief Read brief information for SFP module an store it to
  *        specified place
@@ -360,67 +446,114 @@ uint32_t libsfp_bitrate2speed_mode(uint8_t br)
  * @return
  */
 int libsfp_readinfo_brief(libsfp_t *h, libsfp_brief_info_t *info)
+{
+  return libsfp_readinfo_brief_aged(h, 0, info, 0);
+}
+
+/**
+ * @brief Read brief information for SFP module, diagnostic values
+ *        may be taken from handle cache if they are fresh enough
+ * @param h         - library handle
+ * @param max_age   - max acceptable age of diagnostic values (ms)
+ * @param info      - struct to store information
+ * @param timestamp - place to store capture time of diagnostic values
+ *                    (ms, monotonic clock) or 0 if not needed
+ * @return 0 on success
+ */
+int libsfp_readinfo_brief_aged(libsfp_t *h, uint32_t max_age,
+                               libsfp_brief_info_t *info, uint64_t *timestamp)
 {
   uint8_t d[2], dmtype;
-  libsfp_u16_field_t tp, rp;
-  libsfp_u32_field_t rx_pwr[5];
-  libsfp_u16_field_t txpwr_slope, txpwr_offset;
+  libsfp_rtdiagnostics_fields_t *dg = &H(h)->cache.dump.a2.dg;
+  libsfp_calibration_fields_t cl;
+  libsfp_cal_t c;
 
   info->txpower = -1;
   info->rxpower = -1;
 
-  if (READREG_A0(h, LIBSFP_OFS_A0_BR_NOMINAL, 1, d))
+  if (READSTATIC_A0(h, LIBSFP_OFS_A0_BR_NOMINAL, 1, d))
     return -1;
   info->bitrate = d[0]*100;  
   if (libsfp_get_speed_mode(h, &info->spmode))
     return -1;
 
-  if (READREG_A0(h, LIBSFP_OFS_A0_VENDOR_NAME,
+  if (READSTATIC_A0(h, LIBSFP_OFS_A0_VENDOR_NAME,
                     LIBSFP_LEN_A0_VENDOR_NAME, &info->vendor))
     return -1;
   info->vendor[16] = 0;
 
-  if (READREG_A0(h, LIBSFP_OFS_A0_VENDOR_PN,
+  if (READSTATIC_A0(h, LIBSFP_OFS_A0_VENDOR_PN,
                     LIBSFP_LEN_A0_VENDOR_PN, &info->partnum))
     return -1;
   info->partnum[16] = 0;
 
-  if (READREG_A0(h, LIBSFP_OFS_A0_DIAGMON_TYPE, 1, &dmtype))
+  if (libsfp_get_dmtype(h, &dmtype))
     return -1;
 
   if (!(dmtype & LIBSFP_A0_DIAGMON_TYPE_DDM))
     return 0;  
 
-  if (READREG_A2(h, LIBSFP_OFS_A2_DIAGNOSTICS_TXPOWER, 2, &tp))
+  /* Single read of whole diagnostics block (if cached copy is too old) */
+  if (libsfp_cache_read_dynamic(h, LIBSFP_CACHE_VALUES, max_age))
     return -1;
 
-  if (READREG_A2(h, LIBSFP_OFS_A2_DIAGNOSTICS_RXPOWER, 2, &rp))
-    return -1;
+  if (timestamp)
+    (*timestamp) = H(h)->cache.values_time;
 
   if (dmtype & LIBSFP_A0_DIAGMON_TYPE_EXCAL) {
 
     /* Module power Externally calibrated
      * read calibration values */
 
-    if (READREG_A2(h, LIBSFP_OFS_A2_EXT_CAL_RXPWR,
-                   sizeof(rx_pwr), rx_pwr))
+    if (READSTATIC_A2(h, LIBSFP_OFS_A2_EXT_CAL_CONSTANTS, sizeof(cl), &cl))
       return -1;
 
-    if (READREG_A2(h, LIBSFP_OFS_A2_EXT_CAL_TXPWR_SLOPE,
-                   sizeof(txpwr_slope), &txpwr_slope))
-      return -1;
+    libsfp_cal_init(&c, &cl);
 
-    if (READREG_A2(h, LIBSFP_OFS_A2_EXT_CAL_TXPWR_OFFSET,
-                   sizeof(txpwr_offset), &txpwr_offset))
-      return -1;
+  } else
+    libsfp_cal_init(&c, 0);
 
-    info->txpower = libsfp_get_txpower(tp, &txpwr_slope, &txpwr_slope);
-    info->rxpower = libsfp_get_rxpower(rp, rx_pwr);
+  info->txpower = libsfp_cal_txpower(&c, libsfp_cal_raw(dg->tx_power));
+  info->rxpower = libsfp_cal_rxpower(&c, libsfp_cal_raw(dg->rx_power));
 
-  } else {
-    info->txpower = libsfp_get_txpower(tp, 0, 0);
-    info->rxpower = libsfp_get_rxpower(rp, 0);
-  }
+  return 0;
+}
+
+/**
+ * @brief Read real time diagnostics section (values, status and
+ *        alarm/warning flags), data may be taken from handle cache
+ *        if it is fresh enough
+ * @param h         - library handle
+ * @param max_age   - max acceptable age of data (ms)
+ * @param dg        - struct to store information
+ * @param timestamp - place to store capture time of the oldest part
+ *                    of data (ms, monotonic clock) or 0 if not needed
+ * @return 0 on success
+ */
+int libsfp_read_diagnostics_aged(libsfp_t *h, uint32_t max_age,
+                                 libsfp_rtdiagnostics_fields_t *dg,
+                                 uint64_t *timestamp)
+{
+  uint8_t dmtype;
+  libsfp_cache_t *c = &H(h)->cache;
+
+  if (libsfp_get_dmtype(h, &dmtype))
+    return -1;
+
+  if (!(dmtype & LIBSFP_A0_DIAGMON_TYPE_DDM))
+    return -1;
+
+  if (libsfp_cache_read_dynamic(h, LIBSFP_CACHE_VALUES, max_age))
+    return -1;
+
+  if (libsfp_cache_read_dynamic(h, LIBSFP_CACHE_STATUS, max_age))
+    return -1;
+
+  (*dg) = c->dump.a2.dg;
+
+  if (timestamp)
+    (*timestamp) = (c->values_time < c->status_time) ?
+                    c->values_time : c->status_time;
 
   return 0;
 }
@@ -434,24 +567,18 @@ int libsfp_readinfo_brief(libsfp_t *h, libsfp_brief_info_t *info)
 int libsfp_get_speed_mode(libsfp_t *h, uint32_t *smode)
 {
   uint8_t br, tr[8];
-  if (READREG_A0(h, LIBSFP_OFS_A0_BR_NOMINAL, 1, &br))
+  if (READSTATIC_A0(h, LIBSFP_OFS_A0_BR_NOMINAL, 1, &br))
     return -1;
 
   (*smode) = libsfp_bitrate2speed_mode(br);    
 
   if ((*smode) == LIBSFP_SPEED_MODE_UNKNOWN) {
 
-    if (READREG_A0(h, LIBSFP_OFS_A0_TRANSCEIVER,
+    if (READSTATIC_A0(h, LIBSFP_OFS_A0_TRANSCEIVER,
                       LIBSFP_LEN_A0_TRANSCEIVER, tr))
       return -1;
 
-    if ((tr[0]&0xF0)) {
-      (*smode) = LIBSFP_SPEED_MODE_10G;
-      return 0;
-    }
-
-    if ((tr[3]&0x0F))
-      (*smode) = LIBSFP_SPEED_MODE_1G;
+    (*smode) = libsfp_transceiver2speed_mode(tr);
   }
 
   return 0;
@@ -465,7 +592,7 @@ int libsfp_get_speed_mode(libsfp_t *h, uint32_t *smode)
  */
 int libsfp_is_copper_eth(libsfp_t *h, uint8_t *ans)
 {
-  if (READREG_A0(h, LIBSFP_OFS_A0_TRANSCEIVER+3, 1, ans))
+  if (READSTATIC_A0(h, LIBSFP_OFS_A0_TRANSCEIVER+3, 1, ans))
     return -1;
 
   (*ans) = ((*ans) & 0x08) ? 1 : 0;
@@ -483,13 +610,13 @@ int libsfp_is_directattach(libsfp_t *h, uint8_t *ans)
   (*ans) = 0;
   uint8_t v;
 
-  if (READREG_A0(h, LIBSFP_OFS_A0_CONNECTOR, 1, &v))
+  if (READSTATIC_A0(h, LIBSFP_OFS_A0_CONNECTOR, 1, &v))
     return -1;
 
   if (v != LIBSFP_A0_CONNECTOR_COPPER)  /* Cooper */
     return 0;
 
-  if (READREG_A0(h, LIBSFP_OFS_A0_TRANSCEIVER+5, 1, &v)) /* Passive cable */
+  if (READSTATIC_A0(h, LIBSFP_OFS_A0_TRANSCEIVER+5, 1, &v)) /* Passive cable */
     return -1;
 
   if (!(v & 4))
@@ -507,7 +634,7 @@ int libsfp_is_directattach(libsfp_t *h, uint8_t *ans)
  */
 int libsfp_get_copper_length(libsfp_t *h, uint8_t *ans)
 {
-  if (READREG_A0(h, LIBSFP_OFS_A0_LENGTH_CABLE, 1, ans))
+  if (READSTATIC_A0(h, LIBSFP_OFS_A0_LENGTH_CABLE, 1, ans))
     return -1;
 
   return 0;
@@ -525,7 +652,10 @@ int libsfp_get_pins_state(libsfp_t *h, uint8_t *value)
 {
   uint8_t dmtype;
 
-  if (READREG_A0(h, LIBSFP_OFS_A0_DIAGMON_TYPE, 1, &dmtype))
+  if (libsfp_cache_a2_check(h))
+    return -1;
+
+  if (libsfp_get_dmtype(h, &dmtype))
     return -1;
 
   if ((!(dmtype & LIBSFP_A0_DIAGMON_TYPE_DDM)))
@@ -540,6 +670,42 @@ int libsfp_get_pins_state(libsfp_t *h, uint8_t *value)
   return 0;
 }
 
+/**
+ * @brief Get SFP module pins state (if supported), state may be
+ *        taken from handle cache if it is fresh enough
+ * @param h         library handle
+ * @param max_age   max acceptable age of state (ms)
+ * @param value     pointer to bit value\n
+ *                  see LIBSFP_A2_STATUSCONTROL_* constants
+ * @param timestamp place to store capture time of state
+ *                  (ms, monotonic clock) or 0 if not needed
+ * @return 0 on success
+ */
+int libsfp_get_pins_state_aged(libsfp_t *h, uint32_t max_age,
+                               uint8_t *value, uint64_t *timestamp)
+{
+  uint8_t dmtype;
+
+  if (libsfp_get_dmtype(h, &dmtype))
+    return -1;
+
+  if ((!(dmtype & LIBSFP_A0_DIAGMON_TYPE_DDM)))
+    return -1;
+
+  if (libsfp_cache_read_dynamic(h, LIBSFP_CACHE_STATUS, max_age))
+    return -1;
+
+  (*value) = H(h)->cache.dump.a2.dg.status;
+
+  /* Clear bits not corresponding for pin states */
+  (*value) &= ~(LIBSFP_A2_STATUSCONTROL_TXD_SET | LIBSFP_A2_STATUSCONTROL_RS0_SET);
+
+  if (timestamp)
+    (*timestamp) = H(h)->cache.status_time;
+
+  return 0;
+}
+
 /**
  * @brief Set SFP module soft pins (if supported)
  * @param h      library handle
@@ -551,15 +717,18 @@ int libsfp_get_pins_state(libsfp_t *h, uint8_t *value)
  */
 int libsfp_set_soft_pins_state(libsfp_t *h, uint8_t mask, uint8_t value)
 {
-  uint8_t v, m;
+  uint8_t v, m = 0;
 
-  if (READREG_A0(h, LIBSFP_OFS_A0_DIAGMON_TYPE, 1, &v))
+  if (libsfp_cache_a2_check(h))
+    return -1;
+
+  if (libsfp_get_dmtype(h, &v))
     return -1;
 
   if (!(v & LIBSFP_A0_DIAGMON_TYPE_DDM))
     return -1;
 
-  if (READREG_A0(h, LIBSFP_OFS_A0_ENHANCED_OPTIONS, 1, &v))
+  if (READSTATIC_A0(h, LIBSFP_OFS_A0_ENHANCED_OPTIONS, 1, &v))
     return -1;
 
   if (v & LIBSFP_A0_ENHANCED_OPTIONS_TXDIS)
@@ -586,6 +755,9 @@ int libsfp_set_soft_pins_state(libsfp_t *h, uint8_t mask, uint8_t value)
   v &= ~mask;
   v |= value;
 
+  /* Cached status is no longer actual */
+  H(h)->cache.state &= ~LIBSFP_CACHE_STATUS;
+
   if (WRITEREG_A2(h, LIBSFP_OFS_A2_STATUSCONTROL, 1, &v))
     return 1;
 
@@ -96,6 +96,9 @@ typedef struct libsfp_print_callbacks_s {
 #define LIBSFP_FLAGS_PRINT_CSUM         0x80   /**< Print checsum information */
 #define LIBSFP_FLAGS_PRINT_VENDOR       0x100  /**< Print vendor specific data dump */
 #define LIBSFP_FLAGS_CSUM_CHECK         0x200  /**< Check csum after reading */
+#define LIBSFP_FLAGS_CACHE              0x400  /**< Keep shadow copy of static
+                                                    module data (A0 bank, A2
+                                                    thresholds & calibrations) */
 
 
 #define LIBSFP_SPEED_MODE_UNKNOWN   0     /**< Unknown speed */
@@ -106,6 +109,9 @@ typedef struct libsfp_print_callbacks_s {
 #define LIBSFP_DEF_A0_ADDRESS (0xA0>>1)       /**< Default A0 Bank address */
 #define LIBSFP_DEF_A2_ADDRESS (0xA2>>1)       /**< Default A2 Bank address */
 
+#define LIBSFP_DEF_PROBE_INTERVAL 1000        /**< Default shadow cache probe
+                                                   interval (ms) */
+
 /** Main libsfp library handle struct\n
  *  Use only pointer to this type
 */
@@ -181,6 +187,32 @@ int libsfp_set_flags(libsfp_t *h, uint32_t flags);
  */
 int libsfp_set_addresses(libsfp_t *h, uint8_t a0addr, uint8_t a2addr);
 
+/**
+ * @brief Assign shadow cache freshness probe interval\n
+ *        (used with LIBSFP_FLAGS_CACHE flag)
+ * @param h         - library handle
+ * @param interval  - interval (ms), 0 - probe on every access
+ * @return 0 on success
+ */
+int libsfp_set_probe_interval(libsfp_t *h, uint32_t interval);
+
+/**
+ * @brief Check shadow cache freshness now and reload it if needed\n
+ *        Probe reads only identifier, checksums and serial number
+ * @param h  - library handle
+ * @return 0 if cache is fresh, 1 if it was reloaded, -1 on error
+ */
+int libsfp_cache_probe(libsfp_t *h);
+
+/**
+ * @brief Drop shadow cache contents and module quirk\n
+ *        (next access reloads static data and identifies module,
+ *        call when module in cage is changed)
+ * @param h  - library handle
+ * @return 0 on success
+ */
+int libsfp_cache_invalidate(libsfp_t *h);
+
 /**
  * @brief Read and output information selected by flags
  *        as text to specified file
@@ -189,6 +221,14 @@ int libsfp_set_addresses(libsfp_t *h, uint8_t a0addr, uint8_t a2addr);
  */
 int libsfp_showinfo(libsfp_t *h);
 
+/**
+ * @brief Read full SFP module info to memory
+ * @param h    - library handle
+ * @param dump - pointer to memory to store information
+ * @return 0 on success
+ */
+int libsfp_readinfo(libsfp_t *h, libsfp_dump_t *dump);
+
 /**
  * @brief Read brief information for SFP module an store it to
  *        specified place
@@ -198,6 +238,36 @@ int libsfp_showinfo(libsfp_t *h);
  */
 int libsfp_readinfo_brief(libsfp_t *h, libsfp_brief_info_t *info);
 
+/**
+ * @brief Read brief information for SFP module, diagnostic values
+ *        may be taken from handle cache if they are fresh enough
+ * @param h         - library handle
+ * @param max_age   - max acceptable age of diagnostic values (ms)\n
+ *                    0 - always read from module
+ * @param info      - struct to store information
+ * @param timestamp - place to store capture time of diagnostic values
+ *                    (ms, monotonic clock) or 0 if not needed
+ * @return 0 on success
+ */
+int libsfp_readinfo_brief_aged(libsfp_t *h, uint32_t max_age,
+                               libsfp_brief_info_t *info, uint64_t *timestamp);
+
+/**
+ * @brief Read real time diagnostics section (values, status and
+ *        alarm/warning flags), data may be taken from handle cache
+ *        if it is fresh enough
+ * @param h         - library handle
+ * @param max_age   - max acceptable age of data (ms)\n
+ *                    0 - always read from module
+ * @param dg        - struct to store information
+ * @param timestamp - place to store capture time of the oldest part
+ *                    of data (ms, monotonic clock) or 0 if not needed
+ * @return 0 on success
+ */
+int libsfp_read_diagnostics_aged(libsfp_t *h, uint32_t max_age,
+                                 libsfp_rtdiagnostics_fields_t *dg,
+                                 uint64_t *timestamp);
+
 /**
  * @brief Get SFP module max speed (See LIBSFP_SPEED_MODE_* constants)
  * @param h      - library handle
@@ -239,6 +309,21 @@ int libsfp_is_directattach(libsfp_t *h, uint8_t *ans);
  */
 int libsfp_get_pins_state(libsfp_t *h, uint8_t *value);
 
+/**
+ * @brief Get SFP module pins state (if supported), state may be
+ *        taken from handle cache if it is fresh enough
+ * @param h         library handle
+ * @param max_age   max acceptable age of state (ms)\n
+ *                  0 - always read from module
+ * @param value     pointer to bit value\n
+ *                  see LIBSFP_A2_STATUSCONTROL_* constants
+ * @param timestamp place to store capture time of state
+ *                  (ms, monotonic clock) or 0 if not needed
+ * @return 0 on success
+ */
+int libsfp_get_pins_state_aged(libsfp_t *h, uint32_t max_age,
+                               uint8_t *value, uint64_t *timestamp);
+
 /**
  * @brief Set SFP module soft pins (if supported)
  * @param h      library handle
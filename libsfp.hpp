@@ -0,0 +1,307 @@
+#ifndef LIBSFP_HPP__
+#define LIBSFP_HPP__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (header only C++20 layer: zero copy views and RAII handle)
+
+   Views read module memory in place (A0/A2 bytes as read from module
+   or libsfp_dump_t) using register offsets from libsfp_regs.h. All
+   accessors are inline, big endian loads compile to single load and
+   byte swap, conversions use inline libsfp_cal_* functions.
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#include <libsfp.h>
+#include <libsfp_regs.h>
+#include <libsfp_cal.h>
+#include <libsfp_thresh.h>
+#include <libsfp_aw.h>
+
+namespace libsfp {
+
+/** Diagnostic channel */
+enum class channel : uint32_t {
+  temp = LIBSFP_CAL_CH_TEMP,
+  voltage = LIBSFP_CAL_CH_VOLTAGE,
+  bias = LIBSFP_CAL_CH_BIAS,
+  txpower = LIBSFP_CAL_CH_TXPOWER,
+  rxpower = LIBSFP_CAL_CH_RXPOWER
+};
+
+/** Threshold condition */
+enum class condition : uint32_t {
+  alarm_high = LIBSFP_THRESH_ALARM_HIGH,
+  alarm_low = LIBSFP_THRESH_ALARM_LOW,
+  warn_high = LIBSFP_THRESH_WARN_HIGH,
+  warn_low = LIBSFP_THRESH_WARN_LOW
+};
+
+namespace detail {
+
+constexpr uint8_t u8(const std::byte *d, std::size_t ofs) noexcept
+{
+  return std::to_integer<uint8_t>(d[ofs]);
+}
+
+/* Shift form is recognized by compiler as load and byte swap */
+constexpr uint16_t be16(const std::byte *d, std::size_t ofs) noexcept
+{
+  return static_cast<uint16_t>((u8(d, ofs) << 8) | u8(d, ofs + 1));
+}
+
+/* Fixed width ASCII field without trailing spaces and zeroes */
+inline std::string_view ascii(const std::byte *d, std::size_t ofs, std::size_t len) noexcept
+{
+  const char *s = reinterpret_cast<const char*>(d + ofs);
+  while (len && ((s[len - 1] == ' ') || (!s[len - 1])))
+    --len;
+  return std::string_view(s, len);
+}
+
+constexpr uint8_t csum(const std::byte *d, std::size_t ofs, std::size_t len) noexcept
+{
+  uint32_t sum = 0;
+  for (std::size_t i = 0; i < len; ++i)
+    sum += u8(d, ofs + i);
+  return static_cast<uint8_t>(sum);
+}
+
+} // namespace detail
+
+/** Zero copy view of A0 bank (serial ID) */
+class a0_view {
+public:
+  static constexpr std::size_t min_size = LIBSFP_OFS_A0_CC_EXT + LIBSFP_LEN_A0_CC_EXT;
+
+  /** @brief View of fixed size buffer (size is checked at compile time) */
+  template <std::size_t N>
+    requires (N != std::dynamic_extent) && (N >= min_size)
+  constexpr explicit a0_view(std::span<const std::byte, N> s) noexcept : d_(s.data()) {}
+
+  /** @brief View of buffer, empty if buffer is too small */
+  static constexpr std::optional<a0_view> from(std::span<const std::byte> s) noexcept
+  {
+    if (s.size() < min_size)
+      return std::nullopt;
+    return a0_view(s.data());
+  }
+
+  constexpr uint8_t identifier() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_IDENTIFIER); }
+  constexpr uint8_t ext_identifier() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_EXTIDENTIFIER); }
+  constexpr uint8_t connector() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_CONNECTOR); }
+  constexpr uint8_t encoding() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_ENCODING); }
+  constexpr uint8_t rate_identifier() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_RATE_IDENTIFIER); }
+  constexpr uint8_t diag_mon_type() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_DIAGMON_TYPE); }
+  constexpr uint8_t en_options() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_ENHANCED_OPTIONS); }
+  constexpr uint8_t sff8472_comp() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_SFF_8472_COMPLIANCE); }
+  constexpr uint16_t options() const noexcept { return detail::be16(d_, LIBSFP_OFS_A0_OPTIONS); }
+
+  /** @brief Transceiver compliance codes (8 bytes) */
+  constexpr std::span<const std::byte, LIBSFP_LEN_A0_TRANSCEIVER> transceiver() const noexcept
+  {
+    return std::span<const std::byte, LIBSFP_LEN_A0_TRANSCEIVER>(d_ + LIBSFP_OFS_A0_TRANSCEIVER,
+                                                                 LIBSFP_LEN_A0_TRANSCEIVER);
+  }
+
+  /** @brief Nominal bitrate (MBit/s) */
+  constexpr uint32_t bitrate() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_BR_NOMINAL)*100u; }
+
+  /** @brief Laser wavelength (nm) */
+  constexpr uint16_t wavelength() const noexcept { return detail::be16(d_, LIBSFP_OFS_A0_WAVELENGTH); }
+
+  /** @brief Link lengths (m) */
+  constexpr uint32_t length_smf() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_LENGTH_SMF_KM)*1000u; }
+  constexpr uint32_t length_50um() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_LENGTH_50UM)*10u; }
+  constexpr uint32_t length_625um() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_LENGTH_625UM)*10u; }
+  constexpr uint32_t length_cable() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_LENGTH_CABLE); }
+  constexpr uint32_t length_om3() const noexcept { return detail::u8(d_, LIBSFP_OFS_A0_LENGTH_OM3)*10u; }
+
+  constexpr std::array<uint8_t, 3> vendor_oui() const noexcept
+  {
+    return {detail::u8(d_, LIBSFP_OFS_A0_VENDOR_OUI), detail::u8(d_, LIBSFP_OFS_A0_VENDOR_OUI + 1),
+            detail::u8(d_, LIBSFP_OFS_A0_VENDOR_OUI + 2)};
+  }
+
+  std::string_view vendor() const noexcept { return detail::ascii(d_, LIBSFP_OFS_A0_VENDOR_NAME, LIBSFP_LEN_A0_VENDOR_NAME); }
+  std::string_view partnum() const noexcept { return detail::ascii(d_, LIBSFP_OFS_A0_VENDOR_PN, LIBSFP_LEN_A0_VENDOR_PN); }
+  std::string_view revision() const noexcept { return detail::ascii(d_, LIBSFP_OFS_A0_VENDOR_REV, LIBSFP_LEN_A0_VENDOR_REV); }
+  std::string_view serial() const noexcept { return detail::ascii(d_, LIBSFP_OFS_A0_VENDOR_SN, LIBSFP_LEN_A0_VENDOR_SN); }
+  std::string_view date_code() const noexcept { return detail::ascii(d_, LIBSFP_OFS_A0_DATE_CODE, LIBSFP_LEN_A0_DATE_CODE); }
+
+  constexpr bool has_ddm() const noexcept { return diag_mon_type() & LIBSFP_A0_DIAGMON_TYPE_DDM; }
+  constexpr bool external_cal() const noexcept { return diag_mon_type() & LIBSFP_A0_DIAGMON_TYPE_EXCAL; }
+
+  /** @brief Check base (0-62) and extended (64-94) checksums */
+  constexpr bool csum_base_ok() const noexcept
+  {
+    return detail::csum(d_, 0, LIBSFP_OFS_A0_CC_BASE) == detail::u8(d_, LIBSFP_OFS_A0_CC_BASE);
+  }
+  constexpr bool csum_ext_ok() const noexcept
+  {
+    return detail::csum(d_, LIBSFP_OFS_A0_OPTIONS, LIBSFP_OFS_A0_CC_EXT - LIBSFP_OFS_A0_OPTIONS) ==
+           detail::u8(d_, LIBSFP_OFS_A0_CC_EXT);
+  }
+
+  constexpr const std::byte *data() const noexcept { return d_; }
+
+private:
+  constexpr explicit a0_view(const std::byte *d) noexcept : d_(d) {}
+  const std::byte *d_;
+};
+
+/** Zero copy view of A2 bank (diagnostics) */
+class a2_view {
+public:
+  static constexpr std::size_t min_size = LIBSFP_OFS_A2_EXT_STATUS_CONTROL + 1;
+
+  /** @brief View of fixed size buffer (size is checked at compile time) */
+  template <std::size_t N>
+    requires (N != std::dynamic_extent) && (N >= min_size)
+  constexpr explicit a2_view(std::span<const std::byte, N> s) noexcept : d_(s.data()) {}
+
+  /** @brief View of buffer, empty if buffer is too small */
+  static constexpr std::optional<a2_view> from(std::span<const std::byte> s) noexcept
+  {
+    if (s.size() < min_size)
+      return std::nullopt;
+    return a2_view(s.data());
+  }
+
+  /** @brief Raw diagnostic value of channel */
+  constexpr uint16_t raw(channel ch) const noexcept
+  {
+    return detail::be16(d_, LIBSFP_OFS_A2_DIAGNOSTICS + 2*static_cast<std::size_t>(ch));
+  }
+
+  /** @brief Raw threshold (same domain as raw diagnostic value) */
+  constexpr uint16_t threshold(channel ch, condition c) const noexcept
+  {
+    return detail::be16(d_, LIBSFP_OFS_A2_AW_THRESHOLDS +
+                            8*static_cast<std::size_t>(ch) + 2*static_cast<std::size_t>(c));
+  }
+
+  constexpr uint8_t status() const noexcept { return detail::u8(d_, LIBSFP_OFS_A2_STATUSCONTROL); }
+  constexpr uint16_t alarms() const noexcept { return detail::be16(d_, LIBSFP_OFS_A2_ALARM_FLAGS); }
+  constexpr uint16_t warnings() const noexcept { return detail::be16(d_, LIBSFP_OFS_A2_WARNING_FLAGS); }
+
+  /** @brief Packed alarm, warning and status bits (see libsfp_aw_mask) */
+  uint32_t aw_mask() const noexcept
+  {
+    libsfp_rtdiagnostics_fields_t dg{};
+    std::memcpy(&dg, d_ + LIBSFP_OFS_A2_DIAGNOSTICS, min_size - LIBSFP_OFS_A2_DIAGNOSTICS);
+    return libsfp_aw_mask(&dg);
+  }
+
+  /** @brief Build calibration object (once per module, not inline) */
+  libsfp_cal_t cal(bool external) const noexcept
+  {
+    libsfp_cal_t c;
+    if (external) {
+      libsfp_calibration_fields_t cl;
+      std::memcpy(&cl, d_ + LIBSFP_OFS_A2_EXT_CAL_CONSTANTS, sizeof(cl));
+      libsfp_cal_init(&c, &cl);
+    } else
+      libsfp_cal_init(&c, 0);
+    return c;
+  }
+
+  float temperature(const libsfp_cal_t &c) const noexcept { return libsfp_cal_temp(&c, raw(channel::temp)); }
+  float voltage(const libsfp_cal_t &c) const noexcept { return libsfp_cal_voltage(&c, raw(channel::voltage)); }
+  float bias(const libsfp_cal_t &c) const noexcept { return libsfp_cal_bias(&c, raw(channel::bias)); }
+  float txpower(const libsfp_cal_t &c) const noexcept { return libsfp_cal_txpower(&c, raw(channel::txpower)); }
+  float rxpower(const libsfp_cal_t &c) const noexcept { return libsfp_cal_rxpower(&c, raw(channel::rxpower)); }
+
+  /** @brief Check DMI checksum (0-94) */
+  constexpr bool csum_dmi_ok() const noexcept
+  {
+    return detail::csum(d_, 0, LIBSFP_OFS_A2_CC_DMI) == detail::u8(d_, LIBSFP_OFS_A2_CC_DMI);
+  }
+
+  constexpr const std::byte *data() const noexcept { return d_; }
+
+private:
+  constexpr explicit a2_view(const std::byte *d) noexcept : d_(d) {}
+  const std::byte *d_;
+};
+
+/** @brief Views of A0 and A2 banks of libsfp_dump_t (no copy) */
+inline a0_view view_a0(const libsfp_dump_t &dump) noexcept
+{
+  return a0_view(std::as_bytes(std::span<const libsfp_A0_t, 1>(&dump.a0, 1)));
+}
+
+inline a2_view view_a2(const libsfp_dump_t &dump) noexcept
+{
+  return a2_view(std::as_bytes(std::span<const libsfp_A2_t, 1>(&dump.a2, 1)));
+}
+
+/** RAII library handle */
+class handle {
+public:
+  /** @brief Create handle, throws std::bad_alloc on failure */
+  handle() : h_(libsfp_create())
+  {
+    if (!h_)
+      throw std::bad_alloc();
+  }
+
+  /** @brief Take ownership of existing handle */
+  explicit handle(libsfp_t *h) noexcept : h_(h) {}
+
+  handle(const handle&) = delete;
+  handle &operator=(const handle&) = delete;
+
+  handle(handle &&o) noexcept : h_(std::exchange(o.h_, nullptr)) {}
+
+  handle &operator=(handle &&o) noexcept
+  {
+    if (this != &o)
+      reset(std::exchange(o.h_, nullptr));
+    return *this;
+  }
+
+  ~handle() { reset(); }
+
+  /** @brief Free owned handle and take other one */
+  void reset(libsfp_t *h = nullptr) noexcept
+  {
+    if (h_)
+      libsfp_free(h_);
+    h_ = h;
+  }
+
+  /** @brief Give up ownership */
+  libsfp_t *release() noexcept { return std::exchange(h_, nullptr); }
+
+  libsfp_t *get() const noexcept { return h_; }
+  explicit operator bool() const noexcept { return h_; }
+
+  /** @brief Read module identity and diagnostics
+   *  @return 0 on success */
+  int readinfo(libsfp_dump_t &dump) const noexcept { return libsfp_readinfo(h_, &dump); }
+
+  /** @brief Read packed alarm, warning and status bits
+   *  @return 0 on success */
+  int aw_mask(uint32_t max_age, uint32_t &mask) const noexcept
+  {
+    return libsfp_get_aw_mask(h_, max_age, &mask);
+  }
+
+private:
+  libsfp_t *h_;
+};
+
+} // namespace libsfp
+
+#endif
@@ -0,0 +1,313 @@
+/**
+   @file
+   @brief libsfp packed alarm/warning mask and fleet bitsets
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "libsfp_int.h"
+#include "libsfp_aw.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LIBSFP_AW_X86
+#endif
+
+#define LIBSFP_AW_VWORDS  4     /**< Words in widest vector (AVX2) */
+
+/* Bitset operations implementation */
+#define LIBSFP_BITSET_SCALAR  1
+#define LIBSFP_BITSET_SSE2    2
+#define LIBSFP_BITSET_AVX2    3
+
+static int libsfp_bitset_impl;
+static pthread_once_t libsfp_bitset_once = PTHREAD_ONCE_INIT;
+
+typedef struct {
+  uint64_t *bits;               /** Bitsets of mask bits */
+  uint64_t *tmp;                /** Scratch bitset */
+  uint32_t *masks;              /** Masks of ports */
+  uint32_t nports;              /** Number of ports */
+  size_t words;                 /** Words in bitset */
+} libsfp_awset_int_t;
+
+#define AS(ptr) ((libsfp_awset_int_t*)(ptr))
+
+/**
+ * @brief Pack alarm, warning and status bits of diagnostics section
+ * @param dg  - diagnostics section as read from module
+ * @return mask
+ */
+uint32_t libsfp_aw_mask(const libsfp_rtdiagnostics_fields_t *dg)
+{
+  uint32_t a = (dg->alarms[0] << 8) | dg->alarms[1];
+  uint32_t w = (dg->warnings[0] << 8) | dg->warnings[1];
+  uint32_t ch, m = 0;
+
+  /* Flags go from MSB: high and low bits of every channel */
+  for (ch = 0; ch < LIBSFP_CAL_CHANNELS; ++ch) {
+    m |= ((a >> (15 - 2*ch)) & 1) << (ch*4 + LIBSFP_THRESH_ALARM_HIGH);
+    m |= ((a >> (14 - 2*ch)) & 1) << (ch*4 + LIBSFP_THRESH_ALARM_LOW);
+    m |= ((w >> (15 - 2*ch)) & 1) << (ch*4 + LIBSFP_THRESH_WARN_HIGH);
+    m |= ((w >> (14 - 2*ch)) & 1) << (ch*4 + LIBSFP_THRESH_WARN_LOW);
+  }
+
+  return m | LIBSFP_AW_STATUS(dg->status);
+}
+
+/**
+ * @brief Get packed alarm, warning and status bits of module,
+ *        data may be taken from handle cache if it is fresh enough
+ * @param h        - library handle
+ * @param max_age  - max acceptable age of data (ms)\n
+ *                   0 - always read from module
+ * @param mask     - place to store mask
+ * @return 0 on success
+ */
+int libsfp_get_aw_mask(libsfp_t *h, uint32_t max_age, uint32_t *mask)
+{
+  libsfp_rtdiagnostics_fields_t dg;
+
+  if (libsfp_read_diagnostics_aged(h, max_age, &dg, 0))
+    return -1;
+
+  (*mask) = libsfp_aw_mask(&dg);
+
+  return 0;
+}
+
+static void libsfp_bitset_select(void)
+{
+  libsfp_bitset_impl = LIBSFP_BITSET_SCALAR;
+#ifdef LIBSFP_AW_X86
+  if (__builtin_cpu_supports("avx2"))
+    libsfp_bitset_impl = LIBSFP_BITSET_AVX2;
+  else if (__builtin_cpu_supports("sse2"))
+    libsfp_bitset_impl = LIBSFP_BITSET_SSE2;
+#endif
+}
+
+/* Binary operation in every implementation and its dispatcher */
+#ifdef LIBSFP_AW_X86
+#define LIBSFP_BITSET_OP(name, expr, sse2, avx2)                            \
+__attribute__((target("sse2")))                                            \
+static size_t libsfp_bitset_##name##_sse2(uint64_t *dst, const uint64_t *a, \
+                                          const uint64_t *b, size_t n)      \
+{                                                                           \
+  size_t i;                                                                 \
+  for (i = 0; i + 2 <= n; i += 2)                                           \
+    _mm_storeu_si128((__m128i*)(dst + i),                                   \
+      sse2(_mm_loadu_si128((const __m128i*)(a + i)),                        \
+           _mm_loadu_si128((const __m128i*)(b + i))));                      \
+  return i;                                                                 \
+}                                                                           \
+__attribute__((target("avx2")))                                            \
+static size_t libsfp_bitset_##name##_avx2(uint64_t *dst, const uint64_t *a, \
+                                          const uint64_t *b, size_t n)      \
+{                                                                           \
+  size_t i;                                                                 \
+  for (i = 0; i + 4 <= n; i += 4)                                           \
+    _mm256_storeu_si256((__m256i*)(dst + i),                                \
+      avx2(_mm256_loadu_si256((const __m256i*)(a + i)),                     \
+           _mm256_loadu_si256((const __m256i*)(b + i))));                   \
+  return i;                                                                 \
+}                                                                           \
+void libsfp_bitset_##name(uint64_t *dst, const uint64_t *a,                 \
+                          const uint64_t *b, size_t n)                      \
+{                                                                           \
+  size_t i = 0;                                                             \
+  pthread_once(&libsfp_bitset_once, libsfp_bitset_select);                  \
+  if (libsfp_bitset_impl == LIBSFP_BITSET_AVX2)                             \
+    i = libsfp_bitset_##name##_avx2(dst, a, b, n);                          \
+  else if (libsfp_bitset_impl == LIBSFP_BITSET_SSE2)                        \
+    i = libsfp_bitset_##name##_sse2(dst, a, b, n);                          \
+  for (; i < n; ++i)                                                        \
+    dst[i] = expr;                                                          \
+}
+#else
+#define LIBSFP_BITSET_OP(name, expr, sse2, avx2)                            \
+void libsfp_bitset_##name(uint64_t *dst, const uint64_t *a,                 \
+                          const uint64_t *b, size_t n)                      \
+{                                                                           \
+  size_t i;                                                                 \
+  for (i = 0; i < n; ++i)                                                   \
+    dst[i] = expr;                                                          \
+}
+#endif
+
+/* andnot intrinsics calc ~x & y */
+#define LIBSFP_SSE2_ANDNOT(x, y)  _mm_andnot_si128(y, x)
+#define LIBSFP_AVX2_ANDNOT(x, y)  _mm256_andnot_si256(y, x)
+
+LIBSFP_BITSET_OP(and, a[i] & b[i], _mm_and_si128, _mm256_and_si256)
+LIBSFP_BITSET_OP(or, a[i] | b[i], _mm_or_si128, _mm256_or_si256)
+LIBSFP_BITSET_OP(andnot, a[i] & ~b[i], LIBSFP_SSE2_ANDNOT, LIBSFP_AVX2_ANDNOT)
+
+#ifdef LIBSFP_AW_X86
+/* Popcount of bytes by nibble lookup, summed by SAD */
+__attribute__((target("avx2")))
+static size_t libsfp_bitset_count_avx2(const uint64_t *a, size_t n, uint64_t *cnt)
+{
+  const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                       0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low = _mm256_set1_epi8(0x0F);
+  __m256i v, c, sum = _mm256_setzero_si256();
+  uint64_t s[4];
+  size_t i;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    v = _mm256_loadu_si256((const __m256i*)(a + i));
+    c = _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(v, low)),
+                        _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+    sum = _mm256_add_epi64(sum, _mm256_sad_epu8(c, _mm256_setzero_si256()));
+  }
+
+  /* 64 bit lane extract is x86_64 only */
+  _mm256_storeu_si256((__m256i*)s, sum);
+  (*cnt) = s[0] + s[1] + s[2] + s[3];
+
+  return i;
+}
+#endif
+
+/**
+ * @brief Count set bits
+ * @param a  - bitset
+ * @param n  - number of 64 bit words
+ * @return number of set bits
+ */
+uint32_t libsfp_bitset_count(const uint64_t *a, size_t n)
+{
+  uint64_t cnt = 0;
+  size_t i = 0;
+
+#ifdef LIBSFP_AW_X86
+  pthread_once(&libsfp_bitset_once, libsfp_bitset_select);
+  if (libsfp_bitset_impl == LIBSFP_BITSET_AVX2)
+    i = libsfp_bitset_count_avx2(a, n, &cnt);
+#endif
+
+  for (; i < n; ++i)
+    cnt += __builtin_popcountll(a[i]);
+
+  return cnt;
+}
+
+/**
+ * @brief Create fleet bitsets
+ * @param nports  - number of ports
+ * @return bitsets handle or 0 if error occured
+ */
+libsfp_awset_t *libsfp_awset_create(uint32_t nports)
+{
+  libsfp_awset_int_t *s;
+  size_t size;
+
+  s = malloc(sizeof(libsfp_awset_int_t));
+  if (!s)
+    return 0;
+
+  /* Bitsets are padded to whole vectors */
+  s->nports = nports;
+  s->words = ((nports + 63)/64 + LIBSFP_AW_VWORDS - 1) & ~(LIBSFP_AW_VWORDS - 1);
+  if (!s->words)
+    s->words = LIBSFP_AW_VWORDS;
+
+  size = (LIBSFP_AW_BITS + 1)*s->words*sizeof(uint64_t) + nports*sizeof(uint32_t);
+  if (posix_memalign((void**)&s->bits, 64, size)) {
+    free(s);
+    return 0;
+  }
+  memset(s->bits, 0, size);
+
+  s->tmp = s->bits + LIBSFP_AW_BITS*s->words;
+  s->masks = (uint32_t*)(s->tmp + s->words);
+
+  return (libsfp_awset_t*)s;
+}
+
+/**
+ * @brief Free fleet bitsets and its memory
+ * @param s  - bitsets handle
+ * @return 0 on success
+ */
+int libsfp_awset_free(libsfp_awset_t *s)
+{
+  free(AS(s)->bits);
+  free(s);
+  return 0;
+}
+
+/**
+ * @brief Get number of 64 bit words in every bitset
+ * @param s  - bitsets handle
+ * @return number of words
+ */
+size_t libsfp_awset_words(libsfp_awset_t *s)
+{
+  return AS(s)->words;
+}
+
+/**
+ * @brief Set mask of port
+ * @param s     - bitsets handle
+ * @param port  - port number
+ * @param mask  - mask (see libsfp_aw_mask)
+ * @return 0 on success
+ */
+int libsfp_awset_set(libsfp_awset_t *s, uint32_t port, uint32_t mask)
+{
+  uint32_t diff, bit;
+
+  if (port >= AS(s)->nports)
+    return -1;
+
+  mask &= (1u << LIBSFP_AW_BITS) - 1;
+
+  /* Only changed bits are touched */
+  for (diff = AS(s)->masks[port] ^ mask; diff; diff &= diff - 1) {
+    bit = __builtin_ctz(diff);
+    AS(s)->bits[bit*AS(s)->words + port/64] ^= 1ull << (port % 64);
+  }
+
+  AS(s)->masks[port] = mask;
+
+  return 0;
+}
+
+/**
+ * @brief Get bitset of mask bit (bit n is set if port n has it)
+ * @param s    - bitsets handle
+ * @param bit  - mask bit number
+ * @return bitset of libsfp_awset_words words or 0 if bit is wrong
+ */
+const uint64_t *libsfp_awset_bits(libsfp_awset_t *s, uint32_t bit)
+{
+  if (bit >= LIBSFP_AW_BITS)
+    return 0;
+  return AS(s)->bits + bit*AS(s)->words;
+}
+
+/**
+ * @brief Find ports having any bit of mask
+ * @param s     - bitsets handle
+ * @param mask  - mask bits
+ * @param out   - bitset (libsfp_awset_words words) to store ports or 0
+ * @return number of found ports
+ */
+uint32_t libsfp_awset_select(libsfp_awset_t *s, uint32_t mask, uint64_t *out)
+{
+  if (!out)
+    out = AS(s)->tmp;
+
+  memset(out, 0, AS(s)->words*sizeof(uint64_t));
+
+  mask &= (1u << LIBSFP_AW_BITS) - 1;
+
+  for (; mask; mask &= mask - 1)
+    libsfp_bitset_or(out, out, libsfp_awset_bits(s, __builtin_ctz(mask)),
+                     AS(s)->words);
+
+  return libsfp_bitset_count(out, AS(s)->words);
+}
@@ -0,0 +1,154 @@
+#ifndef LIBSFP_AW_H__
+#define LIBSFP_AW_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (packed alarm/warning mask and fleet bitsets)
+
+   All alarm, warning and status bits of module are packed to one
+   32 bit mask:\n
+   bits 0-19  - channel*4 + condition (same layout as libsfp_thresh,
+                see LIBSFP_THRESH_BIT)\n
+   bits 20-27 - status byte (A2 byte 110, see LIBSFP_A2_STATUSCONTROL_*)
+
+   Fleet bitsets keep one bit per port for every mask bit, so
+   conditions of all ports are checked with few vector operations.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <libsfp.h>
+#include <libsfp_thresh.h>
+
+#define LIBSFP_AW_BITS          28    /**< Number of used mask bits */
+#define LIBSFP_AW_STATUS_SHIFT  20    /**< Position of status byte */
+
+/** Status bit (LIBSFP_A2_STATUSCONTROL_*) in mask */
+#define LIBSFP_AW_STATUS(b)    ((uint32_t)(b) << LIBSFP_AW_STATUS_SHIFT)
+
+/** Alarm (high and low) bits of channel (LIBSFP_CAL_CH_*) */
+#define LIBSFP_AW_ALARM(ch)    (LIBSFP_THRESH_BIT(ch, LIBSFP_THRESH_ALARM_HIGH) | \
+                                LIBSFP_THRESH_BIT(ch, LIBSFP_THRESH_ALARM_LOW))
+
+/** Warning (high and low) bits of channel (LIBSFP_CAL_CH_*) */
+#define LIBSFP_AW_WARNING(ch)  (LIBSFP_THRESH_BIT(ch, LIBSFP_THRESH_WARN_HIGH) | \
+                                LIBSFP_THRESH_BIT(ch, LIBSFP_THRESH_WARN_LOW))
+
+#define LIBSFP_AW_ALARMS    0x33333     /**< All alarm bits */
+#define LIBSFP_AW_WARNINGS  0xCCCCC     /**< All warning bits */
+
+/** Fleet bitsets handle\n
+ *  Use only pointer to this type
+*/
+typedef struct {
+} libsfp_awset_t;
+
+/**
+ * @brief Pack alarm, warning and status bits of diagnostics section
+ * @param dg  - diagnostics section as read from module
+ * @return mask
+ */
+uint32_t libsfp_aw_mask(const libsfp_rtdiagnostics_fields_t *dg);
+
+/**
+ * @brief Get packed alarm, warning and status bits of module,
+ *        data may be taken from handle cache if it is fresh enough
+ * @param h        - library handle
+ * @param max_age  - max acceptable age of data (ms)\n
+ *                   0 - always read from module
+ * @param mask     - place to store mask
+ * @return 0 on success
+ */
+int libsfp_get_aw_mask(libsfp_t *h, uint32_t max_age, uint32_t *mask);
+
+/**
+ * @brief Create fleet bitsets
+ * @param nports  - number of ports
+ * @return bitsets handle or 0 if error occured
+ */
+libsfp_awset_t *libsfp_awset_create(uint32_t nports);
+
+/**
+ * @brief Free fleet bitsets and its memory
+ * @param s  - bitsets handle
+ * @return 0 on success
+ */
+int libsfp_awset_free(libsfp_awset_t *s);
+
+/**
+ * @brief Get number of 64 bit words in every bitset
+ * @param s  - bitsets handle
+ * @return number of words
+ */
+size_t libsfp_awset_words(libsfp_awset_t *s);
+
+/**
+ * @brief Set mask of port
+ * @param s     - bitsets handle
+ * @param port  - port number
+ * @param mask  - mask (see libsfp_aw_mask)
+ * @return 0 on success
+ */
+int libsfp_awset_set(libsfp_awset_t *s, uint32_t port, uint32_t mask);
+
+/**
+ * @brief Get bitset of mask bit (bit n is set if port n has it)
+ * @param s    - bitsets handle
+ * @param bit  - mask bit number
+ * @return bitset of libsfp_awset_words words or 0 if bit is wrong
+ */
+const uint64_t *libsfp_awset_bits(libsfp_awset_t *s, uint32_t bit);
+
+/**
+ * @brief Find ports having any bit of mask
+ * @param s     - bitsets handle
+ * @param mask  - mask bits
+ * @param out   - bitset (libsfp_awset_words words) to store ports or 0
+ * @return number of found ports
+ */
+uint32_t libsfp_awset_select(libsfp_awset_t *s, uint32_t mask, uint64_t *out);
+
+/**
+ * @brief dst = a & b
+ * @param dst  - result bitset (may be same as a or b)
+ * @param a    - bitset
+ * @param b    - bitset
+ * @param n    - number of 64 bit words
+ */
+void libsfp_bitset_and(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t n);
+
+/**
+ * @brief dst = a | b
+ * @param dst  - result bitset (may be same as a or b)
+ * @param a    - bitset
+ * @param b    - bitset
+ * @param n    - number of 64 bit words
+ */
+void libsfp_bitset_or(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t n);
+
+/**
+ * @brief dst = a & ~b
+ * @param dst  - result bitset (may be same as a or b)
+ * @param a    - bitset
+ * @param b    - bitset
+ * @param n    - number of 64 bit words
+ */
+void libsfp_bitset_andnot(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t n);
+
+/**
+ * @brief Count set bits
+ * @param a  - bitset
+ * @param n  - number of 64 bit words
+ * @return number of set bits
+ */
+uint32_t libsfp_bitset_count(const uint64_t *a, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,347 @@
+/**
+   @file
+   @brief libsfp SIMD batch conversion of diagnostic values
+
+   Every implementation does the same float operations in the same
+   order (separate multiply and add, library is built without
+   contraction to FMA), so results are identical. Scalar implementation
+   is the reference: it does not use inline conversions of libsfp_cal.h
+   which are compiled with flags of the caller.
+*/
+
+#include <pthread.h>
+#include "libsfp_int.h"
+#include "libsfp_cal.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LIBSFP_BATCH_X86
+#endif
+
+/* ARMv7 NEON flushes subnormals to zero, so only AArch64 Advanced SIMD
+   gives results identical to scalar */
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define LIBSFP_BATCH_NEON
+#endif
+
+/* Calibration is accessed as array of floats */
+#define LIBSFP_CAL_NFLOATS  (sizeof(libsfp_cal_t)/sizeof(float))
+_Static_assert(sizeof(libsfp_cal_t) == 13*sizeof(float),
+               "libsfp_cal_t must contain only floats");
+
+/* Index of channel slope in calibration (offset follows it) */
+static const uint8_t libsfp_batch_kofs[LIBSFP_CAL_CHANNELS] = {
+  offsetof(libsfp_cal_t, t_k)/sizeof(float),
+  offsetof(libsfp_cal_t, v_k)/sizeof(float),
+  offsetof(libsfp_cal_t, i_k)/sizeof(float),
+  offsetof(libsfp_cal_t, tx_k)/sizeof(float),
+  offsetof(libsfp_cal_t, rx)/sizeof(float)
+};
+
+typedef void (*libsfp_batch_kernel_t)(uint32_t ch, const libsfp_cal_t *cal,
+                                      const libsfp_u16_field_t *raw,
+                                      float *out, size_t n);
+
+static libsfp_cal_t libsfp_batch_identity;
+static libsfp_batch_kernel_t libsfp_batch_kernel;
+static pthread_once_t libsfp_batch_once = PTHREAD_ONCE_INIT;
+
+static void libsfp_batch_scalar(uint32_t ch, const libsfp_cal_t *cal,
+                                const libsfp_u16_field_t *raw,
+                                float *out, size_t n)
+{
+  const float *c = (const float*)&libsfp_batch_identity;
+  uint32_t k = libsfp_batch_kofs[ch];
+  float x, r;
+  size_t i;
+
+  for (i = 0; i < n; ++i) {
+
+    if (cal)
+      c = (const float*)&cal[i];
+
+    /* Temperature is signed */
+    if (ch == LIBSFP_CAL_CH_TEMP)
+      x = (float)(int16_t)libsfp_cal_raw(raw[i]);
+    else
+      x = (float)libsfp_cal_raw(raw[i]);
+
+    if (ch == LIBSFP_CAL_CH_RXPOWER) {
+      r = c[k + 4]*x + c[k + 3];
+      r = r*x + c[k + 2];
+      r = r*x + c[k + 1];
+      r = r*x + c[k];
+    } else
+      r = c[k]*x + c[k + 1];
+
+    out[i] = r;
+  }
+}
+
+#ifdef LIBSFP_BATCH_X86
+
+/* Load 4 big endian values as floats */
+__attribute__((target("sse2")))
+static __m128 libsfp_batch_load_sse2(uint32_t ch, const libsfp_u16_field_t *raw)
+{
+  __m128i v;
+
+  v = _mm_loadl_epi64((const __m128i*)raw);
+  v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+
+  /* Temperature is signed */
+  if (ch == LIBSFP_CAL_CH_TEMP)
+    v = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+  else
+    v = _mm_unpacklo_epi16(v, _mm_setzero_si128());
+
+  return _mm_cvtepi32_ps(v);
+}
+
+/* Load coefficient of 4 ports */
+__attribute__((target("sse2")))
+static __m128 libsfp_batch_coef_sse2(const libsfp_cal_t *cal, uint32_t k)
+{
+  const float *f = (const float*)cal;
+  return _mm_set_ps(f[3*LIBSFP_CAL_NFLOATS + k], f[2*LIBSFP_CAL_NFLOATS + k],
+                    f[LIBSFP_CAL_NFLOATS + k], f[k]);
+}
+
+__attribute__((target("sse2")))
+static void libsfp_batch_sse2(uint32_t ch, const libsfp_cal_t *cal,
+                              const libsfp_u16_field_t *raw,
+                              float *out, size_t n)
+{
+  const float *id = (const float*)&libsfp_batch_identity;
+  uint32_t k = libsfp_batch_kofs[ch];
+  __m128 x, r, c[5];
+  size_t i;
+  int j;
+
+  for (j = 0; j < 5; ++j)
+    c[j] = _mm_set1_ps(id[k + j]);
+
+  for (i = 0; i + 4 <= n; i += 4) {
+
+    x = libsfp_batch_load_sse2(ch, raw + i);
+
+    if (cal)
+      for (j = 0; j < ((ch == LIBSFP_CAL_CH_RXPOWER) ? 5 : 2); ++j)
+        c[j] = libsfp_batch_coef_sse2(cal + i, k + j);
+
+    if (ch == LIBSFP_CAL_CH_RXPOWER) {
+      r = _mm_add_ps(_mm_mul_ps(c[4], x), c[3]);
+      r = _mm_add_ps(_mm_mul_ps(r, x), c[2]);
+      r = _mm_add_ps(_mm_mul_ps(r, x), c[1]);
+      r = _mm_add_ps(_mm_mul_ps(r, x), c[0]);
+    } else
+      r = _mm_add_ps(_mm_mul_ps(c[0], x), c[1]);
+
+    _mm_storeu_ps(out + i, r);
+  }
+
+  libsfp_batch_scalar(ch, (cal) ? cal + i : 0, raw + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void libsfp_batch_avx2(uint32_t ch, const libsfp_cal_t *cal,
+                              const libsfp_u16_field_t *raw,
+                              float *out, size_t n)
+{
+  const float *id = (const float*)&libsfp_batch_identity;
+  const __m128i swap = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9,
+                                    6, 7, 4, 5, 2, 3, 0, 1);
+  const __m256i idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                         _mm256_set1_epi32(LIBSFP_CAL_NFLOATS));
+  uint32_t k = libsfp_batch_kofs[ch];
+  __m128i v;
+  __m256 x, r, c[5];
+  size_t i;
+  int j;
+
+  for (j = 0; j < 5; ++j)
+    c[j] = _mm256_set1_ps(id[k + j]);
+
+  for (i = 0; i + 8 <= n; i += 8) {
+
+    v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(raw + i)), swap);
+
+    /* Temperature is signed */
+    if (ch == LIBSFP_CAL_CH_TEMP)
+      x = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v));
+    else
+      x = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(v));
+
+    if (cal)
+      for (j = 0; j < ((ch == LIBSFP_CAL_CH_RXPOWER) ? 5 : 2); ++j)
+        c[j] = _mm256_i32gather_ps((const float*)(cal + i) + k + j, idx, 4);
+
+    if (ch == LIBSFP_CAL_CH_RXPOWER) {
+      r = _mm256_add_ps(_mm256_mul_ps(c[4], x), c[3]);
+      r = _mm256_add_ps(_mm256_mul_ps(r, x), c[2]);
+      r = _mm256_add_ps(_mm256_mul_ps(r, x), c[1]);
+      r = _mm256_add_ps(_mm256_mul_ps(r, x), c[0]);
+    } else
+      r = _mm256_add_ps(_mm256_mul_ps(c[0], x), c[1]);
+
+    _mm256_storeu_ps(out + i, r);
+  }
+
+  libsfp_batch_scalar(ch, (cal) ? cal + i : 0, raw + i, out + i, n - i);
+}
+
+#endif
+
+#ifdef LIBSFP_BATCH_NEON
+
+/* Load 4 big endian values as floats */
+static float32x4_t libsfp_batch_load_neon(uint32_t ch, const libsfp_u16_field_t *raw)
+{
+  uint16x4_t v;
+
+  v = vreinterpret_u16_u8(vrev16_u8(vld1_u8((const uint8_t*)raw)));
+
+  /* Temperature is signed */
+  if (ch == LIBSFP_CAL_CH_TEMP)
+    return vcvtq_f32_s32(vmovl_s16(vreinterpret_s16_u16(v)));
+
+  return vcvtq_f32_u32(vmovl_u16(v));
+}
+
+/* Load coefficient of 4 ports */
+static float32x4_t libsfp_batch_coef_neon(const libsfp_cal_t *cal, uint32_t k)
+{
+  const float *f = (const float*)cal;
+  const float c[4] = {f[k], f[LIBSFP_CAL_NFLOATS + k],
+                      f[2*LIBSFP_CAL_NFLOATS + k], f[3*LIBSFP_CAL_NFLOATS + k]};
+  return vld1q_f32(c);
+}
+
+static void libsfp_batch_neon(uint32_t ch, const libsfp_cal_t *cal,
+                              const libsfp_u16_field_t *raw,
+                              float *out, size_t n)
+{
+  const float *id = (const float*)&libsfp_batch_identity;
+  uint32_t k = libsfp_batch_kofs[ch];
+  float32x4_t x, r, c[5];
+  size_t i;
+  int j;
+
+  for (j = 0; j < 5; ++j)
+    c[j] = vdupq_n_f32(id[k + j]);
+
+  for (i = 0; i + 4 <= n; i += 4) {
+
+    x = libsfp_batch_load_neon(ch, raw + i);
+
+    if (cal)
+      for (j = 0; j < ((ch == LIBSFP_CAL_CH_RXPOWER) ? 5 : 2); ++j)
+        c[j] = libsfp_batch_coef_neon(cal + i, k + j);
+
+    /* vmul and vadd, not vfma: rounding must match scalar */
+    if (ch == LIBSFP_CAL_CH_RXPOWER) {
+      r = vaddq_f32(vmulq_f32(c[4], x), c[3]);
+      r = vaddq_f32(vmulq_f32(r, x), c[2]);
+      r = vaddq_f32(vmulq_f32(r, x), c[1]);
+      r = vaddq_f32(vmulq_f32(r, x), c[0]);
+    } else
+      r = vaddq_f32(vmulq_f32(c[0], x), c[1]);
+
+    vst1q_f32(out + i, r);
+  }
+
+  libsfp_batch_scalar(ch, (cal) ? cal + i : 0, raw + i, out + i, n - i);
+}
+
+#endif
+
+/* Best implementation supported by CPU */
+static libsfp_batch_kernel_t libsfp_batch_best(void)
+{
+#ifdef LIBSFP_BATCH_NEON
+  /* Advanced SIMD is mandatory on AArch64 */
+  return libsfp_batch_neon;
+#endif
+#ifdef LIBSFP_BATCH_X86
+  if (__builtin_cpu_supports("avx2"))
+    return libsfp_batch_avx2;
+  if (__builtin_cpu_supports("sse2"))
+    return libsfp_batch_sse2;
+#endif
+  return libsfp_batch_scalar;
+}
+
+/* Identity calibration and default implementation */
+static void libsfp_batch_init(void)
+{
+  libsfp_cal_init(&libsfp_batch_identity, 0);
+  libsfp_batch_kernel = libsfp_batch_best();
+}
+
+/**
+ * @brief Select batch conversion implementation\n
+ *        (must not be called concurrently with libsfp_cal_batch)
+ * @param impl  - implementation see LIBSFP_CAL_IMPL_*
+ * @return 0 on success, -1 if implementation is not supported by CPU
+ */
+int libsfp_cal_batch_set_impl(uint32_t impl)
+{
+  pthread_once(&libsfp_batch_once, libsfp_batch_init);
+
+  switch (impl) {
+  case LIBSFP_CAL_IMPL_AUTO:
+    libsfp_batch_kernel = libsfp_batch_best();
+    return 0;
+
+  case LIBSFP_CAL_IMPL_SCALAR:
+    libsfp_batch_kernel = libsfp_batch_scalar;
+    return 0;
+
+#ifdef LIBSFP_BATCH_X86
+  case LIBSFP_CAL_IMPL_SSE2:
+    if (!__builtin_cpu_supports("sse2"))
+      return -1;
+    libsfp_batch_kernel = libsfp_batch_sse2;
+    return 0;
+
+  case LIBSFP_CAL_IMPL_AVX2:
+    if (!__builtin_cpu_supports("avx2"))
+      return -1;
+    libsfp_batch_kernel = libsfp_batch_avx2;
+    return 0;
+#endif
+
+#ifdef LIBSFP_BATCH_NEON
+  case LIBSFP_CAL_IMPL_NEON:
+    libsfp_batch_kernel = libsfp_batch_neon;
+    return 0;
+#endif
+  }
+
+  return -1;
+}
+
+/**
+ * @brief Convert raw diagnostic values of many ports\n
+ *        (SIMD implementation is selected at run time, all
+ *        implementations give results identical to scalar one)
+ * @param cal  - array of n per port calibrations or 0 if all
+ *               ports are internally calibrated
+ * @param raw  - raw values arrays (big endian, as in A2 bank) per channel
+ *               see LIBSFP_CAL_CH_*, 0 - skip channel
+ * @param out  - converted values arrays per channel (C, V, mA, mW)
+ * @param n    - number of ports
+ */
+void libsfp_cal_batch(const libsfp_cal_t *cal,
+                      const libsfp_u16_field_t *const raw[LIBSFP_CAL_CHANNELS],
+                      float *const out[LIBSFP_CAL_CHANNELS], size_t n)
+{
+  uint32_t ch;
+
+  pthread_once(&libsfp_batch_once, libsfp_batch_init);
+
+  for (ch = 0; ch < LIBSFP_CAL_CHANNELS; ++ch)
+    if (raw[ch])
+      libsfp_batch_kernel(ch, cal, raw[ch], out[ch], n);
+}
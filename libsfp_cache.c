@@ -0,0 +1,375 @@
+/**
+   @file
+   @brief libsfp shadow cache of static module data
+*/
+
+#include <string.h>
+#include <time.h>
+#include "libsfp_int.h"
+
+/* Bytes of A0 checked by freshness probe: cc_base ... cc_ext
+ * (includes vendor serial number) */
+#define LIBSFP_PROBE_OFS  LIBSFP_OFS_A0_CC_BASE
+#define LIBSFP_PROBE_LEN  (LIBSFP_OFS_A0_CC_EXT - LIBSFP_OFS_A0_CC_BASE + 1)
+
+/**
+ * @brief Get monotonic time
+ * @return time in milliseconds
+ */
+uint64_t libsfp_time_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000 + ts.tv_nsec/1000000;
+}
+
+/**
+ * @brief Load A2 static part to shadow copy\n
+ *        (read failure is remembered and retried after holdoff)
+ * @param h  library handle
+ * @return 0 on success (or if A2 bank is unreachable), -1 on error
+ */
+static int libsfp_cache_load_a2(libsfp_t *h)
+{
+  libsfp_cache_t *c = &H(h)->cache;
+
+  c->state &= ~(LIBSFP_CACHE_A2_VALID | LIBSFP_CACHE_A2_FAIL);
+
+  /* Only thresholds, calibrations and cc_dmi are static */
+  if (READREG_A2(h, 0, LIBSFP_OFS_A2_DIAGNOSTICS, &c->dump.a2)) {
+
+    if (!c->a2_holdoff)
+      c->a2_holdoff = LIBSFP_CACHE_A2_HOLDOFF_MIN;
+    else if (c->a2_holdoff < LIBSFP_CACHE_A2_HOLDOFF_MAX / 2)
+      c->a2_holdoff *= 2;
+    else
+      c->a2_holdoff = LIBSFP_CACHE_A2_HOLDOFF_MAX;
+
+    c->a2_retry_time = libsfp_time_ms() + c->a2_holdoff;
+    c->state |= LIBSFP_CACHE_A2_FAIL;
+
+    return 0;
+  }
+
+  if (libsfp_is_csums_correct(h, 0, &c->dump.a2)) {
+    c->state = 0;
+    return -1;
+  }
+
+  c->a2_holdoff = 0;
+  c->state |= LIBSFP_CACHE_A2_VALID;
+
+  return 0;
+}
+
+/**
+ * @brief Reload shadow copy of static module data
+ * @param h  library handle
+ * @return 0 on success
+ */
+static int libsfp_cache_load(libsfp_t *h)
+{
+  libsfp_cache_t *c = &H(h)->cache;
+
+  c->state = 0;
+  c->a2_holdoff = 0;
+
+  if (libsfp_read_a0(h, &c->dump.a0))
+    return -1;
+
+  if (libsfp_is_csums_correct(h, &c->dump.a0, 0))
+    return -1;
+
+  c->state |= LIBSFP_CACHE_A0_VALID;
+
+  /* Remember facts that make A2 access useless until module change
+   * (diagnostic monitoring type with quirks is kept by libsfp_read_a0) */
+
+  if (!(H(h)->dmtype & LIBSFP_A0_DIAGMON_TYPE_DDM)) {
+
+    c->state |= LIBSFP_CACHE_NO_DDM;
+
+  } else if (H(h)->dmtype & LIBSFP_A0_DIAGMON_TYPE_ADDRCH) {
+
+    c->state |= LIBSFP_CACHE_ADDRCH;
+
+  } else if (libsfp_cache_load_a2(h)) {
+
+    return -1;
+
+  }
+
+  c->probe_time = libsfp_time_ms();
+
+  return 0;
+}
+
+/**
+ * @brief Check that shadow copy matches probe window of the module
+ * @param h   library handle
+ * @param a0  identifier and probe window read from module
+ * @return 0 if matches, 1 if differs, -1 on error
+ */
+static int libsfp_cache_match(libsfp_t *h, const libsfp_A0_t *a0)
+{
+  libsfp_cache_t *c = &H(h)->cache;
+  uint8_t cc_dmi;
+
+  if (a0->base.identifier != c->dump.a0.base.identifier)
+    return 1;
+
+  if (memcmp((const uint8_t*)a0 + LIBSFP_PROBE_OFS,
+             (uint8_t*)&c->dump.a0 + LIBSFP_PROBE_OFS, LIBSFP_PROBE_LEN))
+    return 1;
+
+  if (c->state & LIBSFP_CACHE_A2_VALID) {
+
+    if (READREG_A2(h, LIBSFP_OFS_A2_CC_DMI, 1, &cc_dmi))
+      return -1;
+
+    if (cc_dmi != c->dump.a2.cc_dmi)
+      return 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Read identifier and probe window (cc_base ... cc_ext) of module\n
+ *        (all bytes libsfp_fingerprint depends on)
+ * @param h   library handle
+ * @param a0  A0 bank struct to store data
+ * @return 0 on success
+ */
+int libsfp_cache_probe_read(libsfp_t *h, libsfp_A0_t *a0)
+{
+  if (READREG_A0(h, LIBSFP_OFS_A0_IDENTIFIER, 1, &a0->base.identifier))
+    return -1;
+
+  return READREG_A0(h, LIBSFP_PROBE_OFS, LIBSFP_PROBE_LEN,
+                    (uint8_t*)a0 + LIBSFP_PROBE_OFS);
+}
+
+/**
+ * @brief Check that shadow copy matches the module
+ * @param h  library handle
+ * @return 0 if matches, 1 if differs, -1 on error
+ */
+static int libsfp_cache_check(libsfp_t *h)
+{
+  libsfp_A0_t a0;
+
+  if (libsfp_cache_probe_read(h, &a0))
+    return -1;
+
+  return libsfp_cache_match(h, &a0);
+}
+
+/**
+ * @brief Check shadow cache freshness with probe window already
+ *        read from module and reload cache if needed
+ * @param h   library handle
+ * @param a0  identifier and probe window (cc_base ... cc_ext) of module
+ * @return 0 if cache is fresh, 1 if it was reloaded, -1 on error
+ */
+int libsfp_cache_probe_a0(libsfp_t *h, const libsfp_A0_t *a0)
+{
+  int r;
+
+  if (!(H(h)->cache.state & LIBSFP_CACHE_A0_VALID))
+    return libsfp_cache_load(h) ? -1 : 1;
+
+  r = libsfp_cache_match(h, a0);
+
+  if (r < 0) {
+    H(h)->cache.state = 0;
+    return -1;
+  }
+
+  if (r)
+    return libsfp_cache_load(h) ? -1 : 1;
+
+  H(h)->cache.probe_time = libsfp_time_ms();
+
+  return 0;
+}
+
+/**
+ * @brief Check shadow cache freshness now and reload it if needed
+ * @param h  library handle
+ * @return 0 if cache is fresh, 1 if it was reloaded, -1 on error
+ */
+int libsfp_cache_probe(libsfp_t *h)
+{
+  int r;
+
+  if (!(H(h)->cache.state & LIBSFP_CACHE_A0_VALID))
+    return libsfp_cache_load(h) ? -1 : 1;
+
+  r = libsfp_cache_check(h);
+
+  if (r < 0) {
+    H(h)->cache.state = 0;
+    return -1;
+  }
+
+  if (r)
+    return libsfp_cache_load(h) ? -1 : 1;
+
+  H(h)->cache.probe_time = libsfp_time_ms();
+
+  return 0;
+}
+
+/**
+ * @brief Make shadow cache valid (load it or check its freshness)
+ * @param h  library handle
+ * @return 0 on success
+ */
+int libsfp_cache_update(libsfp_t *h)
+{
+  libsfp_cache_t *c = &H(h)->cache;
+  uint64_t now;
+
+  if (!(c->state & LIBSFP_CACHE_A0_VALID))
+    return libsfp_cache_load(h);
+
+  now = libsfp_time_ms();
+
+  if ((now - c->probe_time >= H(h)->probe_interval) &&
+      (libsfp_cache_probe(h) < 0))
+    return -1;
+
+  /* A2 bank may have failed only transiently */
+  if ((c->state & LIBSFP_CACHE_A2_FAIL) && (now >= c->a2_retry_time))
+    return libsfp_cache_load_a2(h);
+
+  return 0;
+}
+
+/**
+ * @brief Check that A2 bank access may succeed\n
+ *        (uses facts remembered in shadow cache if it is enabled)
+ * @param h  library handle
+ * @return 0 if A2 bank may be accessed, -1 otherwise
+ */
+int libsfp_cache_a2_check(libsfp_t *h)
+{
+  if (!(H(h)->flags & LIBSFP_FLAGS_CACHE))
+    return 0;
+
+  if (libsfp_cache_update(h))
+    return -1;
+
+  return (H(h)->cache.state & LIBSFP_CACHE_NO_A2) ? -1 : 0;
+}
+
+/**
+ * @brief Refresh dynamic A2 section in shadow copy if it is too old
+ * @param h        library handle
+ * @param section  LIBSFP_CACHE_VALUES or LIBSFP_CACHE_STATUS
+ * @param max_age  max acceptable age of data (ms)
+ * @return 0 on success
+ */
+int libsfp_cache_read_dynamic(libsfp_t *h, uint32_t section, uint32_t max_age)
+{
+  libsfp_cache_t *c = &H(h)->cache;
+  uint64_t now, *t;
+  uint16_t ofs, len;
+
+  if (section == LIBSFP_CACHE_VALUES) {
+    t = &c->values_time;
+    ofs = LIBSFP_OFS_CACHE_VALUES;
+    len = LIBSFP_LEN_CACHE_VALUES;
+  } else {
+    t = &c->status_time;
+    ofs = LIBSFP_OFS_CACHE_STATUS;
+    len = LIBSFP_LEN_CACHE_STATUS;
+  }
+
+  now = libsfp_time_ms();
+
+  if ((c->state & section) && (now - (*t) < max_age))
+    return 0;
+
+  if (libsfp_cache_a2_check(h))
+    return -1;
+
+  c->state &= ~section;
+
+  if (READREG_A2(h, ofs, len, (uint8_t*)&c->dump.a2 + ofs))
+    return -1;
+
+  c->state |= section;
+  (*t) = now;
+
+  return 0;
+}
+
+/**
+ * @brief Drop shadow cache contents
+ *        (next access reloads static data from module)
+ * @param h  library handle
+ * @return 0 on success
+ */
+int libsfp_cache_invalidate(libsfp_t *h)
+{
+  H(h)->cache.state = 0;
+  H(h)->identified = 0;
+  return 0;
+}
+
+/**
+ * @brief Assign shadow cache freshness probe interval
+ * @param h         library handle
+ * @param interval  interval (ms), 0 - probe on every access
+ * @return 0 on success
+ */
+int libsfp_set_probe_interval(libsfp_t *h, uint32_t interval)
+{
+  H(h)->probe_interval = interval;
+  return 0;
+}
+
+/**
+ * @brief Read static module data, from shadow cache if enabled
+ * @param h      library handle
+ * @param addr   bank address
+ * @param start  offset in bytes to start reading from
+ * @param count  count of bytes to read
+ * @param data   pointer to buffer to store data
+ * @return 0 on success
+ */
+int libsfp_cache_read(libsfp_t *h, uint8_t addr,
+                      uint16_t start, uint16_t count, void *data)
+{
+  libsfp_cache_t *c = &H(h)->cache;
+
+  if (!(H(h)->flags & LIBSFP_FLAGS_CACHE)) {
+
+    if (READREG(h, addr, start, count, data))
+      return -1;
+
+  } else {
+
+    if (libsfp_cache_update(h))
+      return -1;
+
+    if ((addr == H(h)->a0addr) && (start + count <= sizeof(libsfp_A0_t))) {
+
+      memcpy(data, (uint8_t*)&c->dump.a0 + start, count);
+
+    } else if ((addr == H(h)->a2addr) &&
+               (start + count <= LIBSFP_OFS_A2_DIAGNOSTICS)) {
+
+      if (!(c->state & LIBSFP_CACHE_A2_VALID))
+        return -1;
+
+      memcpy(data, (uint8_t*)&c->dump.a2 + start, count);
+
+    } else if (READREG(h, addr, start, count, data))
+      return -1;
+  }
+
+  return 0;
+}
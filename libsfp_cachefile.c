@@ -0,0 +1,440 @@
+/**
+   @file
+   @brief libsfp persistent warm-start cache of module identity data
+*/
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "libsfp_int.h"
+#include "libsfp_cachefile.h"
+
+#define LIBSFP_CACHEFILE_MAGIC  "LIBSFPC"
+#define LIBSFP_CACHEFILE_BOM    0x01020304   /**< Byte order mark */
+
+/* Shadow state bits that are stored to file (A2 read failure may be
+ * transient, so it is not kept across restarts) */
+#define LIBSFP_CACHEFILE_STATE_MASK  (LIBSFP_CACHE_A0_VALID | \
+                                      LIBSFP_CACHE_A2_VALID | \
+                                      LIBSFP_CACHE_NO_DDM | \
+                                      LIBSFP_CACHE_ADDRCH)
+
+#define LIBSFP_CACHEFILE_ENTRY_USED  1   /**< Entry contains data */
+
+/** Cache file header */
+typedef struct {
+  char magic[8];               /** LIBSFP_CACHEFILE_MAGIC */
+  uint32_t version;            /** LIBSFP_CACHEFILE_VERSION */
+  uint32_t entry_size;         /** Size of entry (checks layout) */
+  uint32_t ncages;             /** Number of entries */
+  uint32_t bom;                /** LIBSFP_CACHEFILE_BOM in host byte order */
+  uint8_t reserved[40];
+} libsfp_cachefile_hdr_t;
+
+/** Cache file entry */
+typedef struct {
+  uint32_t flags;              /** Entry flags see LIBSFP_CACHEFILE_ENTRY_* */
+  uint32_t fingerprint;        /** Module fingerprint */
+  uint32_t state;              /** Shadow cache state see LIBSFP_CACHE_* */
+  uint32_t csum;               /** Checksum of the rest of entry */
+  uint32_t bitrate;            /** Decoded bitrate (bit/s) */
+  uint32_t spmode;             /** Decoded speed mode LIBSFP_SPEED_MODE_* */
+  char vendor[17];             /** Decoded vendor name */
+  char partnum[17];            /** Decoded part number */
+  uint8_t reserved[6];
+  libsfp_A0_t a0;                             /** A0 bank */
+  uint8_t a2[LIBSFP_OFS_A2_DIAGNOSTICS];      /** A2 static part */
+} libsfp_cachefile_entry_t;
+
+_Static_assert(sizeof(libsfp_cachefile_hdr_t) == 64, "cache file header size changed");
+_Static_assert(sizeof(libsfp_cachefile_entry_t) == 256, "cache file entry size changed");
+
+typedef struct {
+  int fd;                      /** Cache file descriptor */
+  size_t size;                 /** Mapped size */
+  libsfp_cachefile_hdr_t *hdr; /** Mapped file */
+  libsfp_cachefile_entry_t *entries;
+} libsfp_cachefile_int_t;
+
+#define CF(ptr) ((libsfp_cachefile_int_t*)(ptr))
+
+/* FNV-1a hash */
+#define LIBSFP_FNV_BASIS  2166136261u
+#define LIBSFP_FNV_PRIME  16777619u
+
+static uint32_t libsfp_fnv(uint32_t hash, const void *d, size_t size)
+{
+  size_t i;
+  for (i = 0; i < size; ++i) {
+    hash ^= ((const uint8_t*)d)[i];
+    hash *= LIBSFP_FNV_PRIME;
+  }
+  return hash;
+}
+
+/**
+ * @brief Calc module fingerprint from identifier, checksums
+ *        and serial number
+ * @param a0  - A0 bank data
+ * @return fingerprint
+ */
+uint32_t libsfp_fingerprint(const libsfp_A0_t *a0)
+{
+  uint32_t hash = LIBSFP_FNV_BASIS;
+
+  hash = libsfp_fnv(hash, &a0->base.identifier, 1);
+  hash = libsfp_fnv(hash, &a0->base.cc_base, 1);
+  hash = libsfp_fnv(hash, a0->ext.vendor_sn, 8);
+  hash = libsfp_fnv(hash, &a0->ext.cc_ext, 1);
+
+  return hash;
+}
+
+/* Checksum of entry contents (all fields except flags and csum) */
+static uint32_t libsfp_cachefile_entry_csum(libsfp_cachefile_entry_t *e)
+{
+  uint32_t hash;
+  hash = libsfp_fnv(LIBSFP_FNV_BASIS, &e->fingerprint,
+                    offsetof(libsfp_cachefile_entry_t, csum) -
+                    offsetof(libsfp_cachefile_entry_t, fingerprint));
+  return libsfp_fnv(hash, &e->bitrate,
+                    sizeof(*e) - offsetof(libsfp_cachefile_entry_t, bitrate));
+}
+
+static libsfp_cachefile_entry_t *libsfp_cachefile_entry(libsfp_cachefile_t *cf,
+                                                        uint32_t cage)
+{
+  if (cage >= CF(cf)->hdr->ncages)
+    return 0;
+  return &CF(cf)->entries[cage];
+}
+
+/**
+ * @brief Create new cache file of given size and rename it over the old
+ *        one (file mapped by other processes is never resized)
+ * @param path    cache file path
+ * @param old     descriptor of old file
+ * @param nold    number of valid entries in old file to keep
+ * @param ncages  number of entries of new file
+ * @return descriptor of new file (locked) or -1 on error
+ */
+static int libsfp_cachefile_replace(const char *path, int old,
+                                    uint32_t nold, uint32_t ncages)
+{
+  libsfp_cachefile_entry_t e;
+  off_t ofs = sizeof(libsfp_cachefile_hdr_t);
+  char *tmp;
+  uint32_t i;
+  int fd;
+
+  tmp = malloc(strlen(path) + 8);
+  if (!tmp)
+    return -1;
+  sprintf(tmp, "%s.XXXXXX", path);
+
+  fd = mkstemp(tmp);
+  if (fd < 0) {
+    free(tmp);
+    return -1;
+  }
+
+  if (flock(fd, LOCK_EX) || fchmod(fd, 0644) ||
+      ftruncate(fd, ofs + (off_t)ncages*sizeof(e)))
+    goto err;
+
+  /* Extra entries are zero filled (unused) */
+  for (i = 0; (i < nold) && (i < ncages); ++i, ofs += sizeof(e))
+    if ((pread(old, &e, sizeof(e), ofs) != sizeof(e)) ||
+        (pwrite(fd, &e, sizeof(e), ofs) != sizeof(e)))
+      goto err;
+
+  if (rename(tmp, path))
+    goto err;
+
+  free(tmp);
+  return fd;
+
+err:
+  close(fd);
+  unlink(tmp);
+  free(tmp);
+  return -1;
+}
+
+/**
+ * @brief Open (create if needed) cache file and map it to memory
+ * @param path    - cache file path
+ * @param ncages  - number of cages to keep in file
+ * @return cache file handle or 0 if error occured
+ */
+libsfp_cachefile_t *libsfp_cachefile_open(const char *path, uint32_t ncages)
+{
+  libsfp_cachefile_int_t *cf;
+  libsfp_cachefile_hdr_t hdr;
+  struct stat st, pst;
+  int fd, valid = 0;
+
+  cf = malloc(sizeof(libsfp_cachefile_int_t));
+  if (!cf)
+    return 0;
+
+  cf->size = sizeof(libsfp_cachefile_hdr_t) +
+             (size_t)ncages*sizeof(libsfp_cachefile_entry_t);
+
+  for (;;) {
+
+    cf->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (cf->fd < 0)
+      goto err_free;
+
+    /* Other process may create or replace file right now */
+    if (flock(cf->fd, LOCK_EX))
+      goto err_close;
+
+    if (fstat(cf->fd, &st) || stat(path, &pst))
+      goto err_close;
+
+    /* File was not replaced while we waited for the lock */
+    if ((st.st_dev == pst.st_dev) && (st.st_ino == pst.st_ino))
+      break;
+
+    close(cf->fd);
+  }
+
+  /* Check existing file format, start from scratch if it is unknown */
+  if ((st.st_size >= (off_t)sizeof(hdr)) &&
+      (pread(cf->fd, &hdr, sizeof(hdr), 0) == sizeof(hdr)))
+    valid = !memcmp(hdr.magic, LIBSFP_CACHEFILE_MAGIC, sizeof(hdr.magic)) &&
+            (hdr.version == LIBSFP_CACHEFILE_VERSION) &&
+            (hdr.entry_size == sizeof(libsfp_cachefile_entry_t)) &&
+            (hdr.bom == LIBSFP_CACHEFILE_BOM) &&
+            (st.st_size >= (off_t)(sizeof(hdr) + (size_t)hdr.ncages*hdr.entry_size));
+
+  /* Geometry or format differs: replace file, other processes keep
+   * their mapping of the old one */
+  if ((!valid) || (hdr.ncages != ncages)) {
+    fd = libsfp_cachefile_replace(path, cf->fd, (valid) ? hdr.ncages : 0,
+                                  ncages);
+    if (fd < 0)
+      goto err_close;
+    close(cf->fd);
+    cf->fd = fd;
+  }
+
+  cf->hdr = mmap(0, cf->size, PROT_READ | PROT_WRITE, MAP_SHARED, cf->fd, 0);
+  if (cf->hdr == MAP_FAILED)
+    goto err_close;
+
+  memcpy(cf->hdr->magic, LIBSFP_CACHEFILE_MAGIC, sizeof(cf->hdr->magic));
+  cf->hdr->version = LIBSFP_CACHEFILE_VERSION;
+  cf->hdr->entry_size = sizeof(libsfp_cachefile_entry_t);
+  cf->hdr->ncages = ncages;
+  cf->hdr->bom = LIBSFP_CACHEFILE_BOM;
+  cf->entries = (libsfp_cachefile_entry_t*)(cf->hdr + 1);
+
+  flock(cf->fd, LOCK_UN);
+
+  return (libsfp_cachefile_t*)cf;
+
+err_close:
+  close(cf->fd);
+err_free:
+  free(cf);
+  return 0;
+}
+
+/**
+ * @brief Flush cache file changes to disk
+ * @param cf  - cache file handle
+ * @return 0 on success
+ */
+int libsfp_cachefile_sync(libsfp_cachefile_t *cf)
+{
+  return msync(CF(cf)->hdr, CF(cf)->size, MS_SYNC) ? -1 : 0;
+}
+
+/**
+ * @brief Flush changes and close cache file
+ * @param cf  - cache file handle
+ * @return 0 on success
+ */
+int libsfp_cachefile_close(libsfp_cachefile_t *cf)
+{
+  int ret = 0;
+
+  if (libsfp_cachefile_sync(cf))
+    ret = -1;
+
+  munmap(CF(cf)->hdr, CF(cf)->size);
+  close(CF(cf)->fd);
+  free(cf);
+
+  return ret;
+}
+
+/**
+ * @brief Store shadow cache of library handle as cage entry
+ * @param cf    - cache file handle
+ * @param cage  - cage number
+ * @param h     - library handle (with LIBSFP_FLAGS_CACHE flag)
+ * @return 0 on success
+ */
+int libsfp_cachefile_store(libsfp_cachefile_t *cf, uint32_t cage, libsfp_t *h)
+{
+  libsfp_cachefile_entry_t *e;
+  libsfp_cache_t *c = &H(h)->cache;
+
+  e = libsfp_cachefile_entry(cf, cage);
+  if (!e)
+    return -1;
+
+  if (!(c->state & LIBSFP_CACHE_A0_VALID))
+    return -1;
+
+  /* Writers of other processes are excluded */
+  if (flock(CF(cf)->fd, LOCK_EX))
+    return -1;
+
+  /* Entry is not valid while it is updated */
+  e->flags = 0;
+
+  e->fingerprint = libsfp_fingerprint(&c->dump.a0);
+  e->state = c->state & LIBSFP_CACHEFILE_STATE_MASK;
+
+  e->bitrate = c->dump.a0.base.br_nominal*100;
+  e->spmode = libsfp_bitrate2speed_mode(c->dump.a0.base.br_nominal);
+  if (e->spmode == LIBSFP_SPEED_MODE_UNKNOWN)
+    e->spmode = libsfp_transceiver2speed_mode(c->dump.a0.base.transceiver);
+
+  memcpy(e->vendor, c->dump.a0.base.vendor_name, LIBSFP_LEN_A0_VENDOR_NAME);
+  e->vendor[LIBSFP_LEN_A0_VENDOR_NAME] = 0;
+  memcpy(e->partnum, c->dump.a0.base.vendor_pn, LIBSFP_LEN_A0_VENDOR_PN);
+  e->partnum[LIBSFP_LEN_A0_VENDOR_PN] = 0;
+  memset(e->reserved, 0, sizeof(e->reserved));
+
+  e->a0 = c->dump.a0;
+  memcpy(e->a2, &c->dump.a2, sizeof(e->a2));
+
+  e->csum = libsfp_cachefile_entry_csum(e);
+  e->flags = LIBSFP_CACHEFILE_ENTRY_USED;
+
+  flock(CF(cf)->fd, LOCK_UN);
+
+  return 0;
+}
+
+static libsfp_cachefile_entry_t *libsfp_cachefile_valid_entry(libsfp_cachefile_t *cf,
+                                                              uint32_t cage)
+{
+  libsfp_cachefile_entry_t *e;
+
+  e = libsfp_cachefile_entry(cf, cage);
+  if (!e)
+    return 0;
+
+  if (!(e->flags & LIBSFP_CACHEFILE_ENTRY_USED))
+    return 0;
+
+  if (e->csum != libsfp_cachefile_entry_csum(e))
+    return 0;
+
+  return e;
+}
+
+/**
+ * @brief Fill shadow cache of library handle from cage entry
+ *        if it has fingerprint of module in cage, then validate it
+ *        by checksum probe (module probe window is read once)
+ * @param cf    - cache file handle
+ * @param cage  - cage number
+ * @param h     - library handle (with LIBSFP_FLAGS_CACHE flag)
+ * @return 0 if entry matches module, 1 if module was reloaded,
+ *         -1 on error
+ */
+int libsfp_cachefile_load(libsfp_cachefile_t *cf, uint32_t cage, libsfp_t *h)
+{
+  libsfp_cachefile_entry_t *e, entry;
+  libsfp_cache_t *c = &H(h)->cache;
+  libsfp_A0_t live;
+
+  c->state = 0;
+
+  /* Copy entry out of file, module is accessed without lock */
+  if (flock(CF(cf)->fd, LOCK_SH))
+    return -1;
+
+  e = libsfp_cachefile_valid_entry(cf, cage);
+  if (e)
+    entry = *e;
+
+  flock(CF(cf)->fd, LOCK_UN);
+
+  if (!e)
+    return libsfp_cache_probe(h);
+
+  if (libsfp_cache_probe_read(h, &live))
+    return -1;
+
+  if (entry.fingerprint == libsfp_fingerprint(&live)) {
+    c->dump.a0 = entry.a0;
+    memcpy(&c->dump.a2, entry.a2, sizeof(entry.a2));
+    c->state = entry.state & LIBSFP_CACHEFILE_STATE_MASK;
+    libsfp_quirks_apply(h, &c->dump.a0);
+
+    /* A2 static part was not stored: read it on first access */
+    if (!(c->state & (LIBSFP_CACHE_A2_VALID | LIBSFP_CACHE_NO_DDM |
+                      LIBSFP_CACHE_ADDRCH))) {
+      c->state |= LIBSFP_CACHE_A2_FAIL;
+      c->a2_holdoff = 0;
+      c->a2_retry_time = 0;
+    }
+  }
+
+  /* Entry is validated by the probe window already read */
+  return libsfp_cache_probe_a0(h, &live);
+}
+
+/**
+ * @brief Get brief identity of cage module stored in cache file
+ *        (without any module access, power fields are set to -1)
+ * @param cf    - cache file handle
+ * @param cage  - cage number
+ * @param info  - struct to store information
+ * @param fingerprint - place to store module fingerprint or 0
+ * @return 0 on success, -1 if there is no valid entry
+ */
+int libsfp_cachefile_get_brief(libsfp_cachefile_t *cf, uint32_t cage,
+                               libsfp_brief_info_t *info,
+                               uint32_t *fingerprint)
+{
+  libsfp_cachefile_entry_t *e;
+
+  if (flock(CF(cf)->fd, LOCK_SH))
+    return -1;
+
+  e = libsfp_cachefile_valid_entry(cf, cage);
+  if (!e) {
+    flock(CF(cf)->fd, LOCK_UN);
+    return -1;
+  }
+
+  memcpy(info->vendor, e->vendor, sizeof(info->vendor));
+  memcpy(info->partnum, e->partnum, sizeof(info->partnum));
+  info->bitrate = e->bitrate;
+  info->spmode = e->spmode;
+  info->txpower = -1;
+  info->rxpower = -1;
+
+  if (fingerprint)
+    (*fingerprint) = e->fingerprint;
+
+  flock(CF(cf)->fd, LOCK_UN);
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+#ifndef LIBSFP_CACHEFILE_H__
+#define LIBSFP_CACHEFILE_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (persistent warm-start cache of module identity data)
+
+   Cache file stores shadow copy of static module data (A0 bank,
+   A2 thresholds and calibrations) and brief decoded identity for every
+   cage. File consists of fixed size header and array of fixed size
+   entries indexed by cage number, so it may be mapped to memory as is.
+   Entry is used only if it has fingerprint of the module in cage and
+   passes cheap checksum probe. File is locked (flock) while entries
+   are read or written, so several processes may share it, one handle
+   must not be used by several threads at once. File is never resized
+   in place: if it is opened with other number of cages, new file is
+   written and renamed over the old one (processes that have the old
+   file open keep using it until they reopen it).
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libsfp.h>
+
+#define LIBSFP_CACHEFILE_VERSION  1    /**< Cache file format version */
+
+/** Persistent cache file handle\n
+ *  Use only pointer to this type
+*/
+typedef struct {
+} libsfp_cachefile_t;
+
+/**
+ * @brief Calc module fingerprint from identifier, checksums
+ *        and serial number
+ * @param a0  - A0 bank data
+ * @return fingerprint
+ */
+uint32_t libsfp_fingerprint(const libsfp_A0_t *a0);
+
+/**
+ * @brief Open (create if needed) cache file and map it to memory
+ * @param path    - cache file path
+ * @param ncages  - number of cages to keep in file
+ * @return cache file handle or 0 if error occured
+ */
+libsfp_cachefile_t *libsfp_cachefile_open(const char *path, uint32_t ncages);
+
+/**
+ * @brief Flush changes and close cache file
+ * @param cf  - cache file handle
+ * @return 0 on success
+ */
+int libsfp_cachefile_close(libsfp_cachefile_t *cf);
+
+/**
+ * @brief Flush cache file changes to disk
+ * @param cf  - cache file handle
+ * @return 0 on success
+ */
+int libsfp_cachefile_sync(libsfp_cachefile_t *cf);
+
+/**
+ * @brief Store shadow cache of library handle as cage entry
+ * @param cf    - cache file handle
+ * @param cage  - cage number
+ * @param h     - library handle (with LIBSFP_FLAGS_CACHE flag)
+ * @return 0 on success
+ */
+int libsfp_cachefile_store(libsfp_cachefile_t *cf, uint32_t cage, libsfp_t *h);
+
+/**
+ * @brief Fill shadow cache of library handle from cage entry
+ *        and validate it by checksum probe
+ * @param cf    - cache file handle
+ * @param cage  - cage number
+ * @param h     - library handle (with LIBSFP_FLAGS_CACHE flag)
+ * @return 0 if entry matches module, 1 if module was reloaded,
+ *         -1 on error
+ */
+int libsfp_cachefile_load(libsfp_cachefile_t *cf, uint32_t cage, libsfp_t *h);
+
+/**
+ * @brief Get brief identity of cage module stored in cache file
+ *        (without any module access, power fields are set to -1)
+ * @param cf    - cache file handle
+ * @param cage  - cage number
+ * @param info  - struct to store information
+ * @param fingerprint - place to store module fingerprint or 0
+ * @return 0 on success, -1 if there is no valid entry
+ */
+int libsfp_cachefile_get_brief(libsfp_cachefile_t *cf, uint32_t cage,
+                               libsfp_brief_info_t *info,
+                               uint32_t *fingerprint);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
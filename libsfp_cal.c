@@ -0,0 +1,253 @@
+/**
+   @file
+   @brief libsfp precompiled calibration of diagnostic values
+*/
+
+#include "libsfp_int.h"
+#include "libsfp_cal.h"
+
+/* Units of raw values (SFF-8472 9.2) */
+#define LIBSFP_CAL_TEMP_UNIT     (1.0f/256.0f)     /**< 1/256 C */
+#define LIBSFP_CAL_VOLTAGE_UNIT  (1.0f/10000.0f)   /**< 100 uV */
+#define LIBSFP_CAL_BIAS_UNIT     (0.002f)          /**< 2 uA */
+#define LIBSFP_CAL_POWER_UNIT    (1.0f/10000.0f)   /**< 0.1 uW */
+
+#define LIBSFP_CALFX_RX_FRAC     16    /**< Fraction bits of RX power terms */
+
+/**
+ * @brief Build calibration object
+ * @param c   - calibration object
+ * @param cl  - external calibration constants or 0 if module
+ *              is internally calibrated
+ * @return 0 on success
+ */
+int libsfp_cal_init(libsfp_cal_t *c, const libsfp_calibration_fields_t *cl)
+{
+  int i;
+
+  if (!cl) {
+    c->t_k = LIBSFP_CAL_TEMP_UNIT;
+    c->v_k = LIBSFP_CAL_VOLTAGE_UNIT;
+    c->i_k = LIBSFP_CAL_BIAS_UNIT;
+    c->tx_k = LIBSFP_CAL_POWER_UNIT;
+    c->t_b = c->v_b = c->i_b = c->tx_b = 0;
+    c->rx[0] = c->rx[2] = c->rx[3] = c->rx[4] = 0;
+    c->rx[1] = LIBSFP_CAL_POWER_UNIT;
+    return 0;
+  }
+
+  /* Slope and offset are applied to raw value, result is in raw units */
+  c->t_k = libsfp_get_slope(cl->t_slope)*LIBSFP_CAL_TEMP_UNIT;
+  c->t_b = libsfp_get_offset(cl->t_offset)*LIBSFP_CAL_TEMP_UNIT;
+  c->v_k = libsfp_get_slope(cl->v_slope)*LIBSFP_CAL_VOLTAGE_UNIT;
+  c->v_b = libsfp_get_offset(cl->v_offset)*LIBSFP_CAL_VOLTAGE_UNIT;
+  c->i_k = libsfp_get_slope(cl->txi_slope)*LIBSFP_CAL_BIAS_UNIT;
+  c->i_b = libsfp_get_offset(cl->txi_offset)*LIBSFP_CAL_BIAS_UNIT;
+  c->tx_k = libsfp_get_slope(cl->tx_pwr_slope)*LIBSFP_CAL_POWER_UNIT;
+  c->tx_b = libsfp_get_offset(cl->tx_pwr_offset)*LIBSFP_CAL_POWER_UNIT;
+
+  /* Coefficients are stored from Rx_PWR(4) down to Rx_PWR(0) */
+  for (i = 0; i < 5; ++i)
+    c->rx[4 - i] = libsfp_cal_float(cl->rx_pwr[i])*LIBSFP_CAL_POWER_UNIT;
+
+  return 0;
+}
+
+/**
+ * @brief Build calibration object of module
+ * @param h  - library handle
+ * @param c  - calibration object
+ * @return 0 on success
+ */
+int libsfp_get_cal(libsfp_t *h, libsfp_cal_t *c)
+{
+  libsfp_calibration_fields_t cl;
+  uint8_t dmtype;
+
+  if (libsfp_get_dmtype(h, &dmtype))
+    return -1;
+
+  if (!(dmtype & LIBSFP_A0_DIAGMON_TYPE_EXCAL))
+    return libsfp_cal_init(c, 0);
+
+  if (READSTATIC_A2(h, LIBSFP_OFS_A2_EXT_CAL_CONSTANTS, sizeof(cl), &cl))
+    return -1;
+
+  return libsfp_cal_init(c, &cl);
+}
+
+static uint16_t libsfp_calfx_u16(libsfp_u16_field_t f)
+{
+  return (f.d[0] << 8) | f.d[1];
+}
+
+/* Split big endian IEEE-754 float to mantissa and binary exponent */
+static void libsfp_calfx_split(libsfp_u32_field_t f, int32_t *m, int16_t *e)
+{
+  uint32_t u = ((uint32_t)f.d[0] << 24) | ((uint32_t)f.d[1] << 16) |
+               ((uint32_t)f.d[2] << 8) | f.d[3];
+  uint32_t exp = (u >> 23) & 0xFF;
+  int32_t mant = u & 0x7FFFFF;
+
+  if (exp == 0xFF) {
+    /* Inf/NaN: treat as missing coefficient */
+    mant = 0;
+    exp = 0;
+  }
+
+  if (exp)
+    mant |= 0x800000;
+  else
+    exp = 1;
+
+  /* Mantissa in 0.1 uW units scaled to nW */
+  mant *= 100;
+  (*m) = (u & 0x80000000) ? -mant : mant;
+  (*e) = (int16_t)exp - 150;
+}
+
+/**
+ * @brief Build fixed point calibration object
+ * @param c   - calibration object
+ * @param cl  - external calibration constants or 0 if module
+ *              is internally calibrated
+ * @return 0 on success
+ */
+int libsfp_calfx_init(libsfp_calfx_t *c, const libsfp_calibration_fields_t *cl)
+{
+  int i;
+
+  if (!cl) {
+    c->t_slope = c->v_slope = c->i_slope = c->tx_slope = 256;
+    c->t_offset = c->v_offset = c->i_offset = c->tx_offset = 0;
+    for (i = 0; i < 5; ++i) {
+      c->rx_m[i] = 0;
+      c->rx_e[i] = 0;
+    }
+    c->rx_m[1] = 100;
+    return 0;
+  }
+
+  c->t_slope = libsfp_calfx_u16(cl->t_slope);
+  c->t_offset = (int16_t)libsfp_calfx_u16(cl->t_offset);
+  c->v_slope = libsfp_calfx_u16(cl->v_slope);
+  c->v_offset = (int16_t)libsfp_calfx_u16(cl->v_offset);
+  c->i_slope = libsfp_calfx_u16(cl->txi_slope);
+  c->i_offset = (int16_t)libsfp_calfx_u16(cl->txi_offset);
+  c->tx_slope = libsfp_calfx_u16(cl->tx_pwr_slope);
+  c->tx_offset = (int16_t)libsfp_calfx_u16(cl->tx_pwr_offset);
+
+  /* Coefficients are stored from Rx_PWR(4) down to Rx_PWR(0) */
+  for (i = 0; i < 5; ++i)
+    libsfp_calfx_split(cl->rx_pwr[i], &c->rx_m[4 - i], &c->rx_e[4 - i]);
+
+  return 0;
+}
+
+/**
+ * @brief Build fixed point calibration object of module
+ * @param h  - library handle
+ * @param c  - calibration object
+ * @return 0 on success
+ */
+int libsfp_get_calfx(libsfp_t *h, libsfp_calfx_t *c)
+{
+  libsfp_calibration_fields_t cl;
+  uint8_t dmtype;
+
+  if (libsfp_get_dmtype(h, &dmtype))
+    return -1;
+
+  if (!(dmtype & LIBSFP_A0_DIAGMON_TYPE_EXCAL))
+    return libsfp_calfx_init(c, 0);
+
+  if (READSTATIC_A2(h, LIBSFP_OFS_A2_EXT_CAL_CONSTANTS, sizeof(cl), &cl))
+    return -1;
+
+  return libsfp_calfx_init(c, &cl);
+}
+
+/**
+ * @brief Multiply 64 bit value by signed 32 bit one and scale
+ *        result by power of two (96 bit intermediate, saturated)
+ * @param a  unsigned value
+ * @param m  signed multiplier
+ * @param e  binary exponent of result scale
+ * @return a*m*2^e
+ */
+static int64_t libsfp_calfx_mulshift(uint64_t a, int32_t m, int e)
+{
+  uint64_t um = (m < 0) ? -(uint64_t)m : (uint64_t)m;
+  uint64_t lo, hi, p_lo, p_hi, r;
+
+  p_lo = (a & 0xFFFFFFFF)*um;
+  p_hi = (a >> 32)*um;
+
+  /* 128 bit product hi:lo */
+  lo = p_lo + (p_hi << 32);
+  hi = (p_hi >> 32) + (lo < p_lo);
+
+  if (!(hi | lo))
+    return 0;
+
+  if (e >= 0) {
+    if ((hi) || (e >= 63) || (lo >> (63 - e)))
+      return (m < 0) ? INT64_MIN : INT64_MAX;
+    r = lo << e;
+  } else {
+    e = -e;
+    if (e >= 128)
+      return 0;
+    if (e >= 64) {
+      r = hi >> (e - 64);
+    } else {
+      if (hi >> e)
+        return (m < 0) ? INT64_MIN : INT64_MAX;
+      r = (e) ? ((lo >> e) | (hi << (64 - e))) : lo;
+    }
+    if (r >> 63)
+      return (m < 0) ? INT64_MIN : INT64_MAX;
+  }
+
+  return (m < 0) ? -(int64_t)r : (int64_t)r;
+}
+
+/**
+ * @brief Convert raw RX power to nW
+ * @param c    - calibration object
+ * @param raw  - raw value
+ * @return RX power (nW)
+ */
+int32_t libsfp_calfx_rxpower(const libsfp_calfx_t *c, uint16_t raw)
+{
+  uint64_t x = 1;
+  int64_t t, sum = 0;
+  int i;
+
+  /* raw^4 still fits 64 bits, terms keep fraction bits and
+   * the sum is rounded once */
+  for (i = 0; i < 5; ++i, x *= raw) {
+
+    if (!c->rx_m[i])
+      continue;
+
+    t = libsfp_calfx_mulshift(x, c->rx_m[i],
+                              c->rx_e[i] + LIBSFP_CALFX_RX_FRAC);
+
+    if ((t > 0) && (sum > INT64_MAX - t))
+      sum = INT64_MAX;
+    else if ((t < 0) && (sum < INT64_MIN - t))
+      sum = INT64_MIN;
+    else
+      sum += t;
+  }
+
+  if (sum > (int64_t)INT32_MAX * ((int64_t)1 << LIBSFP_CALFX_RX_FRAC))
+    return INT32_MAX;
+  if (sum < (int64_t)INT32_MIN * ((int64_t)1 << LIBSFP_CALFX_RX_FRAC))
+    return INT32_MIN;
+
+  /* Round half up (arithmetic shift) */
+  return (int32_t)((sum + (1 << (LIBSFP_CALFX_RX_FRAC - 1))) >>
+                   LIBSFP_CALFX_RX_FRAC);
+}
@@ -0,0 +1,222 @@
+#ifndef LIBSFP_CAL_H__
+#define LIBSFP_CAL_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (precompiled calibration of diagnostic values)
+
+   Calibration object is built once per module from external
+   calibration constants (or as identity for internally calibrated
+   modules) and keeps native float coefficients with unit scale
+   folded in. Conversions are branch free inline functions.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <string.h>
+#include <libsfp.h>
+
+/* Diagnostic channels */
+#define LIBSFP_CAL_CH_TEMP      0   /**< Temperature */
+#define LIBSFP_CAL_CH_VOLTAGE   1   /**< Supply voltage */
+#define LIBSFP_CAL_CH_BIAS      2   /**< TX bias current */
+#define LIBSFP_CAL_CH_TXPOWER   3   /**< TX power */
+#define LIBSFP_CAL_CH_RXPOWER   4   /**< RX power */
+#define LIBSFP_CAL_CHANNELS     5
+
+/* Batch conversion implementations */
+#define LIBSFP_CAL_IMPL_AUTO    0   /**< Best supported by CPU */
+#define LIBSFP_CAL_IMPL_SCALAR  1
+#define LIBSFP_CAL_IMPL_SSE2    2
+#define LIBSFP_CAL_IMPL_AVX2    3
+#define LIBSFP_CAL_IMPL_NEON    4   /**< AArch64 Advanced SIMD */
+
+/** Precompiled calibration (SFF-8472 9.3, unit scale included) */
+typedef struct {
+  float t_k, t_b;          /** Temperature: C = t_k*raw + t_b */
+  float v_k, v_b;          /** Voltage: V = v_k*raw + v_b */
+  float i_k, i_b;          /** Bias current: mA = i_k*raw + i_b */
+  float tx_k, tx_b;        /** TX power: mW = tx_k*raw + tx_b */
+  float rx[5];             /** RX power: mW = sum(rx[n]*raw^n) */
+} libsfp_cal_t;
+
+/**
+ * @brief Build calibration object
+ * @param c   - calibration object
+ * @param cl  - external calibration constants or 0 if module
+ *              is internally calibrated
+ * @return 0 on success
+ */
+int libsfp_cal_init(libsfp_cal_t *c, const libsfp_calibration_fields_t *cl);
+
+/**
+ * @brief Build calibration object of module
+ * @param h  - library handle
+ * @param c  - calibration object
+ * @return 0 on success
+ */
+int libsfp_get_cal(libsfp_t *h, libsfp_cal_t *c);
+
+/**
+ * @brief Get raw value of big endian diagnostic field
+ * @param f  - field
+ * @return raw value
+ */
+static inline uint16_t libsfp_cal_raw(libsfp_u16_field_t f)
+{
+  return (f.d[0] << 8) | f.d[1];
+}
+
+/**
+ * @brief Get big endian IEEE-754 float field
+ * @param f  - field
+ * @return value
+ */
+static inline float libsfp_cal_float(libsfp_u32_field_t f)
+{
+  uint32_t u = ((uint32_t)f.d[0] << 24) | ((uint32_t)f.d[1] << 16) |
+               ((uint32_t)f.d[2] << 8) | f.d[3];
+  float v;
+  memcpy(&v, &u, sizeof(v));
+  return v;
+}
+
+/* Inline conversions are compiled with flags of the caller (compiler
+ * may fuse multiply and add), results may differ from libsfp_cal_batch
+ * in the last bit */
+
+/** @brief Convert raw temperature (signed) to C */
+static inline float libsfp_cal_temp(const libsfp_cal_t *c, uint16_t raw)
+{
+  return c->t_k*(float)(int16_t)raw + c->t_b;
+}
+
+/** @brief Convert raw supply voltage to V */
+static inline float libsfp_cal_voltage(const libsfp_cal_t *c, uint16_t raw)
+{
+  return c->v_k*(float)raw + c->v_b;
+}
+
+/** @brief Convert raw bias current to mA */
+static inline float libsfp_cal_bias(const libsfp_cal_t *c, uint16_t raw)
+{
+  return c->i_k*(float)raw + c->i_b;
+}
+
+/** @brief Convert raw TX power to mW */
+static inline float libsfp_cal_txpower(const libsfp_cal_t *c, uint16_t raw)
+{
+  return c->tx_k*(float)raw + c->tx_b;
+}
+
+/** @brief Convert raw RX power to mW (Horner scheme) */
+static inline float libsfp_cal_rxpower(const libsfp_cal_t *c, uint16_t raw)
+{
+  float x = (float)raw;
+  return (((c->rx[4]*x + c->rx[3])*x + c->rx[2])*x + c->rx[1])*x + c->rx[0];
+}
+
+/**
+ * @brief Convert raw diagnostic values of many ports\n
+ *        (SIMD implementation is selected at run time, all
+ *        implementations give results identical to scalar one)
+ * @param cal  - array of n per port calibrations or 0 if all
+ *               ports are internally calibrated
+ * @param raw  - raw values arrays (big endian, as in A2 bank) per channel
+ *               see LIBSFP_CAL_CH_*, 0 - skip channel
+ * @param out  - converted values arrays per channel (C, V, mA, mW)
+ * @param n    - number of ports
+ */
+void libsfp_cal_batch(const libsfp_cal_t *cal,
+                      const libsfp_u16_field_t *const raw[LIBSFP_CAL_CHANNELS],
+                      float *const out[LIBSFP_CAL_CHANNELS], size_t n);
+
+/**
+ * @brief Select batch conversion implementation\n
+ *        (must not be called concurrently with libsfp_cal_batch)
+ * @param impl  - implementation see LIBSFP_CAL_IMPL_*
+ * @return 0 on success, -1 if implementation is not supported by CPU
+ */
+int libsfp_cal_batch_set_impl(uint32_t impl);
+
+/** Fixed point calibration (no floating point operations)\n
+ *  Results are exact values rounded to nearest unit (RX power within
+ *  0.5 nW + 5*2^-16), float conversions round every step and may differ
+ *  by more on large values
+ */
+typedef struct {
+  uint16_t t_slope, v_slope, i_slope, tx_slope;      /** Slopes (unsigned 8.8) */
+  int16_t t_offset, v_offset, i_offset, tx_offset;   /** Offsets (raw units) */
+  int32_t rx_m[5];         /** RX coefficients mantissas (x100, nW units) */
+  int16_t rx_e[5];         /** RX coefficients binary exponents */
+} libsfp_calfx_t;
+
+/**
+ * @brief Build fixed point calibration object
+ * @param c   - calibration object
+ * @param cl  - external calibration constants or 0 if module
+ *              is internally calibrated
+ * @return 0 on success
+ */
+int libsfp_calfx_init(libsfp_calfx_t *c, const libsfp_calibration_fields_t *cl);
+
+/**
+ * @brief Build fixed point calibration object of module
+ * @param h  - library handle
+ * @param c  - calibration object
+ * @return 0 on success
+ */
+int libsfp_get_calfx(libsfp_t *h, libsfp_calfx_t *c);
+
+/**
+ * @brief Convert raw RX power to nW
+ * @param c    - calibration object
+ * @param raw  - raw value
+ * @return RX power (nW)
+ */
+int32_t libsfp_calfx_rxpower(const libsfp_calfx_t *c, uint16_t raw);
+
+/* Apply slope/offset in raw units: result is scaled by 256 */
+static inline int64_t libsfp_calfx_lin(uint16_t slope, int16_t offset, int32_t raw)
+{
+  return (int64_t)slope*raw + (int64_t)offset*256;
+}
+
+/** @brief Convert raw temperature (signed) to milli C */
+static inline int32_t libsfp_calfx_temp(const libsfp_calfx_t *c, uint16_t raw)
+{
+  /* 1/256 C units */
+  return (libsfp_calfx_lin(c->t_slope, c->t_offset, (int16_t)raw)*1000 +
+          (1 << 15)) >> 16;
+}
+
+/** @brief Convert raw supply voltage to uV */
+static inline int32_t libsfp_calfx_voltage(const libsfp_calfx_t *c, uint16_t raw)
+{
+  /* 100 uV units */
+  return (libsfp_calfx_lin(c->v_slope, c->v_offset, raw)*100 + (1 << 7)) >> 8;
+}
+
+/** @brief Convert raw bias current to uA */
+static inline int32_t libsfp_calfx_bias(const libsfp_calfx_t *c, uint16_t raw)
+{
+  /* 2 uA units */
+  return (libsfp_calfx_lin(c->i_slope, c->i_offset, raw) + (1 << 6)) >> 7;
+}
+
+/** @brief Convert raw TX power to nW */
+static inline int32_t libsfp_calfx_txpower(const libsfp_calfx_t *c, uint16_t raw)
+{
+  /* 0.1 uW units */
+  return (libsfp_calfx_lin(c->tx_slope, c->tx_offset, raw)*100 + (1 << 7)) >> 8;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
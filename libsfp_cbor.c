@@ -0,0 +1,482 @@
+/**
+   @file
+   @brief libsfp CBOR encoding of module information and diagnostics
+*/
+
+#include <string.h>
+#include "libsfp_int.h"
+#include "libsfp_cbor.h"
+
+/* Major types */
+#define CBOR_UINT    0
+#define CBOR_NEGINT  1
+#define CBOR_BYTES   2
+#define CBOR_TEXT    3
+#define CBOR_MAP     5
+#define CBOR_SIMPLE  7
+
+/* Additional information of floats */
+#define CBOR_HALF    25
+#define CBOR_SINGLE  26
+#define CBOR_DOUBLE  27
+
+/* All fields in registry order */
+#define LIBSFP_CBOR_ID(name, id, ...) LIBSFP_FIELD_##name,
+static const uint16_t libsfp_cbor_ids[] = {
+  LIBSFP_FIELDS(LIBSFP_CBOR_ID)
+};
+#undef LIBSFP_CBOR_ID
+
+/* Diagnostic fields change over time, the rest is static: diagnostics
+   go last in registry, so sample record takes only tail of list */
+#define LIBSFP_CBOR_DYNAMIC  LIBSFP_FIELD_SLOT_TEMPERATURE
+#define LIBSFP_CBOR_CHECK(name, id, bank, ofs, ...) \
+  _Static_assert((LIBSFP_FIELD_SLOT_##name >= LIBSFP_CBOR_DYNAMIC) == \
+                 ((LIBSFP_FIELD_BANK_##bank == LIBSFP_FIELD_BANK_A2) && \
+                  ((ofs) >= LIBSFP_OFS_A2_DIAGNOSTICS)), \
+                 "field " #name " is out of static/dynamic order");
+LIBSFP_FIELDS(LIBSFP_CBOR_CHECK)
+#undef LIBSFP_CBOR_CHECK
+
+/* Head of data item: major type and argument */
+static uint8_t *libsfp_cbor_head(uint8_t *p, uint8_t major, uint64_t v)
+{
+  int sh;
+
+  major <<= 5;
+
+  if (v < 24) {
+    *p++ = major | v;
+  } else if (v <= 0xFF) {
+    *p++ = major | 24;
+    *p++ = v;
+  } else if (v <= 0xFFFF) {
+    *p++ = major | 25;
+    *p++ = v >> 8;
+    *p++ = v;
+  } else if (v <= 0xFFFFFFFF) {
+    *p++ = major | 26;
+    *p++ = v >> 24;
+    *p++ = v >> 16;
+    *p++ = v >> 8;
+    *p++ = v;
+  } else {
+    *p++ = major | 27;
+    for (sh = 56; sh >= 0; sh -= 8)
+      *p++ = v >> sh;
+  }
+
+  return p;
+}
+
+/* Half precision if value fits it exactly, single otherwise */
+static uint8_t *libsfp_cbor_float(uint8_t *p, float v)
+{
+  uint32_t bits, m, sign;
+  uint16_t h;
+  int e, sh;
+
+  memcpy(&bits, &v, sizeof(bits));
+  sign = (bits >> 16) & 0x8000;
+  e = (bits >> 23) & 0xFF;
+  m = bits & 0x7FFFFF;
+
+  if (e == 0xFF) {
+    /* Inf or NaN (payload is not kept) */
+    h = sign | 0x7C00 | ((m) ? 0x200 : 0);
+    goto half;
+  }
+
+  if ((!e) && (!m)) {
+    h = sign;
+    goto half;
+  }
+
+  /* v = m * 2^(e-23) */
+  if (e) {
+    e -= 127;
+    m |= 0x800000;
+  } else
+    e = -126;
+
+  if ((e >= -14) && (e <= 15) && (!(m & 0x1FFF))) {
+    h = sign | ((e + 15) << 10) | ((m >> 13) & 0x3FF);
+    goto half;
+  }
+
+  /* Half subnormals are multiples of 2^-24 */
+  sh = -(e + 1);
+  if ((e >= -24) && (e < -14) && (!(m & ((1u << sh) - 1)))) {
+    h = sign | (m >> sh);
+    goto half;
+  }
+
+  *p++ = (CBOR_SIMPLE << 5) | CBOR_SINGLE;
+  *p++ = bits >> 24;
+  *p++ = bits >> 16;
+  *p++ = bits >> 8;
+  *p++ = bits;
+  return p;
+
+half:
+  *p++ = (CBOR_SIMPLE << 5) | CBOR_HALF;
+  *p++ = h >> 8;
+  *p++ = h;
+  return p;
+}
+
+static uint8_t *libsfp_cbor_int(uint8_t *p, int64_t v)
+{
+  if (v < 0)
+    return libsfp_cbor_head(p, CBOR_NEGINT, -1 - v);
+  return libsfp_cbor_head(p, CBOR_UINT, v);
+}
+
+/* String field without trailing spaces (and zeros), byte string
+   if it has non ASCII bytes */
+static uint8_t *libsfp_cbor_str(uint8_t *p, const uint8_t *raw, size_t n)
+{
+  uint8_t major = CBOR_TEXT;
+  size_t i;
+
+  while (n && ((raw[n - 1] == ' ') || (!raw[n - 1])))
+    --n;
+
+  for (i = 0; i < n; ++i)
+    if ((raw[i] < 0x20) || (raw[i] > 0x7E))
+      major = CBOR_BYTES;
+
+  p = libsfp_cbor_head(p, major, n);
+  memcpy(p, raw, n);
+
+  return p + n;
+}
+
+/* Field key and value */
+static uint8_t *libsfp_cbor_field(uint8_t *p, const libsfp_field_desc_t *fd,
+                                  const uint8_t *raw,
+                                  const libsfp_calibration_fields_t *cal)
+{
+  libsfp_field_value_t v;
+
+  p = libsfp_cbor_head(p, CBOR_UINT, fd->id);
+
+  switch (fd->type) {
+  case LIBSFP_FIELD_TYPE_STR:
+    return libsfp_cbor_str(p, raw, fd->len);
+  case LIBSFP_FIELD_TYPE_BYTES:
+    p = libsfp_cbor_head(p, CBOR_BYTES, fd->len);
+    memcpy(p, raw, fd->len);
+    return p + fd->len;
+  }
+
+  libsfp_field_decode(fd, raw, cal, &v);
+
+  if (libsfp_field_is_calibrated(fd))
+    return libsfp_cbor_float(p, v.value.f);
+
+  return libsfp_cbor_head(p, CBOR_UINT, v.value.u);
+}
+
+/**
+ * @brief Write identity record and restart sample stream
+ * @param s     - output sink
+ * @param dump  - module memory (see libsfp_readinfo)
+ * @param port  - port number
+ * @param st    - sample stream state or 0
+ * @return 0 on success
+ */
+int libsfp_cbor_identity(libsfp_sink_t *s, const libsfp_dump_t *dump,
+                         uint32_t port, libsfp_cbor_state_t *st)
+{
+  const uint8_t *bank[2] = {(const uint8_t*)&dump->a0, (const uint8_t*)&dump->a2};
+  const libsfp_calibration_fields_t *cal = 0;
+  const libsfp_field_desc_t *fd;
+  uint8_t *start, *p;
+  uint32_t i, n = 2;
+  uint8_t dmtype;
+  int ddm;
+
+  start = (uint8_t*)libsfp_sink_space(s, LIBSFP_CBOR_MAX);
+  if (!start)
+    return -1;
+
+  /* A2 bank contents is valid only if DDM is implemented */
+  dmtype = libsfp_quirk_dmtype(&dump->a0);
+  ddm = dmtype & LIBSFP_A0_DIAGMON_TYPE_DDM;
+  if (dmtype & LIBSFP_A0_DIAGMON_TYPE_EXCAL)
+    cal = &dump->a2.cl;
+
+  /* Map has more than 23 items: head is 2 bytes */
+  p = start + 2;
+  p = libsfp_cbor_int(p, LIBSFP_CBOR_KEY_TYPE);
+  p = libsfp_cbor_head(p, CBOR_UINT, LIBSFP_CBOR_REC_IDENTITY);
+  p = libsfp_cbor_int(p, LIBSFP_CBOR_KEY_PORT);
+  p = libsfp_cbor_head(p, CBOR_UINT, port);
+
+  for (i = 0; i < LIBSFP_CBOR_DYNAMIC; ++i) {
+
+    fd = libsfp_field_desc(libsfp_cbor_ids[i]);
+    if ((fd->bank == LIBSFP_FIELD_BANK_A2) && (!ddm))
+      continue;
+
+    p = libsfp_cbor_field(p, fd, bank[fd->bank] + fd->ofs, cal);
+    ++n;
+  }
+
+  start[0] = (CBOR_MAP << 5) | 24;
+  start[1] = n;
+  SK(s)->len += p - start;
+
+  if (st)
+    st->valid = 0;
+
+  return 0;
+}
+
+/**
+ * @brief Write sample record with diagnostic fields changed since
+ *        previous sample (all fields if st is 0 or stream restarted)
+ * @param s          - output sink
+ * @param dump       - module memory (see libsfp_readinfo)
+ * @param port       - port number
+ * @param timestamp  - capture time (ms) or 0 if not needed
+ * @param st         - sample stream state or 0
+ * @return 0 on success, -1 if module has no DDM or error occured
+ */
+int libsfp_cbor_sample(libsfp_sink_t *s, const libsfp_dump_t *dump,
+                       uint32_t port, uint64_t timestamp,
+                       libsfp_cbor_state_t *st)
+{
+  const uint8_t *a2 = (const uint8_t*)&dump->a2, *prev = 0;
+  const libsfp_calibration_fields_t *cal = 0;
+  const libsfp_field_desc_t *fd;
+  uint8_t *start, *p;
+  uint32_t i, n = 2;
+  uint8_t dmtype;
+
+  dmtype = libsfp_quirk_dmtype(&dump->a0);
+  if (!(dmtype & LIBSFP_A0_DIAGMON_TYPE_DDM))
+    return -1;
+
+  start = (uint8_t*)libsfp_sink_space(s, LIBSFP_CBOR_MAX);
+  if (!start)
+    return -1;
+
+  if (dmtype & LIBSFP_A0_DIAGMON_TYPE_EXCAL)
+    cal = &dump->a2.cl;
+
+  if (st && st->valid)
+    prev = (const uint8_t*)&st->dg;
+
+  /* Map has less than 24 items: head is 1 byte */
+  p = start + 1;
+  p = libsfp_cbor_int(p, LIBSFP_CBOR_KEY_TYPE);
+  p = libsfp_cbor_head(p, CBOR_UINT, LIBSFP_CBOR_REC_SAMPLE);
+  p = libsfp_cbor_int(p, LIBSFP_CBOR_KEY_PORT);
+  p = libsfp_cbor_head(p, CBOR_UINT, port);
+
+  if (timestamp) {
+    p = libsfp_cbor_int(p, LIBSFP_CBOR_KEY_TIMESTAMP);
+    p = libsfp_cbor_head(p, CBOR_UINT, timestamp);
+    ++n;
+  }
+
+  for (i = LIBSFP_CBOR_DYNAMIC; i < LIBSFP_FIELD_COUNT; ++i) {
+
+    fd = libsfp_field_desc(libsfp_cbor_ids[i]);
+
+    /* Unchanged raw value is not sent */
+    if (prev && (!memcmp(a2 + fd->ofs,
+                         prev + fd->ofs - LIBSFP_OFS_A2_DIAGNOSTICS, fd->len)))
+      continue;
+
+    p = libsfp_cbor_field(p, fd, a2 + fd->ofs, cal);
+    ++n;
+  }
+
+  start[0] = (CBOR_MAP << 5) | n;
+  SK(s)->len += p - start;
+
+  if (st) {
+    st->dg = dump->a2.dg;
+    st->valid = 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Init reader of records
+ * @param r     - reader
+ * @param data  - encoded records
+ * @param len   - data length
+ * @return 0 on success
+ */
+int libsfp_cbor_reader_init(libsfp_cbor_reader_t *r, const void *data, size_t len)
+{
+  r->p = data;
+  r->end = r->p + len;
+  r->left = 0;
+  return 0;
+}
+
+/* Read head of data item */
+static int libsfp_cbor_read_head(libsfp_cbor_reader_t *r, uint8_t *major,
+                                 uint8_t *ai, uint64_t *v)
+{
+  uint8_t n;
+
+  if (r->p >= r->end)
+    return -1;
+
+  *major = *r->p >> 5;
+  *ai = *r->p++ & 0x1F;
+
+  if (*ai < 24) {
+    *v = *ai;
+    return 0;
+  }
+
+  /* Indefinite lengths are not used */
+  if (*ai > 27)
+    return -1;
+
+  n = 1 << (*ai - 24);
+  if (r->end - r->p < n)
+    return -1;
+
+  for (*v = 0; n; --n)
+    *v = (*v << 8) | *r->p++;
+
+  return 0;
+}
+
+static float libsfp_cbor_half2float(uint16_t h)
+{
+  uint32_t bits, e = (h >> 10) & 0x1F, m = h & 0x3FF;
+  float f;
+
+  if (e == 0x1F)
+    bits = 0x7F800000 | (m << 13);
+  else if (e)
+    bits = ((e + 112) << 23) | (m << 13);
+  else {
+    /* Subnormal: m * 2^-24 */
+    f = m * (1.0f/16777216);
+    return (h & 0x8000) ? -f : f;
+  }
+
+  bits |= (uint32_t)(h & 0x8000) << 16;
+  memcpy(&f, &bits, sizeof(f));
+
+  return f;
+}
+
+/**
+ * @brief Read next item of current record
+ * @param r   - reader
+ * @param it  - place to store item
+ * @return 0 on success, -1 if record has no more items or data is malformed
+ */
+int libsfp_cbor_read_item(libsfp_cbor_reader_t *r, libsfp_cbor_item_t *it)
+{
+  uint8_t major, ai;
+  uint64_t v;
+  uint32_t bits;
+  double d;
+
+  if (!r->left)
+    return -1;
+
+  /* Key */
+  if (libsfp_cbor_read_head(r, &major, &ai, &v) || (v > 0x7FFFFFFF))
+    goto err;
+
+  if (major == CBOR_UINT)
+    it->key = v;
+  else if (major == CBOR_NEGINT)
+    it->key = -1 - (int64_t)v;
+  else
+    goto err;
+
+  /* Value */
+  if (libsfp_cbor_read_head(r, &major, &ai, &v))
+    goto err;
+
+  it->len = 0;
+
+  switch (major) {
+  case CBOR_UINT:
+  case CBOR_NEGINT:
+    if (v > 0x7FFFFFFFFFFFFFFFull)
+      goto err;
+    it->type = LIBSFP_CBOR_VAL_INT;
+    it->value.i = (major == CBOR_UINT) ? (int64_t)v : -1 - (int64_t)v;
+    break;
+  case CBOR_BYTES:
+  case CBOR_TEXT:
+    if (v > (uint64_t)(r->end - r->p))
+      goto err;
+    it->type = (major == CBOR_TEXT) ? LIBSFP_CBOR_VAL_TEXT : LIBSFP_CBOR_VAL_BYTES;
+    it->value.s = r->p;
+    it->len = v;
+    r->p += v;
+    break;
+  case CBOR_SIMPLE:
+    it->type = LIBSFP_CBOR_VAL_FLOAT;
+    if (ai == CBOR_HALF)
+      it->value.f = libsfp_cbor_half2float(v);
+    else if (ai == CBOR_SINGLE) {
+      bits = v;
+      memcpy(&it->value.f, &bits, sizeof(it->value.f));
+    } else if (ai == CBOR_DOUBLE) {
+      memcpy(&d, &v, sizeof(d));
+      it->value.f = d;
+    } else
+      goto err;
+    break;
+  default:
+    /* Records have no nested items */
+    goto err;
+  }
+
+  --r->left;
+  return 0;
+
+err:
+  r->left = 0;
+  r->p = r->end;
+  return -1;
+}
+
+/**
+ * @brief Start next record (rest of current record is skipped)
+ * @param r  - reader
+ * @return number of items in record, 0 if there are no more records,
+ *         -1 if data is malformed
+ */
+int libsfp_cbor_read_record(libsfp_cbor_reader_t *r)
+{
+  libsfp_cbor_item_t it;
+  uint8_t major, ai;
+  uint64_t v;
+
+  while (r->left)
+    if (libsfp_cbor_read_item(r, &it))
+      return -1;
+
+  if (r->p == r->end)
+    return 0;
+
+  /* Every item takes at least 2 bytes */
+  if (libsfp_cbor_read_head(r, &major, &ai, &v) || (major != CBOR_MAP) ||
+      (v > (uint64_t)(r->end - r->p)/2)) {
+    r->p = r->end;
+    return -1;
+  }
+
+  r->left = v;
+
+  return r->left;
+}
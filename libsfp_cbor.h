@@ -0,0 +1,134 @@
+#ifndef LIBSFP_CBOR_H__
+#define LIBSFP_CBOR_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (CBOR encoding of module information and diagnostics)
+
+   Records are CBOR maps (RFC 8949) written one after another (CBOR
+   sequence, RFC 8742). Map keys are field IDs (see libsfp_fields.h)
+   and negative meta keys LIBSFP_CBOR_KEY_*, so keys never change
+   between library versions. Field values are encoded by field type:
+
+   U8, U16    - unsigned integer (scaled, see field descriptor)\n
+   STR        - text string without trailing spaces, byte string if
+                field has non ASCII bytes\n
+   BYTES      - byte string\n
+   calibrated - half precision float if value fits it exactly,
+                single precision float otherwise
+
+   Identity record has all A0 fields, thresholds and DMI checksum, it
+   is sent once per module. Sample record has only diagnostic fields
+   which raw value changed since previous sample of the stream.
+
+   Reader parses records in place: strings point to input buffer.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <libsfp.h>
+#include <libsfp_fields.h>
+#include <libsfp_sink.h>
+
+/* Meta keys */
+#define LIBSFP_CBOR_KEY_TYPE       -1   /**< Record type see LIBSFP_CBOR_REC_* */
+#define LIBSFP_CBOR_KEY_PORT       -2   /**< Port number */
+#define LIBSFP_CBOR_KEY_TIMESTAMP  -3   /**< Capture time (ms, sample only) */
+
+/* Record types */
+#define LIBSFP_CBOR_REC_IDENTITY   0    /**< Static fields of module */
+#define LIBSFP_CBOR_REC_SAMPLE     1    /**< Changed diagnostic fields */
+
+/* Value types of read item */
+#define LIBSFP_CBOR_VAL_INT        0    /**< Integer (value.i) */
+#define LIBSFP_CBOR_VAL_BYTES      1    /**< Byte string (value.s, len) */
+#define LIBSFP_CBOR_VAL_TEXT       2    /**< Text string (value.s, len) */
+#define LIBSFP_CBOR_VAL_FLOAT      3    /**< Float (value.f) */
+
+#define LIBSFP_CBOR_MAX            512  /**< Max length of one record
+                                             (free sink space required) */
+
+/** Sample stream state (one per module) */
+typedef struct {
+  uint32_t valid;                       /** Previous sample was sent */
+  libsfp_rtdiagnostics_fields_t dg;     /** Diagnostics of previous sample */
+} libsfp_cbor_state_t;
+
+/** Read item */
+typedef struct {
+  int32_t key;             /** Field ID or meta key see LIBSFP_CBOR_KEY_* */
+  uint8_t type;            /** Value type see LIBSFP_CBOR_VAL_* */
+  uint32_t len;            /** String length */
+  union {
+    int64_t i;             /** Integer value */
+    float f;               /** Float value */
+    const uint8_t *s;      /** String (points to input, not zero terminated) */
+  } value;                 /** Value see LIBSFP_CBOR_VAL_* */
+} libsfp_cbor_item_t;
+
+/** Record reader */
+typedef struct {
+  const uint8_t *p;        /** Read position */
+  const uint8_t *end;      /** Input end */
+  uint32_t left;           /** Items left in current record */
+} libsfp_cbor_reader_t;
+
+/**
+ * @brief Write identity record and restart sample stream
+ * @param s     - output sink
+ * @param dump  - module memory (see libsfp_readinfo)
+ * @param port  - port number
+ * @param st    - sample stream state or 0
+ * @return 0 on success
+ */
+int libsfp_cbor_identity(libsfp_sink_t *s, const libsfp_dump_t *dump,
+                         uint32_t port, libsfp_cbor_state_t *st);
+
+/**
+ * @brief Write sample record with diagnostic fields changed since
+ *        previous sample (all fields if st is 0 or stream restarted)
+ * @param s          - output sink
+ * @param dump       - module memory (see libsfp_readinfo)
+ * @param port       - port number
+ * @param timestamp  - capture time (ms) or 0 if not needed
+ * @param st         - sample stream state or 0
+ * @return 0 on success, -1 if module has no DDM or error occured
+ */
+int libsfp_cbor_sample(libsfp_sink_t *s, const libsfp_dump_t *dump,
+                       uint32_t port, uint64_t timestamp,
+                       libsfp_cbor_state_t *st);
+
+/**
+ * @brief Init reader of records
+ * @param r     - reader
+ * @param data  - encoded records
+ * @param len   - data length
+ * @return 0 on success
+ */
+int libsfp_cbor_reader_init(libsfp_cbor_reader_t *r, const void *data, size_t len);
+
+/**
+ * @brief Start next record (rest of current record is skipped)
+ * @param r  - reader
+ * @return number of items in record, 0 if there are no more records,
+ *         -1 if data is malformed
+ */
+int libsfp_cbor_read_record(libsfp_cbor_reader_t *r);
+
+/**
+ * @brief Read next item of current record
+ * @param r   - reader
+ * @param it  - place to store item
+ * @return 0 on success, -1 if record has no more items or data is malformed
+ */
+int libsfp_cbor_read_item(libsfp_cbor_reader_t *r, libsfp_cbor_item_t *it);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,138 @@
+/**
+   @file
+   @brief libsfp fast power to dBm conversion
+*/
+
+#include "libsfp_int.h"
+#include "libsfp_dbm.h"
+
+#define LIBSFP_MDB_PER_LOG2_Q16  197283018LL   /**< 10*log10(2)*1000 (Q16),
+                                                    applied to Q16 log2 */
+
+/* log2(1 + i/256) in Q16 */
+static const uint16_t libsfp_log2_tbl[256] = {
+      0,   369,   736,  1102,  1466,  1829,  2190,  2551,
+   2909,  3267,  3623,  3978,  4331,  4683,  5034,  5384,
+   5732,  6079,  6425,  6769,  7112,  7454,  7795,  8134,
+   8473,  8810,  9146,  9480,  9814, 10146, 10477, 10807,
+  11136, 11464, 11791, 12116, 12440, 12764, 13086, 13407,
+  13727, 14046, 14363, 14680, 14996, 15310, 15624, 15937,
+  16248, 16559, 16868, 17177, 17484, 17791, 18096, 18401,
+  18704, 19007, 19308, 19609, 19909, 20207, 20505, 20802,
+  21098, 21393, 21687, 21980, 22272, 22564, 22854, 23144,
+  23433, 23720, 24007, 24293, 24579, 24863, 25146, 25429,
+  25711, 25992, 26272, 26551, 26830, 27108, 27384, 27660,
+  27936, 28210, 28484, 28757, 29029, 29300, 29571, 29840,
+  30109, 30378, 30645, 30912, 31178, 31443, 31707, 31971,
+  32234, 32496, 32758, 33019, 33279, 33538, 33797, 34055,
+  34312, 34569, 34825, 35080, 35334, 35588, 35841, 36094,
+  36346, 36597, 36847, 37097, 37346, 37595, 37842, 38090,
+  38336, 38582, 38827, 39072, 39316, 39559, 39802, 40044,
+  40286, 40527, 40767, 41006, 41246, 41484, 41722, 41959,
+  42196, 42432, 42667, 42902, 43137, 43370, 43603, 43836,
+  44068, 44300, 44530, 44761, 44990, 45220, 45448, 45676,
+  45904, 46131, 46357, 46583, 46809, 47034, 47258, 47482,
+  47705, 47928, 48150, 48372, 48593, 48813, 49034, 49253,
+  49472, 49691, 49909, 50127, 50344, 50560, 50776, 50992,
+  51207, 51422, 51636, 51850, 52063, 52276, 52488, 52700,
+  52911, 53122, 53332, 53542, 53751, 53960, 54169, 54377,
+  54584, 54791, 54998, 55204, 55410, 55615, 55820, 56025,
+  56229, 56432, 56635, 56838, 57040, 57242, 57443, 57644,
+  57845, 58045, 58245, 58444, 58643, 58841, 59039, 59237,
+  59434, 59631, 59827, 60023, 60219, 60414, 60609, 60803,
+  60997, 61190, 61384, 61576, 61769, 61961, 62152, 62343,
+  62534, 62725, 62915, 63104, 63294, 63483, 63671, 63859,
+  64047, 64234, 64421, 64608, 64794, 64980, 65166, 65351
+};
+
+/**
+ * @brief Calc log2 of value
+ * @param v  value (not zero)
+ * @return log2 (Q16)
+ */
+static int32_t libsfp_log2_q16(uint32_t v)
+{
+  uint32_t n, f, idx, frac, l;
+
+  n = 31 - __builtin_clz(v);
+  f = v << (31 - n);
+  idx = (f >> 23) & 0xFF;
+  frac = (f >> 15) & 0xFF;
+
+  /* log2(2) = 1.0 does not fit table */
+  l = (idx < 255) ? libsfp_log2_tbl[idx + 1] : 65536;
+  l = libsfp_log2_tbl[idx] + (((l - libsfp_log2_tbl[idx])*frac + 128) >> 8);
+
+  return (n << 16) + l;
+}
+
+static int32_t libsfp_log2_to_mdb(int32_t l2)
+{
+  /* Q16 * Q16 product is Q32 */
+  return ((int64_t)l2*LIBSFP_MDB_PER_LOG2_Q16 + (1LL << 31)) >> 32;
+}
+
+/**
+ * @brief Convert raw power (0.1 uW units) to milli-dBm
+ * @param raw  - raw power value
+ * @return power (milli-dBm)
+ */
+int32_t libsfp_raw2mdbm(uint16_t raw)
+{
+  if (!raw)
+    return LIBSFP_MDBM_FLOOR;
+
+  /* 0.1 uW = -40 dBm */
+  return libsfp_log2_to_mdb(libsfp_log2_q16(raw)) + LIBSFP_MDBM_FLOOR;
+}
+
+/**
+ * @brief Convert power in nW to milli-dBm
+ * @param nw  - power (nW)
+ * @return power (milli-dBm)
+ */
+int32_t libsfp_nw2mdbm(int32_t nw)
+{
+  if (nw < 100)
+    return LIBSFP_MDBM_FLOOR;
+
+  /* 1 nW = -60 dBm */
+  return libsfp_log2_to_mdb(libsfp_log2_q16(nw)) - 60000;
+}
+
+/**
+ * @brief Get margin between raw power and raw threshold
+ * @param raw  - raw power value
+ * @param th   - raw threshold value
+ * @return margin (milli-dB), positive if power is above threshold
+ */
+int32_t libsfp_raw_mdb_margin(uint16_t raw, uint16_t th)
+{
+  return libsfp_raw2mdbm(raw) - libsfp_raw2mdbm(th);
+}
+
+/**
+ * @brief Convert array of powers to dBm
+ * @param mw   - powers (mW)
+ * @param dbm  - place to store powers (dBm)
+ * @param n    - number of values
+ */
+void libsfp_dbm_batch(const float *mw, float *dbm, size_t n)
+{
+  size_t i;
+  for (i = 0; i < n; ++i)
+    dbm[i] = libsfp_dbm(mw[i]);
+}
+
+/**
+ * @brief Convert array of raw power fields to milli-dBm
+ * @param raw   - raw power fields (big endian, as in A2 bank)
+ * @param mdbm  - place to store powers (milli-dBm)
+ * @param n     - number of values
+ */
+void libsfp_raw2mdbm_batch(const libsfp_u16_field_t *raw, int32_t *mdbm, size_t n)
+{
+  size_t i;
+  for (i = 0; i < n; ++i)
+    mdbm[i] = libsfp_raw2mdbm((raw[i].d[0] << 8) | raw[i].d[1]);
+}
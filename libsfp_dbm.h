@@ -0,0 +1,109 @@
+#ifndef LIBSFP_DBM_H__
+#define LIBSFP_DBM_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (fast power to dBm conversion)
+
+   Float conversion takes binary exponent of value and 5th order
+   polynomial of log2 on mantissa, max error is 0.0001 dB.\n
+   Fixed point conversion uses 256 entries log2 table with linear
+   interpolation, max error is 1 milli-dB.\n
+   Powers below 0.1 uW (one raw unit) give LIBSFP_DBM_FLOOR.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <string.h>
+#include <libsfp.h>
+
+#define LIBSFP_DBM_FLOOR    (-40.0f)    /**< Lowest reported level (dBm) */
+#define LIBSFP_MDBM_FLOOR   (-40000)    /**< Lowest reported level (milli-dBm) */
+
+#define LIBSFP_DBM_PER_LOG2  3.01029996f   /**< 10*log10(2) */
+
+/**
+ * @brief Convert power to dBm
+ * @param mw  - power (mW)
+ * @return power (dBm)
+ */
+static inline float libsfp_dbm(float mw)
+{
+  uint32_t u;
+  float m, p;
+  int e;
+
+  if (!(mw >= 1e-4f))
+    return LIBSFP_DBM_FLOOR;
+
+  memcpy(&u, &mw, sizeof(u));
+  e = (int)(u >> 23) - 127;
+  u = (u & 0x7FFFFF) | 0x3F800000;
+  memcpy(&m, &u, sizeof(m));
+  m -= 1.0f;
+
+  /* log2(1 + m), m in [0, 1) */
+  p = ((((0.0463851977f*m - 0.19626929f)*m + 0.417595534f)*m -
+        0.709662753f)*m + 1.44196561f)*m;
+
+  return ((float)e + p)*LIBSFP_DBM_PER_LOG2;
+}
+
+/**
+ * @brief Get margin between power and threshold
+ * @param mw  - power (mW)
+ * @param th  - threshold (mW)
+ * @return margin (dB), positive if power is above threshold
+ */
+static inline float libsfp_db_margin(float mw, float th)
+{
+  return libsfp_dbm(mw) - libsfp_dbm(th);
+}
+
+/**
+ * @brief Convert raw power (0.1 uW units) to milli-dBm
+ * @param raw  - raw power value
+ * @return power (milli-dBm)
+ */
+int32_t libsfp_raw2mdbm(uint16_t raw);
+
+/**
+ * @brief Convert power in nW to milli-dBm
+ * @param nw  - power (nW)
+ * @return power (milli-dBm)
+ */
+int32_t libsfp_nw2mdbm(int32_t nw);
+
+/**
+ * @brief Get margin between raw power and raw threshold
+ * @param raw  - raw power value
+ * @param th   - raw threshold value
+ * @return margin (milli-dB), positive if power is above threshold
+ */
+int32_t libsfp_raw_mdb_margin(uint16_t raw, uint16_t th);
+
+/**
+ * @brief Convert array of powers to dBm
+ * @param mw   - powers (mW)
+ * @param dbm  - place to store powers (dBm)
+ * @param n    - number of values
+ */
+void libsfp_dbm_batch(const float *mw, float *dbm, size_t n);
+
+/**
+ * @brief Convert array of raw power fields to milli-dBm
+ * @param raw   - raw power fields (big endian, as in A2 bank)
+ * @param mdbm  - place to store powers (milli-dBm)
+ * @param n     - number of values
+ */
+void libsfp_raw2mdbm_batch(const libsfp_u16_field_t *raw, int32_t *mdbm, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,173 @@
+/**
+   @file
+   @brief libsfp structured decode of module memory
+*/
+
+#include <string.h>
+#include "libsfp_int.h"
+#include "libsfp_decode.h"
+#include "libsfp_cal.h"
+
+/* Alarm/warning flag bits of analog channels (A2 bytes 112-113, 116-117) */
+static const struct {
+  uint8_t byte;
+  uint8_t hbit;
+  uint8_t lbit;
+} libsfp_decode_aw_table[LIBSFP_DECODED_CHANNELS] = {
+  {0, 7, 6},
+  {0, 5, 4},
+  {0, 3, 2},
+  {0, 1, 0},
+  {1, 7, 6}
+};
+
+static void libsfp_decode_str(char *dst, const uint8_t *src, size_t len)
+{
+  memcpy(dst, src, len);
+  dst[len] = 0;
+}
+
+static uint16_t libsfp_decode_u16(libsfp_u16_field_t f)
+{
+  return (f.d[0] << 8) | f.d[1];
+}
+
+/* Calibrated value of analog channel */
+static float libsfp_decode_value(uint8_t ch, libsfp_u16_field_t v,
+                                 const libsfp_cal_t *c)
+{
+  uint16_t raw = libsfp_cal_raw(v);
+
+  switch (ch) {
+  case LIBSFP_DECODED_TEMP:
+    return libsfp_cal_temp(c, raw);
+  case LIBSFP_DECODED_VCC:
+    return libsfp_cal_voltage(c, raw);
+  case LIBSFP_DECODED_BIAS:
+    return libsfp_cal_bias(c, raw);
+  case LIBSFP_DECODED_TXPOWER:
+    return libsfp_cal_txpower(c, raw);
+  default:
+    return libsfp_cal_rxpower(c, raw);
+  }
+}
+
+static void libsfp_decode_a0(const libsfp_A0_t *a0, libsfp_decoded_t *d)
+{
+  const libsfp_base_fields_t *b = &a0->base;
+  const libsfp_extended_fields_t *e = &a0->ext;
+
+  d->identifier = b->identifier;
+  d->ext_identifier = b->ext_identifier;
+  d->connector = b->connector;
+  d->encoding = b->encoding;
+  d->rate_identifier = b->rate_identifier;
+  memcpy(d->transceiver, b->transceiver, sizeof(d->transceiver));
+  memcpy(d->vendor_oui, b->vendor_oui, sizeof(d->vendor_oui));
+
+  d->bitrate = b->br_nominal*100;
+  d->spmode = libsfp_bitrate2speed_mode(b->br_nominal);
+  if (d->spmode == LIBSFP_SPEED_MODE_UNKNOWN)
+    d->spmode = libsfp_transceiver2speed_mode(b->transceiver);
+  d->br_max = e->br_max;
+  d->br_min = e->br_min;
+
+  /* Length units: SFF-8472 table 4-1 */
+  d->length_smf = (b->length_smf_km) ? b->length_smf_km*1000 :
+                                       b->length_smf*100;
+  d->length_50um = b->length_50um*10;
+  d->length_625um = b->length_625um*10;
+  d->length_cable = b->length_cable;
+  d->length_om3 = b->length_om3*10;
+
+  /* Copper modules use wavelength field for cable compliance */
+  if (libsfp_is_laser_availble(b)) {
+    d->flags |= LIBSFP_DECODED_LASER;
+    d->wavelength = libsfp_decode_u16(b->wavelength);
+  }
+
+  d->options = libsfp_decode_u16(e->options);
+  d->diag_mon_type = libsfp_quirk_dmtype(a0);
+  d->en_options = e->en_options;
+  d->sff8472_comp = e->sff8472_comp;
+
+  libsfp_decode_str(d->vendor, b->vendor_name, LIBSFP_LEN_A0_VENDOR_NAME);
+  libsfp_decode_str(d->partnum, b->vendor_pn, LIBSFP_LEN_A0_VENDOR_PN);
+  libsfp_decode_str(d->revision, b->vendor_rev, LIBSFP_LEN_A0_VENDOR_REV);
+  libsfp_decode_str(d->serial, e->vendor_sn, LIBSFP_LEN_A0_VENDOR_SN);
+  libsfp_decode_str(d->date_code, e->date_code, LIBSFP_LEN_A0_DATE_CODE);
+
+  if (b->cc_base == libsfp_calc_csum(b, sizeof(*b) - 1))
+    d->flags |= LIBSFP_DECODED_CSUM_BASE;
+  if (e->cc_ext == libsfp_calc_csum(e, sizeof(*e) - 1))
+    d->flags |= LIBSFP_DECODED_CSUM_EXT;
+}
+
+static void libsfp_decode_a2(const libsfp_A2_t *a2, libsfp_decoded_t *d)
+{
+  libsfp_cal_t cal;
+  const libsfp_u16_field_t *th = &a2->th.temp_alarm_high;
+  const libsfp_u16_field_t *v = &a2->dg.temperature;
+  uint8_t ch, aw;
+
+  d->flags |= LIBSFP_DECODED_DDM;
+
+  if (d->diag_mon_type & LIBSFP_A0_DIAGMON_TYPE_EXCAL) {
+    d->flags |= LIBSFP_DECODED_EXCAL;
+    libsfp_cal_init(&cal, &a2->cl);
+  } else
+    libsfp_cal_init(&cal, 0);
+
+  if (d->en_options & LIBSFP_A0_ENHANCED_OPTIONS_AWFLAGS)
+    d->flags |= LIBSFP_DECODED_AWFLAGS;
+
+  if (a2->cc_dmi == libsfp_calc_csum(a2, sizeof(a2->th) + sizeof(a2->cl) - 1))
+    d->flags |= LIBSFP_DECODED_CSUM_DMI;
+
+  d->status = a2->dg.status;
+
+  /* Thresholds go as alarm high/low, warning high/low per channel */
+  for (ch = 0; ch < LIBSFP_DECODED_CHANNELS; ++ch, th += 4) {
+
+    d->values[ch] = libsfp_decode_value(ch, v[ch], &cal);
+
+    d->th[ch].alarm_high = libsfp_decode_value(ch, th[0], &cal);
+    d->th[ch].alarm_low = libsfp_decode_value(ch, th[1], &cal);
+    d->th[ch].warn_high = libsfp_decode_value(ch, th[2], &cal);
+    d->th[ch].warn_low = libsfp_decode_value(ch, th[3], &cal);
+
+    if (!(d->flags & LIBSFP_DECODED_AWFLAGS))
+      continue;
+
+    aw = a2->dg.alarms[libsfp_decode_aw_table[ch].byte];
+    if (aw & (1 << libsfp_decode_aw_table[ch].hbit))
+      d->aw[ch] |= LIBSFP_DECODED_ALARM_HIGH;
+    if (aw & (1 << libsfp_decode_aw_table[ch].lbit))
+      d->aw[ch] |= LIBSFP_DECODED_ALARM_LOW;
+
+    aw = a2->dg.warnings[libsfp_decode_aw_table[ch].byte];
+    if (aw & (1 << libsfp_decode_aw_table[ch].hbit))
+      d->aw[ch] |= LIBSFP_DECODED_WARN_HIGH;
+    if (aw & (1 << libsfp_decode_aw_table[ch].lbit))
+      d->aw[ch] |= LIBSFP_DECODED_WARN_LOW;
+  }
+}
+
+/**
+ * @brief Decode module memory
+ * @param dump  - module memory (see libsfp_readinfo)
+ * @param d     - struct to store decoded information
+ * @return 0 on success
+ */
+int libsfp_decode(const libsfp_dump_t *dump, libsfp_decoded_t *d)
+{
+  memset(d, 0, sizeof(*d));
+
+  libsfp_decode_a0(&dump->a0, d);
+
+  /* A2 bank contents is valid only if DDM is implemented */
+  if (d->diag_mon_type & LIBSFP_A0_DIAGMON_TYPE_DDM)
+    libsfp_decode_a2(&dump->a2, d);
+
+  return 0;
+}
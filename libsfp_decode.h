@@ -0,0 +1,99 @@
+#ifndef LIBSFP_DECODE_H__
+#define LIBSFP_DECODE_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (structured decode of module memory)
+
+   Decode converts raw module memory (see libsfp_readinfo) to
+   plain values without any allocation, callback or text formatting.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libsfp.h>
+
+/* Decoded flags */
+#define LIBSFP_DECODED_LASER      0x01   /**< Module has laser (not copper) */
+#define LIBSFP_DECODED_DDM        0x02   /**< DDM values are valid */
+#define LIBSFP_DECODED_EXCAL      0x04   /**< External calibration applied */
+#define LIBSFP_DECODED_AWFLAGS    0x08   /**< Alarm/warning flags are valid */
+#define LIBSFP_DECODED_CSUM_BASE  0x10   /**< Base fields checksum is correct */
+#define LIBSFP_DECODED_CSUM_EXT   0x20   /**< Ext fields checksum is correct */
+#define LIBSFP_DECODED_CSUM_DMI   0x40   /**< DMI checksum is correct */
+
+/* Analog channels */
+#define LIBSFP_DECODED_TEMP       0      /**< Temperature (C) */
+#define LIBSFP_DECODED_VCC        1      /**< Supply voltage (V) */
+#define LIBSFP_DECODED_BIAS       2      /**< TX bias current (mA) */
+#define LIBSFP_DECODED_TXPOWER    3      /**< TX power (mW) */
+#define LIBSFP_DECODED_RXPOWER    4      /**< RX power (mW) */
+#define LIBSFP_DECODED_CHANNELS   5
+
+/* Per channel alarm/warning bits */
+#define LIBSFP_DECODED_ALARM_HIGH 0x01
+#define LIBSFP_DECODED_ALARM_LOW  0x02
+#define LIBSFP_DECODED_WARN_HIGH  0x04
+#define LIBSFP_DECODED_WARN_LOW   0x08
+
+/** Decoded thresholds of analog channel */
+typedef struct {
+  float alarm_high;
+  float alarm_low;
+  float warn_high;
+  float warn_low;
+} libsfp_decoded_th_t;
+
+/** Decoded module information */
+typedef struct {
+  uint32_t flags;               /** Decoded flags see LIBSFP_DECODED_* */
+  uint32_t bitrate;             /** Nominal bitrate (MBit/s) */
+  uint32_t spmode;              /** Speed mode see LIBSFP_SPEED_MODE_* */
+  uint32_t length_smf;          /** Link length for SMF (m) */
+  uint32_t length_50um;         /** Link length for 50um OM2 (m) */
+  uint32_t length_625um;        /** Link length for 62.5um OM1 (m) */
+  uint32_t length_cable;        /** Link length for copper/DAC (m) */
+  uint32_t length_om3;          /** Link length for 50um OM3 (m) */
+  uint16_t wavelength;          /** Laser wavelength (nm, 0 if no laser) */
+  uint16_t options;             /** Options see A0 bytes 64-65 */
+  uint8_t identifier;           /** Module identifier */
+  uint8_t ext_identifier;       /** Extended identifier */
+  uint8_t connector;            /** Connector type see LIBSFP_A0_CONNECTOR_* */
+  uint8_t encoding;             /** Encoding */
+  uint8_t rate_identifier;      /** Rate identifier */
+  uint8_t br_max;               /** Upper bitrate margin (%) */
+  uint8_t br_min;               /** Lower bitrate margin (%) */
+  uint8_t diag_mon_type;        /** see LIBSFP_A0_DIAGMON_TYPE_*
+                                    (with module quirks applied) */
+  uint8_t en_options;           /** see LIBSFP_A0_ENHANCED_OPTIONS_* */
+  uint8_t sff8472_comp;         /** SFF-8472 compliance */
+  uint8_t transceiver[8];       /** Transceiver compliance codes */
+  uint8_t vendor_oui[3];        /** Vendor OUI */
+  char vendor[17];              /** Vendor name */
+  char partnum[17];             /** Part number */
+  char revision[5];             /** Revision */
+  char serial[17];              /** Serial number */
+  char date_code[9];            /** Manufacturing date code */
+  uint8_t status;               /** see LIBSFP_A2_STATUSCONTROL_* */
+  uint8_t aw[LIBSFP_DECODED_CHANNELS];    /** Alarm/warning bits of channels
+                                              see LIBSFP_DECODED_ALARM_* */
+  float values[LIBSFP_DECODED_CHANNELS];  /** Calibrated analog values */
+  libsfp_decoded_th_t th[LIBSFP_DECODED_CHANNELS];  /** Calibrated thresholds */
+} __attribute__((aligned(64))) libsfp_decoded_t;
+
+/**
+ * @brief Decode module memory
+ * @param dump  - module memory (see libsfp_readinfo)
+ * @param d     - struct to store decoded information
+ * @return 0 on success
+ */
+int libsfp_decode(const libsfp_dump_t *dump, libsfp_decoded_t *d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,377 @@
+/**
+   @file
+   @brief libsfp field descriptors and query by field ID
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include "libsfp_int.h"
+#include "libsfp_fields.h"
+
+#define ARRAY_SIZE(a) (sizeof(a)/sizeof(a[0]))
+
+#define LIBSFP_QUERY_OVERHEAD  4    /**< Transaction overhead (bytes): device
+                                         address, offset, repeated start and
+                                         device address */
+#define LIBSFP_QUERY_BYTE_US   90   /**< Byte time at 100 kHz (9 bits, us) */
+
+/* Bank struct of field bank */
+#define LIBSFP_FIELD_STRUCT_A0  libsfp_A0_t
+#define LIBSFP_FIELD_STRUCT_A2  libsfp_A2_t
+
+/* Check register offsets and lengths against bank structs */
+#define LIBSFP_FIELD_CHECK(name, id, bank, ofs, len, member, type, unit, scale) \
+  _Static_assert(offsetof(LIBSFP_FIELD_STRUCT_##bank, member) == (ofs), \
+                 "field " #name " offset mismatch"); \
+  _Static_assert(sizeof(((LIBSFP_FIELD_STRUCT_##bank*)0)->member) == (len), \
+                 "field " #name " length mismatch");
+LIBSFP_FIELDS(LIBSFP_FIELD_CHECK)
+#undef LIBSFP_FIELD_CHECK
+
+/* Descriptor table indexed by field ID */
+#define LIBSFP_FIELD_DESC(name, id, bank, ofs, len, member, type, unit, scale) \
+  [id] = {id, LIBSFP_FIELD_BANK_##bank, ofs, len, LIBSFP_FIELD_TYPE_##type, \
+          LIBSFP_FIELD_UNIT_##unit, scale, #name},
+static const libsfp_field_desc_t libsfp_fields_tbl[LIBSFP_FIELD_MAX] = {
+  LIBSFP_FIELDS(LIBSFP_FIELD_DESC)
+};
+#undef LIBSFP_FIELD_DESC
+
+/* Dense field numbers indexed by field ID (0 - unknown field) */
+#define LIBSFP_FIELD_SLOTNUM(name, id, ...) [id] = LIBSFP_FIELD_SLOT_##name + 1,
+static const uint8_t libsfp_fields_slots[LIBSFP_FIELD_MAX] = {
+  LIBSFP_FIELDS(LIBSFP_FIELD_SLOTNUM)
+};
+#undef LIBSFP_FIELD_SLOTNUM
+
+/** Byte range to read */
+typedef struct {
+  uint8_t ofs;
+  uint16_t len;
+} libsfp_query_range_t;
+
+typedef void (*libsfp_field_decode_fun)(const libsfp_field_desc_t *fd,
+                                        const uint8_t *raw,
+                                        const libsfp_calibration_fields_t *cal,
+                                        libsfp_field_value_t *v);
+
+static libsfp_u16_field_t libsfp_field_u16(const uint8_t *raw)
+{
+  libsfp_u16_field_t f;
+  f.d[0] = raw[0];
+  f.d[1] = raw[1];
+  return f;
+}
+
+static void libsfp_field_u8(const libsfp_field_desc_t *fd, const uint8_t *raw,
+                            const libsfp_calibration_fields_t *cal,
+                            libsfp_field_value_t *v)
+{
+  (void)cal;
+
+  v->value.u = raw[0]*fd->scale;
+}
+
+static void libsfp_field_u16be(const libsfp_field_desc_t *fd, const uint8_t *raw,
+                               const libsfp_calibration_fields_t *cal,
+                               libsfp_field_value_t *v)
+{
+  (void)cal;
+
+  v->value.u = ((raw[0] << 8) | raw[1])*fd->scale;
+}
+
+static void libsfp_field_str(const libsfp_field_desc_t *fd, const uint8_t *raw,
+                             const libsfp_calibration_fields_t *cal,
+                             libsfp_field_value_t *v)
+{
+  (void)cal;
+
+  memcpy(v->value.s, raw, fd->len);
+  v->value.s[fd->len] = 0;
+}
+
+static void libsfp_field_bytes(const libsfp_field_desc_t *fd, const uint8_t *raw,
+                               const libsfp_calibration_fields_t *cal,
+                               libsfp_field_value_t *v)
+{
+  (void)cal;
+
+  memcpy(v->value.b, raw, fd->len);
+}
+
+static void libsfp_field_temp(const libsfp_field_desc_t *fd, const uint8_t *raw,
+                              const libsfp_calibration_fields_t *cal,
+                              libsfp_field_value_t *v)
+{
+  (void)fd;
+
+  v->value.f = libsfp_get_temp(libsfp_field_u16(raw), cal);
+}
+
+static void libsfp_field_vcc(const libsfp_field_desc_t *fd, const uint8_t *raw,
+                             const libsfp_calibration_fields_t *cal,
+                             libsfp_field_value_t *v)
+{
+  (void)fd;
+
+  v->value.f = libsfp_get_voltage(libsfp_field_u16(raw), cal);
+}
+
+static void libsfp_field_bias(const libsfp_field_desc_t *fd, const uint8_t *raw,
+                              const libsfp_calibration_fields_t *cal,
+                              libsfp_field_value_t *v)
+{
+  (void)fd;
+
+  v->value.f = libsfp_get_biascurrent(libsfp_field_u16(raw), cal);
+}
+
+static void libsfp_field_txpwr(const libsfp_field_desc_t *fd, const uint8_t *raw,
+                               const libsfp_calibration_fields_t *cal,
+                               libsfp_field_value_t *v)
+{
+  (void)fd;
+
+  v->value.f = libsfp_get_txpower(libsfp_field_u16(raw),
+                                  (cal) ? &cal->tx_pwr_slope : 0,
+                                  (cal) ? &cal->tx_pwr_offset : 0);
+}
+
+static void libsfp_field_rxpwr(const libsfp_field_desc_t *fd, const uint8_t *raw,
+                               const libsfp_calibration_fields_t *cal,
+                               libsfp_field_value_t *v)
+{
+  (void)fd;
+
+  v->value.f = libsfp_get_rxpower(libsfp_field_u16(raw), (cal) ? cal->rx_pwr : 0);
+}
+
+/* Decoders indexed by field type */
+static const libsfp_field_decode_fun libsfp_field_decoders[] = {
+  [LIBSFP_FIELD_TYPE_U8] = libsfp_field_u8,
+  [LIBSFP_FIELD_TYPE_U16] = libsfp_field_u16be,
+  [LIBSFP_FIELD_TYPE_STR] = libsfp_field_str,
+  [LIBSFP_FIELD_TYPE_BYTES] = libsfp_field_bytes,
+  [LIBSFP_FIELD_TYPE_TEMP] = libsfp_field_temp,
+  [LIBSFP_FIELD_TYPE_VCC] = libsfp_field_vcc,
+  [LIBSFP_FIELD_TYPE_BIAS] = libsfp_field_bias,
+  [LIBSFP_FIELD_TYPE_TXPWR] = libsfp_field_txpwr,
+  [LIBSFP_FIELD_TYPE_RXPWR] = libsfp_field_rxpwr
+};
+
+/**
+ * @brief Get field descriptor
+ * @param id  - field ID see LIBSFP_FIELD_*
+ * @return descriptor or 0 if field is unknown
+ */
+const libsfp_field_desc_t *libsfp_field_desc(uint32_t id)
+{
+  if ((id >= LIBSFP_FIELD_MAX) || (!libsfp_fields_tbl[id].id))
+    return 0;
+  return &libsfp_fields_tbl[id];
+}
+
+/**
+ * @brief Get dense field number
+ * @param id  - field ID see LIBSFP_FIELD_*
+ * @return field number or -1 if field is unknown
+ */
+int libsfp_field_slot(uint32_t id)
+{
+  if (id >= LIBSFP_FIELD_MAX)
+    return -1;
+  return (int)libsfp_fields_slots[id] - 1;
+}
+
+/**
+ * @brief Check that field value depends on calibration data
+ * @param fd  field descriptor
+ * @return 1 if field is calibrated
+ */
+int libsfp_field_is_calibrated(const libsfp_field_desc_t *fd)
+{
+  return fd->type >= LIBSFP_FIELD_TYPE_TEMP;
+}
+
+/**
+ * @brief Decode field from raw bank data
+ * @param fd   field descriptor
+ * @param raw  field raw data
+ * @param cal  external calibration constants or 0
+ * @param v    place to store value
+ */
+void libsfp_field_decode(const libsfp_field_desc_t *fd, const uint8_t *raw,
+                         const libsfp_calibration_fields_t *cal,
+                         libsfp_field_value_t *v)
+{
+  memset(v, 0, sizeof(*v));
+  v->id = fd->id;
+  v->type = fd->type;
+  v->unit = fd->unit;
+  libsfp_field_decoders[fd->type](fd, raw, cal, v);
+}
+
+/**
+ * @brief Make list of ranges covering needed bytes\n
+ *        (gaps shorter than transaction overhead are read too)
+ * @param need    needed bytes map (256 bytes)
+ * @param ranges  place to store ranges
+ * @return number of ranges
+ */
+static uint32_t libsfp_query_ranges(const uint8_t *need,
+                                    libsfp_query_range_t *ranges)
+{
+  uint32_t i, n = 0, last = 0;
+
+  for (i = 0; i < 256; ++i) {
+
+    if (!need[i])
+      continue;
+
+    if (n && (i - last <= LIBSFP_QUERY_OVERHEAD + 1)) {
+      ranges[n-1].len = i - ranges[n-1].ofs + 1;
+    } else {
+      ranges[n].ofs = i;
+      ranges[n].len = 1;
+      ++n;
+    }
+
+    last = i;
+  }
+
+  return n;
+}
+
+/* Read bank ranges and update plan */
+static int libsfp_query_read(libsfp_t *h, uint8_t addr, const uint8_t *need,
+                             uint8_t *data, libsfp_query_plan_t *plan)
+{
+  libsfp_query_range_t ranges[128];
+  uint32_t i, n, max_read;
+
+  n = libsfp_query_ranges(need, ranges);
+
+  for (i = 0; i < n; ++i) {
+
+    if (READREG(h, addr, ranges[i].ofs, ranges[i].len, data + ranges[i].ofs))
+      return -1;
+
+    /* Ranges are split to transactions by read size quirk */
+    max_read = H(h)->max_read;
+    plan->transactions += (max_read) ?
+                          (ranges[i].len + max_read - 1) / max_read : 1;
+    plan->bytes += ranges[i].len;
+  }
+
+  return 0;
+}
+
+static void libsfp_query_need(uint8_t *need, uint8_t ofs, uint8_t len)
+{
+  memset(need + ofs, 1, len);
+}
+
+/* Take static data from shadow cache and drop it from needed ranges */
+static int libsfp_query_cached(libsfp_t *h, uint8_t need[2][256], uint8_t **bank)
+{
+  libsfp_cache_t *c = &H(h)->cache;
+
+  if (libsfp_cache_update(h))
+    return -1;
+
+  memcpy(bank[LIBSFP_FIELD_BANK_A0], &c->dump.a0, sizeof(libsfp_A0_t));
+  memset(need[LIBSFP_FIELD_BANK_A0], 0, sizeof(libsfp_A0_t));
+
+  /* Only thresholds, calibrations and cc_dmi of A2 are static */
+  if (c->state & LIBSFP_CACHE_A2_VALID) {
+    memcpy(bank[LIBSFP_FIELD_BANK_A2], &c->dump.a2, LIBSFP_OFS_A2_DIAGNOSTICS);
+    memset(need[LIBSFP_FIELD_BANK_A2], 0, LIBSFP_OFS_A2_DIAGNOSTICS);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Read set of fields using minimal number of transactions\n
+ *        (calibrated values also read calibration data they depend on,
+ *        static data is taken from shadow cache if it is enabled)
+ * @param h     - library handle
+ * @param ids   - array of field IDs see LIBSFP_FIELD_*
+ * @param n     - number of fields
+ * @param out   - array of n values to store fields
+ * @param plan  - place to store executed plan or 0 if not needed
+ * @return 0 on success
+ */
+int libsfp_query(libsfp_t *h, const uint16_t *ids, uint32_t n,
+                 libsfp_field_value_t *out, libsfp_query_plan_t *plan)
+{
+  libsfp_dump_t dump;
+  uint8_t need[2][256], *bank[2];
+  const libsfp_field_desc_t *fd;
+  const libsfp_calibration_fields_t *cal = 0;
+  libsfp_query_plan_t pl;
+  uint32_t i, calibrated = 0, a2 = 0;
+  uint8_t dmtype;
+
+  memset(need, 0, sizeof(need));
+  memset(&pl, 0, sizeof(pl));
+  bank[LIBSFP_FIELD_BANK_A0] = (uint8_t*)&dump.a0;
+  bank[LIBSFP_FIELD_BANK_A2] = (uint8_t*)&dump.a2;
+
+  for (i = 0; i < n; ++i) {
+
+    fd = libsfp_field_desc(ids[i]);
+    if (!fd)
+      return -1;
+
+    libsfp_query_need(need[fd->bank], fd->ofs, fd->len);
+
+    if (fd->bank == LIBSFP_FIELD_BANK_A2)
+      a2 = 1;
+    if (libsfp_field_is_calibrated(fd))
+      calibrated = 1;
+  }
+
+  /* Calibration type (with module quirks) is needed before
+   * A2 bank ranges are known */
+  if (calibrated) {
+    if (libsfp_get_dmtype(h, &dmtype))
+      return -1;
+
+    if (dmtype & LIBSFP_A0_DIAGMON_TYPE_EXCAL) {
+      libsfp_query_need(need[LIBSFP_FIELD_BANK_A2],
+                        LIBSFP_OFS_A2_EXT_CAL_CONSTANTS,
+                        LIBSFP_LEN_A2_EXT_CAL_CONSTANTS);
+      cal = &dump.a2.cl;
+    }
+  }
+
+  if (a2 && libsfp_cache_a2_check(h))
+    return -1;
+
+  if ((H(h)->flags & LIBSFP_FLAGS_CACHE) &&
+      libsfp_query_cached(h, need, bank))
+    return -1;
+
+  if (libsfp_query_read(h, H(h)->a0addr, need[LIBSFP_FIELD_BANK_A0],
+                        bank[LIBSFP_FIELD_BANK_A0], &pl))
+    return -1;
+
+  if (a2 && libsfp_query_read(h, H(h)->a2addr, need[LIBSFP_FIELD_BANK_A2],
+                              bank[LIBSFP_FIELD_BANK_A2], &pl))
+    return -1;
+
+  for (i = 0; i < n; ++i) {
+    fd = &libsfp_fields_tbl[ids[i]];
+    libsfp_field_decode(fd, bank[fd->bank] + fd->ofs, cal, &out[i]);
+  }
+
+  if (plan) {
+    pl.bus_time = (pl.bytes + pl.transactions*LIBSFP_QUERY_OVERHEAD)*
+                  LIBSFP_QUERY_BYTE_US;
+    (*plan) = pl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,193 @@
+#ifndef LIBSFP_FIELDS_H__
+#define LIBSFP_FIELDS_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (field descriptors and query by field ID)
+
+   Every known module field has stable numeric ID (values never
+   change between library versions). Query reads set of fields
+   merging their byte ranges to minimal number of transactions.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libsfp.h>
+
+/* Field banks */
+#define LIBSFP_FIELD_BANK_A0  0
+#define LIBSFP_FIELD_BANK_A2  1
+
+/* Field types (define decoder and value member) */
+#define LIBSFP_FIELD_TYPE_U8     0   /**< Unsigned byte (value.u) */
+#define LIBSFP_FIELD_TYPE_U16    1   /**< Unsigned big endian word (value.u) */
+#define LIBSFP_FIELD_TYPE_STR    2   /**< ASCII string (value.s) */
+#define LIBSFP_FIELD_TYPE_BYTES  3   /**< Raw bytes (value.b) */
+#define LIBSFP_FIELD_TYPE_TEMP   4   /**< Calibrated temperature (value.f) */
+#define LIBSFP_FIELD_TYPE_VCC    5   /**< Calibrated voltage (value.f) */
+#define LIBSFP_FIELD_TYPE_BIAS   6   /**< Calibrated bias current (value.f) */
+#define LIBSFP_FIELD_TYPE_TXPWR  7   /**< Calibrated TX power (value.f) */
+#define LIBSFP_FIELD_TYPE_RXPWR  8   /**< Calibrated RX power (value.f) */
+
+/* Field units */
+#define LIBSFP_FIELD_UNIT_NONE     0
+#define LIBSFP_FIELD_UNIT_M        1   /**< Meters */
+#define LIBSFP_FIELD_UNIT_NM       2   /**< Nanometers */
+#define LIBSFP_FIELD_UNIT_MBPS     3   /**< MBit/s */
+#define LIBSFP_FIELD_UNIT_PERCENT  4   /**< Percents */
+#define LIBSFP_FIELD_UNIT_C        5   /**< Degrees Celsius */
+#define LIBSFP_FIELD_UNIT_V        6   /**< Volts */
+#define LIBSFP_FIELD_UNIT_MA       7   /**< Milliamperes */
+#define LIBSFP_FIELD_UNIT_MW       8   /**< Milliwatts */
+
+/**
+ * Field list: X(name, id, bank, offset, length, member, type, unit, scale)\n
+ * member - field of libsfp_A0_t/libsfp_A2_t (checked at compile time)\n
+ * scale  - multiplier of integer value
+ */
+#define LIBSFP_FIELDS(X) \
+  X(IDENTIFIER,          1, A0, LIBSFP_OFS_A0_IDENTIFIER, LIBSFP_LEN_A0_IDENTIFIER, base.identifier, U8, NONE, 1) \
+  X(EXTIDENTIFIER,       2, A0, LIBSFP_OFS_A0_EXTIDENTIFIER, LIBSFP_LEN_A0_EXTIDENTIFIER, base.ext_identifier, U8, NONE, 1) \
+  X(CONNECTOR,           3, A0, LIBSFP_OFS_A0_CONNECTOR, LIBSFP_LEN_A0_CONNECTOR, base.connector, U8, NONE, 1) \
+  X(TRANSCEIVER,         4, A0, LIBSFP_OFS_A0_TRANSCEIVER, LIBSFP_LEN_A0_TRANSCEIVER, base.transceiver, BYTES, NONE, 1) \
+  X(ENCODING,            5, A0, LIBSFP_OFS_A0_ENCODING, LIBSFP_LEN_A0_ENCODING, base.encoding, U8, NONE, 1) \
+  X(BR_NOMINAL,          6, A0, LIBSFP_OFS_A0_BR_NOMINAL, LIBSFP_LEN_A0_BR_NOMINAL, base.br_nominal, U8, MBPS, 100) \
+  X(RATE_IDENTIFIER,     7, A0, LIBSFP_OFS_A0_RATE_IDENTIFIER, LIBSFP_LEN_A0_RATE_IDENTIFIER, base.rate_identifier, U8, NONE, 1) \
+  X(LENGTH_SMF_KM,       8, A0, LIBSFP_OFS_A0_LENGTH_SMF_KM, LIBSFP_LEN_A0_LENGTH_SMF_KM, base.length_smf_km, U8, M, 1000) \
+  X(LENGTH_SMF,          9, A0, LIBSFP_OFS_A0_LENGTH_SMF, LIBSFP_LEN_A0_LENGTH_SMF, base.length_smf, U8, M, 100) \
+  X(LENGTH_50UM,        10, A0, LIBSFP_OFS_A0_LENGTH_50UM, LIBSFP_LEN_A0_LENGTH_50UM, base.length_50um, U8, M, 10) \
+  X(LENGTH_625UM,       11, A0, LIBSFP_OFS_A0_LENGTH_625UM, LIBSFP_LEN_A0_LENGTH_625UM, base.length_625um, U8, M, 10) \
+  X(LENGTH_CABLE,       12, A0, LIBSFP_OFS_A0_LENGTH_CABLE, LIBSFP_LEN_A0_LENGTH_CABLE, base.length_cable, U8, M, 1) \
+  X(LENGTH_OM3,         13, A0, LIBSFP_OFS_A0_LENGTH_OM3, LIBSFP_LEN_A0_LENGTH_OM3, base.length_om3, U8, M, 10) \
+  X(VENDOR_NAME,        14, A0, LIBSFP_OFS_A0_VENDOR_NAME, LIBSFP_LEN_A0_VENDOR_NAME, base.vendor_name, STR, NONE, 1) \
+  X(TRANSCEIVER2,       15, A0, LIBSFP_OFS_A0_TRANSCEIVER2, LIBSFP_LEN_A0_TRANSCEIVER2, base.transceiver2, U8, NONE, 1) \
+  X(VENDOR_OUI,         16, A0, LIBSFP_OFS_A0_VENDOR_OUI, LIBSFP_LEN_A0_VENDOR_OUI, base.vendor_oui, BYTES, NONE, 1) \
+  X(VENDOR_PN,          17, A0, LIBSFP_OFS_A0_VENDOR_PN, LIBSFP_LEN_A0_VENDOR_PN, base.vendor_pn, STR, NONE, 1) \
+  X(VENDOR_REV,         18, A0, LIBSFP_OFS_A0_VENDOR_REV, LIBSFP_LEN_A0_VENDOR_REV, base.vendor_rev, STR, NONE, 1) \
+  X(WAVELENGTH,         19, A0, LIBSFP_OFS_A0_WAVELENGTH, LIBSFP_LEN_A0_WAVELENGTH, base.wavelength, U16, NM, 1) \
+  X(CC_BASE,            20, A0, LIBSFP_OFS_A0_CC_BASE, LIBSFP_LEN_A0_CC_BASE, base.cc_base, U8, NONE, 1) \
+  X(OPTIONS,            21, A0, LIBSFP_OFS_A0_OPTIONS, LIBSFP_LEN_A0_OPTIONS, ext.options, U16, NONE, 1) \
+  X(BR_MAX,             22, A0, LIBSFP_OFS_A0_BR_MAX, LIBSFP_LEN_A0_BR_MAX, ext.br_max, U8, PERCENT, 1) \
+  X(BR_MIN,             23, A0, LIBSFP_OFS_A0_BR_MIN, LIBSFP_LEN_A0_BR_MIN, ext.br_min, U8, PERCENT, 1) \
+  X(VENDOR_SN,          24, A0, LIBSFP_OFS_A0_VENDOR_SN, LIBSFP_LEN_A0_VENDOR_SN, ext.vendor_sn, STR, NONE, 1) \
+  X(DATE_CODE,          25, A0, LIBSFP_OFS_A0_DATE_CODE, LIBSFP_LEN_A0_DATE_CODE, ext.date_code, STR, NONE, 1) \
+  X(DIAGMON_TYPE,       26, A0, LIBSFP_OFS_A0_DIAGMON_TYPE, LIBSFP_LEN_A0_DIAGMON_TYPE, ext.diag_mon_type, U8, NONE, 1) \
+  X(ENHANCED_OPTIONS,   27, A0, LIBSFP_OFS_A0_ENHANCED_OPTIONS, LIBSFP_LEN_A0_ENHANCED_OPTIONS, ext.en_options, U8, NONE, 1) \
+  X(SFF_8472_COMPLIANCE, 28, A0, LIBSFP_OFS_A0_SFF_8472_COMPLIANCE, LIBSFP_LEN_A0_SFF_8472_COMPLIANCE, ext.sff8472_comp, U8, NONE, 1) \
+  X(CC_EXT,             29, A0, LIBSFP_OFS_A0_CC_EXT, LIBSFP_LEN_A0_CC_EXT, ext.cc_ext, U8, NONE, 1) \
+  X(TEMP_ALARM_HIGH,   100, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 0, 2, th.temp_alarm_high, TEMP, C, 1) \
+  X(TEMP_ALARM_LOW,    101, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 2, 2, th.temp_alarm_low, TEMP, C, 1) \
+  X(TEMP_WARN_HIGH,    102, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 4, 2, th.temp_warn_high, TEMP, C, 1) \
+  X(TEMP_WARN_LOW,     103, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 6, 2, th.temp_warn_low, TEMP, C, 1) \
+  X(VCC_ALARM_HIGH,    104, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 8, 2, th.voltage_alarm_high, VCC, V, 1) \
+  X(VCC_ALARM_LOW,     105, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 10, 2, th.voltage_alarm_low, VCC, V, 1) \
+  X(VCC_WARN_HIGH,     106, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 12, 2, th.voltage_warn_high, VCC, V, 1) \
+  X(VCC_WARN_LOW,      107, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 14, 2, th.voltage_warn_low, VCC, V, 1) \
+  X(BIAS_ALARM_HIGH,   108, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 16, 2, th.bias_alarm_high, BIAS, MA, 1) \
+  X(BIAS_ALARM_LOW,    109, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 18, 2, th.bias_alarm_low, BIAS, MA, 1) \
+  X(BIAS_WARN_HIGH,    110, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 20, 2, th.bias_warn_high, BIAS, MA, 1) \
+  X(BIAS_WARN_LOW,     111, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 22, 2, th.bias_warn_low, BIAS, MA, 1) \
+  X(TXPWR_ALARM_HIGH,  112, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 24, 2, th.txpower_alarm_high, TXPWR, MW, 1) \
+  X(TXPWR_ALARM_LOW,   113, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 26, 2, th.txpower_alarm_low, TXPWR, MW, 1) \
+  X(TXPWR_WARN_HIGH,   114, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 28, 2, th.txpower_warn_high, TXPWR, MW, 1) \
+  X(TXPWR_WARN_LOW,    115, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 30, 2, th.txpower_warn_low, TXPWR, MW, 1) \
+  X(RXPWR_ALARM_HIGH,  116, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 32, 2, th.rxpower_alarm_high, RXPWR, MW, 1) \
+  X(RXPWR_ALARM_LOW,   117, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 34, 2, th.rxpower_alarm_low, RXPWR, MW, 1) \
+  X(RXPWR_WARN_HIGH,   118, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 36, 2, th.rxpower_warn_high, RXPWR, MW, 1) \
+  X(RXPWR_WARN_LOW,    119, A2, LIBSFP_OFS_A2_AW_THRESHOLDS + 38, 2, th.rxpower_warn_low, RXPWR, MW, 1) \
+  X(CC_DMI,            120, A2, LIBSFP_OFS_A2_CC_DMI, LIBSFP_LEN_A2_CC_DMI, cc_dmi, U8, NONE, 1) \
+  X(TEMPERATURE,       121, A2, LIBSFP_OFS_A2_DIAGNOSTICS + 0, 2, dg.temperature, TEMP, C, 1) \
+  X(VCC,               122, A2, LIBSFP_OFS_A2_DIAGNOSTICS + 2, 2, dg.voltage, VCC, V, 1) \
+  X(BIAS,              123, A2, LIBSFP_OFS_A2_DIAGNOSTICS + 4, 2, dg.bias_current, BIAS, MA, 1) \
+  X(TXPOWER,           124, A2, LIBSFP_OFS_A2_DIAGNOSTICS_TXPOWER, LIBSFP_LEN_A2_DIAGNOSTICS_TXPOWER, dg.tx_power, TXPWR, MW, 1) \
+  X(RXPOWER,           125, A2, LIBSFP_OFS_A2_DIAGNOSTICS_RXPOWER, LIBSFP_LEN_A2_DIAGNOSTICS_RXPOWER, dg.rx_power, RXPWR, MW, 1) \
+  X(STATUSCONTROL,     126, A2, LIBSFP_OFS_A2_STATUSCONTROL, LIBSFP_LEN_A2_STATUSCONTROL, dg.status, U8, NONE, 1) \
+  X(ALARM_FLAGS,       127, A2, LIBSFP_OFS_A2_ALARM_FLAGS, LIBSFP_LEN_A2_ALARM_FLAGS, dg.alarms, U16, NONE, 1) \
+  X(WARNING_FLAGS,     128, A2, LIBSFP_OFS_A2_WARNING_FLAGS, LIBSFP_LEN_A2_WARNING_FLAGS, dg.warnings, U16, NONE, 1) \
+  X(EXT_STATUS_CONTROL, 129, A2, LIBSFP_OFS_A2_EXT_STATUS_CONTROL, 1, dg.estatus, U8, NONE, 1)
+
+/** Field IDs */
+enum {
+#define LIBSFP_FIELD_ENUM(name, id, ...) LIBSFP_FIELD_##name = id,
+  LIBSFP_FIELDS(LIBSFP_FIELD_ENUM)
+#undef LIBSFP_FIELD_ENUM
+  LIBSFP_FIELD_MAX
+};
+
+/** Dense field numbers (in list order) */
+enum {
+#define LIBSFP_FIELD_SLOT(name, id, ...) LIBSFP_FIELD_SLOT_##name,
+  LIBSFP_FIELDS(LIBSFP_FIELD_SLOT)
+#undef LIBSFP_FIELD_SLOT
+  LIBSFP_FIELD_COUNT
+};
+
+/** Field descriptor */
+typedef struct {
+  uint16_t id;             /** Field ID see LIBSFP_FIELD_* */
+  uint8_t bank;            /** Bank see LIBSFP_FIELD_BANK_* */
+  uint8_t ofs;             /** Offset in bank */
+  uint8_t len;             /** Length (bytes) */
+  uint8_t type;            /** Type see LIBSFP_FIELD_TYPE_* */
+  uint8_t unit;            /** Unit see LIBSFP_FIELD_UNIT_* */
+  uint16_t scale;          /** Multiplier of integer value */
+  const char *name;        /** Field name */
+} libsfp_field_desc_t;
+
+/** Field value */
+typedef struct {
+  uint16_t id;             /** Field ID */
+  uint8_t type;            /** Type see LIBSFP_FIELD_TYPE_* */
+  uint8_t unit;            /** Unit see LIBSFP_FIELD_UNIT_* */
+  union {
+    uint32_t u;            /** Integer value (scaled) */
+    float f;               /** Calibrated analog value */
+    char s[17];            /** String value */
+    uint8_t b[16];         /** Raw bytes */
+  } value;                 /** Value see LIBSFP_FIELD_TYPE_* */
+} libsfp_field_value_t;
+
+/** Query execution plan (field reads only, module identification
+ *  and data served from shadow cache are not counted) */
+typedef struct {
+  uint32_t transactions;   /** Number of read transactions */
+  uint32_t bytes;          /** Number of bytes read */
+  uint32_t bus_time;       /** Estimated bus time at 100 kHz (us) */
+} libsfp_query_plan_t;
+
+/**
+ * @brief Get field descriptor
+ * @param id  - field ID see LIBSFP_FIELD_*
+ * @return descriptor or 0 if field is unknown
+ */
+const libsfp_field_desc_t *libsfp_field_desc(uint32_t id);
+
+/**
+ * @brief Get dense field number
+ * @param id  - field ID see LIBSFP_FIELD_*
+ * @return field number or -1 if field is unknown
+ */
+int libsfp_field_slot(uint32_t id);
+
+/**
+ * @brief Read set of fields using minimal number of transactions\n
+ *        (calibrated values also read calibration data they depend on,
+ *        static data is taken from shadow cache if it is enabled)
+ * @param h     - library handle
+ * @param ids   - array of field IDs see LIBSFP_FIELD_*
+ * @param n     - number of fields
+ * @param out   - array of n values to store fields
+ * @param plan  - place to store executed plan or 0 if not needed
+ * @return 0 on success
+ */
+int libsfp_query(libsfp_t *h, const uint16_t *ids, uint32_t n,
+                 libsfp_field_value_t *out, libsfp_query_plan_t *plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,382 @@
+/**
+   @file
+   @brief libsfp memory bounded cache of many ports data
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "libsfp_int.h"
+#include "libsfp_cachefile.h"
+#include "libsfp_fleet.h"
+#include "libsfp_cal.h"
+#include "libsfp_quirks.h"
+
+#define LIBSFP_FLEET_NONE  0xFFFFFFFF   /**< No node index */
+
+/** Slab node: entry with LRU list links */
+typedef struct {
+  libsfp_fleet_entry_t e;
+  libsfp_cal_t cal;             /** Calibration of module */
+  uint32_t prev, next;
+} libsfp_fleet_node_t;
+
+typedef struct {
+  libsfp_fleet_node_t *nodes;   /** Slab of nodes */
+  uint32_t *index;              /** Open addressing port index (node numbers) */
+  uint32_t nnodes;              /** Slab size */
+  uint32_t mask;                /** Index size - 1 */
+  uint32_t used;                /** Number of nodes in use */
+  uint32_t head, tail;          /** LRU list (head - most recently used) */
+} libsfp_fleet_int_t;
+
+#define FL(ptr) ((libsfp_fleet_int_t*)(ptr))
+
+/**
+ * @brief Create fleet cache
+ * @param budget  - memory budget (bytes) for entries and index
+ * @return fleet cache handle or 0 if error occured
+ */
+libsfp_fleet_t *libsfp_fleet_create(size_t budget)
+{
+  libsfp_fleet_int_t *f;
+  size_t isize = 2, n;
+
+  /* Index has at least twice more slots than slab */
+  n = budget / (sizeof(libsfp_fleet_node_t) + 2*sizeof(uint32_t));
+  if (!n)
+    return 0;
+
+  while (isize < 2*n)
+    isize <<= 1;
+
+  /* Use rest of the budget for nodes */
+  if (isize*sizeof(uint32_t) < budget)
+    n = (budget - isize*sizeof(uint32_t)) / sizeof(libsfp_fleet_node_t);
+  if (n > isize/2)
+    n = isize/2;
+
+  f = malloc(sizeof(libsfp_fleet_int_t));
+  if (!f)
+    return 0;
+
+  /* Single slab for nodes and index */
+  f->nodes = malloc(n*sizeof(libsfp_fleet_node_t) + isize*sizeof(uint32_t));
+  if (!f->nodes) {
+    free(f);
+    return 0;
+  }
+
+  f->index = (uint32_t*)(f->nodes + n);
+  memset(f->index, 0xFF, isize*sizeof(uint32_t));
+  f->nnodes = n;
+  f->mask = isize - 1;
+  f->used = 0;
+  f->head = f->tail = LIBSFP_FLEET_NONE;
+
+  return (libsfp_fleet_t*)f;
+}
+
+/**
+ * @brief Free fleet cache and its memory
+ * @param f  - fleet cache handle
+ * @return 0 on success
+ */
+int libsfp_fleet_free(libsfp_fleet_t *f)
+{
+  free(FL(f)->nodes);
+  free(f);
+  return 0;
+}
+
+/**
+ * @brief Get max number of entries that fit in memory budget
+ * @param f  - fleet cache handle
+ * @return number of entries
+ */
+uint32_t libsfp_fleet_capacity(libsfp_fleet_t *f)
+{
+  return FL(f)->nnodes;
+}
+
+static uint32_t libsfp_fleet_hash(libsfp_fleet_int_t *f, uint32_t port)
+{
+  return (port * 2654435761u) & f->mask;
+}
+
+/* Find index slot of port (or free slot where it may be placed) */
+static uint32_t libsfp_fleet_slot(libsfp_fleet_int_t *f, uint32_t port)
+{
+  uint32_t i = libsfp_fleet_hash(f, port);
+
+  while ((f->index[i] != LIBSFP_FLEET_NONE) &&
+         (f->nodes[f->index[i]].e.port != port))
+    i = (i + 1) & f->mask;
+
+  return i;
+}
+
+/* Remove index slot keeping linear probing chains valid */
+static void libsfp_fleet_slot_remove(libsfp_fleet_int_t *f, uint32_t i)
+{
+  uint32_t j = i, k;
+
+  for (;;) {
+    f->index[i] = LIBSFP_FLEET_NONE;
+
+    for (;;) {
+      j = (j + 1) & f->mask;
+      if (f->index[j] == LIBSFP_FLEET_NONE)
+        return;
+      k = libsfp_fleet_hash(f, f->nodes[f->index[j]].e.port);
+      /* Move entry if its home slot is not in (i, j] */
+      if ((i <= j) ? ((k <= i) || (k > j)) : ((k <= i) && (k > j)))
+        break;
+    }
+
+    f->index[i] = f->index[j];
+    i = j;
+  }
+}
+
+static void libsfp_fleet_unlink(libsfp_fleet_int_t *f, uint32_t n)
+{
+  libsfp_fleet_node_t *node = &f->nodes[n];
+
+  if (node->prev != LIBSFP_FLEET_NONE)
+    f->nodes[node->prev].next = node->next;
+  else
+    f->head = node->next;
+
+  if (node->next != LIBSFP_FLEET_NONE)
+    f->nodes[node->next].prev = node->prev;
+  else
+    f->tail = node->prev;
+}
+
+static void libsfp_fleet_link_head(libsfp_fleet_int_t *f, uint32_t n)
+{
+  f->nodes[n].prev = LIBSFP_FLEET_NONE;
+  f->nodes[n].next = f->head;
+
+  if (f->head != LIBSFP_FLEET_NONE)
+    f->nodes[f->head].prev = n;
+  else
+    f->tail = n;
+
+  f->head = n;
+}
+
+/**
+ * @brief Find port entry and mark it as recently used
+ * @param f     - fleet cache handle
+ * @param port  - port number
+ * @return pointer to entry or 0 if port is not cached\n
+ *         pointer is valid until next update of the cache
+ */
+const libsfp_fleet_entry_t *libsfp_fleet_lookup(libsfp_fleet_t *f, uint32_t port)
+{
+  uint32_t n = FL(f)->index[libsfp_fleet_slot(FL(f), port)];
+
+  if (n == LIBSFP_FLEET_NONE)
+    return 0;
+
+  if (FL(f)->head != n) {
+    libsfp_fleet_unlink(FL(f), n);
+    libsfp_fleet_link_head(FL(f), n);
+  }
+
+  return &FL(f)->nodes[n].e;
+}
+
+/**
+ * @brief Remove port entry
+ * @param f     - fleet cache handle
+ * @param port  - port number
+ * @return 0 on success, -1 if port is not cached
+ */
+int libsfp_fleet_remove(libsfp_fleet_t *f, uint32_t port)
+{
+  uint32_t i, n, last;
+
+  i = libsfp_fleet_slot(FL(f), port);
+  n = FL(f)->index[i];
+
+  if (n == LIBSFP_FLEET_NONE)
+    return -1;
+
+  libsfp_fleet_slot_remove(FL(f), i);
+  libsfp_fleet_unlink(FL(f), n);
+
+  /* Keep slab dense: move last node to the freed place */
+  last = --FL(f)->used;
+
+  if (n != last) {
+    i = libsfp_fleet_slot(FL(f), FL(f)->nodes[last].e.port);
+    FL(f)->index[i] = n;
+    FL(f)->nodes[n] = FL(f)->nodes[last];
+
+    if (FL(f)->nodes[n].prev != LIBSFP_FLEET_NONE)
+      FL(f)->nodes[FL(f)->nodes[n].prev].next = n;
+    else
+      FL(f)->head = n;
+
+    if (FL(f)->nodes[n].next != LIBSFP_FLEET_NONE)
+      FL(f)->nodes[FL(f)->nodes[n].next].prev = n;
+    else
+      FL(f)->tail = n;
+  }
+
+  return 0;
+}
+
+/* Get node for port: existing, free or evicted one */
+static libsfp_fleet_entry_t *libsfp_fleet_get(libsfp_fleet_int_t *f, uint32_t port)
+{
+  uint32_t i, n;
+
+  i = libsfp_fleet_slot(f, port);
+  n = f->index[i];
+
+  if (n != LIBSFP_FLEET_NONE) {
+    libsfp_fleet_unlink(f, n);
+    libsfp_fleet_link_head(f, n);
+    return &f->nodes[n].e;
+  }
+
+  if (f->used == f->nnodes) {
+    libsfp_fleet_remove((libsfp_fleet_t*)f, f->nodes[f->tail].e.port);
+    i = libsfp_fleet_slot(f, port);
+  }
+
+  n = f->used++;
+  f->index[i] = n;
+  libsfp_fleet_link_head(f, n);
+  f->nodes[n].e.port = port;
+
+  return &f->nodes[n].e;
+}
+
+static void libsfp_fleet_str(char *dst, const uint8_t *src, size_t len)
+{
+  memcpy(dst, src, len);
+  dst[len] = 0;
+}
+
+/* Read identity of port module (A0 bank and calibration) */
+static int libsfp_fleet_identity(libsfp_t *h, libsfp_A0_t *a0,
+                                 uint8_t *dmtype, libsfp_cal_t *c)
+{
+  libsfp_calibration_fields_t cl, *cal = 0;
+
+  /* Module is identified again if it is read directly */
+  if (H(h)->flags & LIBSFP_FLAGS_CACHE) {
+    if (READSTATIC_A0(h, 0, sizeof(*a0), a0))
+      return -1;
+  } else if (libsfp_read_a0(h, a0))
+    return -1;
+
+  (*dmtype) = libsfp_quirk_dmtype(a0);
+
+  if ((*dmtype & LIBSFP_A0_DIAGMON_TYPE_DDM) &&
+      (*dmtype & LIBSFP_A0_DIAGMON_TYPE_EXCAL)) {
+    if (READSTATIC_A2(h, LIBSFP_OFS_A2_EXT_CAL_CONSTANTS, sizeof(cl), &cl))
+      return -1;
+    cal = &cl;
+  }
+
+  return libsfp_cal_init(c, cal);
+}
+
+/**
+ * @brief Read port module data using library handle and store it
+ *        (least recently used entry is evicted if cache is full)\n
+ *        Identity of cached port is read again only if module
+ *        fingerprint changed, otherwise only diagnostics are read
+ * @param f        - fleet cache handle
+ * @param port     - port number
+ * @param h        - library handle of port
+ * @param max_age  - max acceptable age of diagnostics (ms)
+ * @return 0 on success
+ */
+int libsfp_fleet_update(libsfp_fleet_t *f, uint32_t port,
+                        libsfp_t *h, uint32_t max_age)
+{
+  libsfp_fleet_node_t *node;
+  libsfp_fleet_entry_t *e;
+  libsfp_A0_t a0;
+  libsfp_rtdiagnostics_fields_t *dg = &H(h)->cache.dump.a2.dg, none;
+  libsfp_cal_t c;
+  uint64_t ts = 0;
+  uint32_t n;
+  uint8_t dmtype;
+  int known = 0;
+
+  n = FL(f)->index[libsfp_fleet_slot(FL(f), port)];
+
+  /* Shadow cache checks freshness itself, direct access probes
+   * fingerprint window only (with read plan of identified module) */
+  if ((n != LIBSFP_FLEET_NONE) && !(H(h)->flags & LIBSFP_FLAGS_CACHE) &&
+      (H(h)->identified)) {
+    if (libsfp_cache_probe_read(h, &a0))
+      return -1;
+    known = (libsfp_fingerprint(&a0) == FL(f)->nodes[n].e.fingerprint);
+  }
+
+  if (known) {
+    dmtype = FL(f)->nodes[n].e.diag_mon_type;
+    c = FL(f)->nodes[n].cal;
+  } else if (libsfp_fleet_identity(h, &a0, &dmtype, &c))
+    return -1;
+
+  if (dmtype & LIBSFP_A0_DIAGMON_TYPE_DDM) {
+
+    if (libsfp_cache_read_dynamic(h, LIBSFP_CACHE_VALUES, max_age) ||
+        libsfp_cache_read_dynamic(h, LIBSFP_CACHE_STATUS, max_age))
+      return -1;
+
+    ts = (H(h)->cache.values_time < H(h)->cache.status_time) ?
+          H(h)->cache.values_time : H(h)->cache.status_time;
+
+  } else {
+    memset(&none, 0, sizeof(none));
+    dg = &none;
+  }
+
+  e = libsfp_fleet_get(FL(f), port);
+  node = (libsfp_fleet_node_t*)e;
+
+  e->timestamp = ts;
+
+  memcpy(e->raw, &dg->temperature, sizeof(e->raw));
+  e->status = dg->status;
+  memcpy(e->alarms, dg->alarms, sizeof(e->alarms));
+  memcpy(e->warnings, dg->warnings, sizeof(e->warnings));
+
+  e->temperature = libsfp_cal_temp(&c, libsfp_cal_raw(dg->temperature));
+  e->voltage = libsfp_cal_voltage(&c, libsfp_cal_raw(dg->voltage));
+  e->bias_current = libsfp_cal_bias(&c, libsfp_cal_raw(dg->bias_current));
+  e->txpower = libsfp_cal_txpower(&c, libsfp_cal_raw(dg->tx_power));
+  e->rxpower = libsfp_cal_rxpower(&c, libsfp_cal_raw(dg->rx_power));
+
+  if (known)
+    return 0;
+
+  node->cal = c;
+  e->fingerprint = libsfp_fingerprint(&a0);
+
+  e->identifier = a0.base.identifier;
+  e->connector = a0.base.connector;
+  e->wavelength = (a0.base.wavelength.d[0] << 8) | a0.base.wavelength.d[1];
+  e->bitrate = a0.base.br_nominal*100;
+  e->spmode = libsfp_bitrate2speed_mode(a0.base.br_nominal);
+  if (e->spmode == LIBSFP_SPEED_MODE_UNKNOWN)
+    e->spmode = libsfp_transceiver2speed_mode(a0.base.transceiver);
+  e->diag_mon_type = dmtype;
+  e->en_options = a0.ext.en_options;
+
+  libsfp_fleet_str(e->vendor, a0.base.vendor_name, LIBSFP_LEN_A0_VENDOR_NAME);
+  libsfp_fleet_str(e->partnum, a0.base.vendor_pn, LIBSFP_LEN_A0_VENDOR_PN);
+  libsfp_fleet_str(e->serial, a0.ext.vendor_sn, LIBSFP_LEN_A0_VENDOR_SN);
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+#ifndef LIBSFP_FLEET_H__
+#define LIBSFP_FLEET_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (memory bounded cache of many ports data)
+
+   Fleet cache keeps compact entries (decoded identity and diagnostics
+   plus raw diagnostics block) for many ports. All entries live in
+   single slab allocated at creation time, its size is defined by
+   memory budget. When slab is full least recently used entry is
+   evicted.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libsfp.h>
+
+/** Compact fleet cache entry */
+typedef struct {
+  uint32_t port;                /** Port number */
+  uint32_t fingerprint;         /** Module fingerprint (see libsfp_fingerprint) */
+  uint64_t timestamp;           /** Diagnostics capture time (ms, monotonic clock) */
+  float temperature;            /** Temperature (C) */
+  float voltage;                /** Supply voltage (V) */
+  float bias_current;           /** TX bias current (mA) */
+  float txpower;                /** TX power (mW) */
+  float rxpower;                /** RX power (mW) */
+  uint32_t bitrate;             /** Nominal bitrate (MBit/s) */
+  uint32_t spmode;              /** Speed mode see LIBSFP_SPEED_MODE_* */
+  uint16_t wavelength;          /** Laser wavelength (nm) */
+  uint8_t identifier;           /** Module identifier */
+  uint8_t connector;            /** Connector type see LIBSFP_A0_CONNECTOR_* */
+  uint8_t diag_mon_type;        /** see LIBSFP_A0_DIAGMON_TYPE_*
+                                    (with module quirks applied) */
+  uint8_t en_options;           /** see LIBSFP_A0_ENHANCED_OPTIONS_* */
+  uint8_t status;               /** see LIBSFP_A2_STATUSCONTROL_* */
+  uint8_t alarms[2];            /** Alarm flags (A2 bytes 112-113) */
+  uint8_t warnings[2];          /** Warning flags (A2 bytes 116-117) */
+  libsfp_u16_field_t raw[5];    /** Raw diagnostics block (A2 bytes 96-105) */
+  char vendor[17];              /** Vendor name */
+  char partnum[17];             /** Part number */
+  char serial[17];              /** Serial number */
+} libsfp_fleet_entry_t;
+
+/** Fleet cache handle\n
+ *  Use only pointer to this type
+*/
+typedef struct {
+} libsfp_fleet_t;
+
+/**
+ * @brief Create fleet cache
+ * @param budget  - memory budget (bytes) for entries and index
+ * @return fleet cache handle or 0 if error occured
+ */
+libsfp_fleet_t *libsfp_fleet_create(size_t budget);
+
+/**
+ * @brief Free fleet cache and its memory
+ * @param f  - fleet cache handle
+ * @return 0 on success
+ */
+int libsfp_fleet_free(libsfp_fleet_t *f);
+
+/**
+ * @brief Get max number of entries that fit in memory budget
+ * @param f  - fleet cache handle
+ * @return number of entries
+ */
+uint32_t libsfp_fleet_capacity(libsfp_fleet_t *f);
+
+/**
+ * @brief Find port entry and mark it as recently used
+ * @param f     - fleet cache handle
+ * @param port  - port number
+ * @return pointer to entry or 0 if port is not cached\n
+ *         pointer is valid until next update of the cache
+ */
+const libsfp_fleet_entry_t *libsfp_fleet_lookup(libsfp_fleet_t *f, uint32_t port);
+
+/**
+ * @brief Read port module data using library handle and store it
+ *        (least recently used entry is evicted if cache is full)\n
+ *        Identity of cached port is read again only if module
+ *        fingerprint changed, otherwise only diagnostics are read
+ * @param f        - fleet cache handle
+ * @param port     - port number
+ * @param h        - library handle of port
+ * @param max_age  - max acceptable age of diagnostics (ms)
+ * @return 0 on success
+ */
+int libsfp_fleet_update(libsfp_fleet_t *f, uint32_t port,
+                        libsfp_t *h, uint32_t max_age);
+
+/**
+ * @brief Remove port entry
+ * @param f     - fleet cache handle
+ * @param port  - port number
+ * @return 0 on success, -1 if port is not cached
+ */
+int libsfp_fleet_remove(libsfp_fleet_t *f, uint32_t port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
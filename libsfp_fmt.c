@@ -0,0 +1,264 @@
+/**
+   @file
+   @brief libsfp locale-free number and hex formatting
+
+   Output is the same as of printf "%u", "%X", "%.Nf" and "%02X"
+   conversions, text is not zero terminated, functions return end
+   of written text.
+*/
+
+#include <string.h>
+#include "libsfp_int.h"
+
+static const char dec_pairs[200] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static const char hex_pairs[512] =
+  "000102030405060708090A0B0C0D0E0F"
+  "101112131415161718191A1B1C1D1E1F"
+  "202122232425262728292A2B2C2D2E2F"
+  "303132333435363738393A3B3C3D3E3F"
+  "404142434445464748494A4B4C4D4E4F"
+  "505152535455565758595A5B5C5D5E5F"
+  "606162636465666768696A6B6C6D6E6F"
+  "707172737475767778797A7B7C7D7E7F"
+  "808182838485868788898A8B8C8D8E8F"
+  "909192939495969798999A9B9C9D9E9F"
+  "A0A1A2A3A4A5A6A7A8A9AAABACADAEAF"
+  "B0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+  "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECF"
+  "D0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+  "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEF"
+  "F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+static const char hex_upper[16] = "0123456789ABCDEF";
+static const char hex_lower[16] = "0123456789abcdef";
+
+static const uint32_t pow10_tbl[LIBSFP_FMT_PREC_MAX + 1] = {1, 10, 100, 1000, 10000};
+
+/* Write at least min digits of v, right aligned at end */
+static char *libsfp_fmt_digits(char *end, uint64_t v, uint8_t min)
+{
+  char *p = end;
+
+  while (v >= 100) {
+    p -= 2;
+    memcpy(p, &dec_pairs[(v % 100)*2], 2);
+    v /= 100;
+  }
+
+  if (v >= 10) {
+    p -= 2;
+    memcpy(p, &dec_pairs[v*2], 2);
+  } else
+    *--p = '0' + v;
+
+  while (end - p < min)
+    *--p = '0';
+
+  return p;
+}
+
+/**
+ * @brief Format unsigned integer ("%u")
+ * @param s  - buffer (20 bytes)
+ * @param v  - value
+ * @return end of text
+ */
+char *libsfp_fmt_uint(char *s, uint64_t v)
+{
+  char buf[20], *p;
+
+  p = libsfp_fmt_digits(buf + sizeof(buf), v, 1);
+  memcpy(s, p, buf + sizeof(buf) - p);
+
+  return s + (buf + sizeof(buf) - p);
+}
+
+/**
+ * @brief Format unsigned integer in hex with fixed number of digits ("%0NX")
+ * @param s       - buffer (digits bytes)
+ * @param v       - value
+ * @param digits  - number of digits (1-8)
+ * @param lower   - use lower case letters
+ * @return end of text
+ */
+char *libsfp_fmt_hex(char *s, uint32_t v, uint8_t digits, int lower)
+{
+  const char *hd = (lower) ? hex_lower : hex_upper;
+  uint8_t i;
+
+  for (i = digits; i; --i, v >>= 4)
+    s[i - 1] = hd[v & 0x0F];
+
+  return s + digits;
+}
+
+/* Big integer m*2^e in base 10^9 limbs (e > 0), returns number of limbs */
+static int libsfp_fmt_bigint(uint32_t *limb, uint32_t m, int e)
+{
+  uint64_t x;
+  int n = 1, i, sh;
+
+  limb[0] = m % 1000000000;
+  if (m >= 1000000000)
+    limb[n++] = m / 1000000000;
+
+  for (; e > 0; e -= sh) {
+    sh = (e > 30) ? 30 : e;
+    x = 0;
+    for (i = 0; i < n; ++i) {
+      x += (uint64_t)limb[i] << sh;
+      limb[i] = x % 1000000000;
+      x /= 1000000000;
+    }
+    if (x)
+      limb[n++] = x;
+  }
+
+  return n;
+}
+
+/**
+ * @brief Format float with fixed precision ("%.Nf")\n
+ *        (exact value is rounded half to even as glibc printf does)
+ * @param s     - buffer (LIBSFP_FMT_FLOAT_MAX bytes)
+ * @param v     - value
+ * @param prec  - digits after decimal point (0-LIBSFP_FMT_PREC_MAX)
+ * @return end of text
+ */
+char *libsfp_fmt_fixed(char *s, float v, uint8_t prec)
+{
+  uint32_t bits, m, limb[5];
+  uint64_t ip, frac, t, q, rem, half, n;
+  int e, k, i;
+  char buf[LIBSFP_FMT_FLOAT_MAX], *p, *end = buf + sizeof(buf);
+
+  memcpy(&bits, &v, sizeof(bits));
+
+  if (bits >> 31)
+    *s++ = '-';
+
+  e = (bits >> 23) & 0xFF;
+  m = bits & 0x7FFFFF;
+
+  if (e == 0xFF) {
+    memcpy(s, (m) ? "nan" : "inf", 3);
+    return s + 3;
+  }
+
+  /* v = m * 2^e */
+  if (e) {
+    m |= 0x800000;
+    e -= 150;
+  } else
+    e = -149;
+
+  if (e >= 0) {
+    /* Integer value, up to 2^40 fits 64 bits */
+    p = end;
+    if (e > 40) {
+      k = libsfp_fmt_bigint(limb, m, e);
+      for (i = 0; i < k - 1; ++i)
+        p = libsfp_fmt_digits(p, limb[i], 9);
+      p = libsfp_fmt_digits(p, limb[k - 1], 1);
+    } else
+      p = libsfp_fmt_digits(p, (uint64_t)m << e, 1);
+
+    memcpy(s, p, end - p);
+    s += end - p;
+    if (prec) {
+      *s++ = '.';
+      memset(s, '0', prec);
+      s += prec;
+    }
+    return s;
+  }
+
+  k = -e;
+  ip = (k < 32) ? (m >> k) : 0;
+  frac = (k < 32) ? (m & ((1u << k) - 1)) : m;
+
+  if (k <= 50) {
+    /* frac < 2^24, scaled by 10^prec still fits 64 bits */
+    t = frac * pow10_tbl[prec];
+    q = t >> k;
+    rem = t & ((1ull << k) - 1);
+    half = 1ull << (k - 1);
+  } else {
+    /* Fraction is far below rounding half */
+    q = 0;
+    rem = (frac) ? 1 : 0;
+    half = 2;
+  }
+
+  n = ip*pow10_tbl[prec] + q;
+  if ((rem > half) || ((rem == half) && (n & 1)))
+    ++n;
+
+  p = libsfp_fmt_digits(end, n, prec + 1);
+  if (prec) {
+    memcpy(s, p, end - p - prec);
+    s += end - p - prec;
+    *s++ = '.';
+    memcpy(s, end - prec, prec);
+    return s + prec;
+  }
+
+  memcpy(s, p, end - p);
+  return s + (end - p);
+}
+
+/**
+ * @brief Format data region as hex bytes ("%02X" for every byte)
+ * @param s     - buffer (2 or 3 bytes per data byte)
+ * @param data  - data
+ * @param n     - data size
+ * @param sep   - separator after every byte or 0
+ * @return end of text
+ */
+char *libsfp_fmt_hexdump(char *s, const void *data, size_t n, char sep)
+{
+  const uint8_t *d = data;
+  size_t i;
+
+  if (sep) {
+    for (i = 0; i < n; ++i, s += 3) {
+      memcpy(s, &hex_pairs[d[i]*2], 2);
+      s[2] = sep;
+    }
+  } else
+    for (i = 0; i < n; ++i, s += 2)
+      memcpy(s, &hex_pairs[d[i]*2], 2);
+
+  return s;
+}
+
+/**
+ * @brief Copy ASCII field skipping zero bytes
+ * @param s     - buffer (n bytes)
+ * @param data  - field data
+ * @param n     - field size
+ * @return end of text
+ */
+char *libsfp_fmt_ascii(char *s, const void *data, size_t n)
+{
+  const uint8_t *d = data;
+  size_t i;
+
+  for (i = 0; i < n; ++i) {
+    *s = d[i];
+    s += (d[i] != 0);
+  }
+
+  return s;
+}
@@ -8,34 +8,105 @@
 */
 
 #include "libsfp.h"
+#include "libsfp_quirks.h"
+#include "libsfp_fields.h"
+#include "libsfp_sink.h"
+#include <string.h>
 
+#define LIBSFP_QUIRK_SAFE_READ  8    /**< Read size used until quirks are known */
+
+#define LIBSFP_FMT_PREC_MAX   4    /**< Max precision of libsfp_fmt_fixed */
+#define LIBSFP_FMT_FLOAT_MAX  48   /**< Buffer size enough for any float
+                                        formatted by libsfp_fmt_fixed */
+#define LIBSFP_SBUF_SIZE      96   /**< Internal string buffer size (formatted
+                                        value with units or 16 bytes hex row) */
+
+#define LIBSFP_CACHE_A0_VALID  0x01   /**< Shadow copy of A0 bank is valid */
+#define LIBSFP_CACHE_A2_VALID  0x02   /**< Shadow copy of A2 static part
+                                           (thresholds, calibrations) is valid */
+#define LIBSFP_CACHE_VALUES    0x04   /**< Diagnostic values copy is valid */
+#define LIBSFP_CACHE_STATUS    0x08   /**< Status and alarm/warning flags
+                                           copy is valid */
+#define LIBSFP_CACHE_NO_DDM   0x10   /**< Module has no DDM implemented */
+#define LIBSFP_CACHE_A2_FAIL  0x20   /**< A2 bank read failed (retried after
+                                           holdoff) */
+#define LIBSFP_CACHE_ADDRCH   0x40   /**< A2 bank requires address change */
+
+/** Facts meaning that A2 bank access can't succeed */
+#define LIBSFP_CACHE_NO_A2   (LIBSFP_CACHE_NO_DDM | LIBSFP_CACHE_A2_FAIL | \
+                              LIBSFP_CACHE_ADDRCH)
+
+/* A2 bank retry holdoff after failed read (doubles on every failure) */
+#define LIBSFP_CACHE_A2_HOLDOFF_MIN  1000    /**< First holdoff (ms) */
+#define LIBSFP_CACHE_A2_HOLDOFF_MAX  60000   /**< Max holdoff (ms) */
+
+/* Dynamic A2 sections kept in shadow copy */
+#define LIBSFP_OFS_CACHE_VALUES  LIBSFP_OFS_A2_DIAGNOSTICS
+#define LIBSFP_LEN_CACHE_VALUES  LIBSFP_LEN_A2_DIAGNOSTICS
+#define LIBSFP_OFS_CACHE_STATUS  LIBSFP_OFS_A2_STATUSCONTROL
+#define LIBSFP_LEN_CACHE_STATUS  (LIBSFP_OFS_A2_EXT_STATUS_CONTROL - \
+                                  LIBSFP_OFS_A2_STATUSCONTROL + 1)
+
+/** Shadow copy of static SFP module data */
+typedef struct {
+  libsfp_dump_t dump;            /** Shadow copy of module memory */
+  uint32_t state;                /** Shadow copy state see LIBSFP_CACHE_* */
+  uint64_t probe_time;           /** Time of last freshness check (ms) */
+  uint64_t values_time;          /** Capture time of diagnostic values (ms) */
+  uint64_t status_time;          /** Capture time of status and flags (ms) */
+  uint64_t a2_retry_time;        /** Time of next A2 read attempt (ms) */
+  uint32_t a2_holdoff;           /** Current A2 retry holdoff (ms) */
+} libsfp_cache_t;
+
+/** Output sink */
 typedef struct {
-  libsfp_A0_t a0;
-  libsfp_A2_t a2;
-} __attribute__((packed)) libsfp_dump_t;
+  char *buf;                     /** Buffer */
+  size_t size;                   /** Buffer size */
+  size_t len;                    /** Length of collected text */
+  libsfp_sink_flush_cb_t flush;  /** Flush callback or 0 */
+  void *udata;                   /** User data pointer of flush callback */
+  uint8_t growable;              /** Buffer is allocated by library */
+  uint8_t error;                 /** Some text was lost */
+} libsfp_sink_int_t;
+
+#define SK(ptr) ((libsfp_sink_int_t*)(ptr))
 
 typedef struct {
-  char sbuf[16];                 /** Internal string buffer */
+  char sbuf[LIBSFP_SBUF_SIZE];    /** Internal string buffer */
   uint32_t flags;                /** Library flags  */
   void *udata;                   /** User data pointer */
   uint8_t a0addr, a2addr;        /** SFP Bank addresses to use */
   libsfp_readregs_cb_t readregs;   /** Callback to read information */
   libsfp_writeregs_cb_t writeregs;  /** Callback to write information */
   libsfp_print_callbacks_t print_cb;  /** Callbacks to print parameter */
+  libsfp_sink_t *sink;           /** Output sink or 0 (use print_cb) */
+  uint32_t probe_interval;       /** Shadow cache probe interval (ms) */
+  libsfp_cache_t cache;          /** Shadow cache of static module data */
+  libsfp_quirk_t quirk;          /** Copy of quirk of current module */
+  uint8_t has_quirk;             /** Current module has quirk */
+  uint8_t identified;            /** Quirk of current module is known */
+  uint8_t dmtype;                /** Diag monitoring type of current module
+                                     (with quirks applied) */
+  uint16_t max_read;             /** Max bytes per read transaction (0 - no limit) */
 } libsfp_int_t;
 
 #define H(ptr) ((libsfp_int_t*)(ptr))
 
 #define READREG(h, bank_addr, reg_offset, count, dest) \
-    ((H(h)->readregs) ? \
-       H(h)->readregs(H(h)->udata, bank_addr, \
-                      reg_offset, count, dest) : -1)
+    libsfp_readregs(h, bank_addr, reg_offset, count, dest)
 
 #define READREG_A0(h, reg_offset, count, dest) \
     READREG(h, H(h)->a0addr, reg_offset, count, dest)
 #define READREG_A2(h, reg_offset, count, dest) \
     READREG(h, H(h)->a2addr, reg_offset, count, dest)
 
+/* Read static (A0 or A2 thresholds/calibrations) data,
+ * served from shadow cache if LIBSFP_FLAGS_CACHE is set */
+#define READSTATIC_A0(h, reg_offset, count, dest) \
+    libsfp_cache_read(h, H(h)->a0addr, reg_offset, count, dest)
+#define READSTATIC_A2(h, reg_offset, count, dest) \
+    libsfp_cache_read(h, H(h)->a2addr, reg_offset, count, dest)
+
 #define WRITEREG(h, bank_addr, reg_offset, count, dest) \
     ((H(h)->writeregs) ? \
        H(h)->writeregs(H(h)->udata, bank_addr, \
@@ -47,17 +118,92 @@ typedef struct {
     WRITEREG(h, H(h)->a2addr, reg_offset, count, dest)
 
 
-int libsfp_is_laser_availble(libsfp_base_fields_t *bf);
+/**
+ * @brief Make place for n bytes at buffer end
+ *        (grow or flush buffer)
+ * @param s  - sink handle
+ * @param n  - number of bytes
+ * @return 0 on success, -1 if there is no place (sink error is set)
+ */
+int libsfp_sink_reserve(libsfp_sink_t *s, size_t n);
+
+/**
+ * @brief Format unsigned integer ("%u")
+ * @param s  - buffer (20 bytes)
+ * @param v  - value
+ * @return end of text
+ */
+char *libsfp_fmt_uint(char *s, uint64_t v);
+
+/**
+ * @brief Format unsigned integer in hex with fixed number of digits ("%0NX")
+ * @param s       - buffer (digits bytes)
+ * @param v       - value
+ * @param digits  - number of digits (1-8)
+ * @param lower   - use lower case letters
+ * @return end of text
+ */
+char *libsfp_fmt_hex(char *s, uint32_t v, uint8_t digits, int lower);
+
+/**
+ * @brief Format float with fixed precision ("%.Nf")\n
+ *        (exact value is rounded half to even as glibc printf does)
+ * @param s     - buffer (LIBSFP_FMT_FLOAT_MAX bytes)
+ * @param v     - value
+ * @param prec  - digits after decimal point (0-LIBSFP_FMT_PREC_MAX)
+ * @return end of text
+ */
+char *libsfp_fmt_fixed(char *s, float v, uint8_t prec);
+
+/**
+ * @brief Format data region as hex bytes ("%02X" for every byte)
+ * @param s     - buffer (2 or 3 bytes per data byte)
+ * @param data  - data
+ * @param n     - data size
+ * @param sep   - separator after every byte or 0
+ * @return end of text
+ */
+char *libsfp_fmt_hexdump(char *s, const void *data, size_t n, char sep);
+
+/**
+ * @brief Copy ASCII field skipping zero bytes
+ * @param s     - buffer (n bytes)
+ * @param data  - field data
+ * @param n     - field size
+ * @return end of text
+ */
+char *libsfp_fmt_ascii(char *s, const void *data, size_t n);
+
+/* Copy string without terminating zero, returns end of text */
+static inline char *libsfp_fmt_str(char *s, const char *str)
+{
+  size_t len = strlen(str);
+
+  memcpy(s, str, len);
+  return s + len;
+}
+
+/* Get place for n bytes at buffer end, 0 if there is no place
+   (caller adds written length to sink len) */
+static inline char *libsfp_sink_space(libsfp_sink_t *s, size_t n)
+{
+  if ((SK(s)->size - SK(s)->len < n) && libsfp_sink_reserve(s, n))
+    return 0;
+  return SK(s)->buf + SK(s)->len;
+}
+
+
+int libsfp_is_laser_availble(const libsfp_base_fields_t *bf);
 float libsfp_get_slope(libsfp_u16_field_t f);
 float libsfp_get_offset(libsfp_u16_field_t f);
 float libsfp_get_rxpwr(libsfp_u32_field_t f);
 
-float libsfp_get_temp(libsfp_u16_field_t tf, libsfp_calibration_fields_t *cal);
-float libsfp_get_voltage(libsfp_u16_field_t v, libsfp_calibration_fields_t *cal);
-float libsfp_get_biascurrent(libsfp_u16_field_t v, libsfp_calibration_fields_t *cal);
-float libsfp_get_rxpower(libsfp_u16_field_t v, libsfp_u32_field_t *rx_pwr);
+float libsfp_get_temp(libsfp_u16_field_t tf, const libsfp_calibration_fields_t *cal);
+float libsfp_get_voltage(libsfp_u16_field_t v, const libsfp_calibration_fields_t *cal);
+float libsfp_get_biascurrent(libsfp_u16_field_t v, const libsfp_calibration_fields_t *cal);
+float libsfp_get_rxpower(libsfp_u16_field_t v, const libsfp_u32_field_t *rx_pwr);
 float libsfp_get_txpower(libsfp_u16_field_t v,
-                         libsfp_u16_field_t *slope, libsfp_u16_field_t *ofs);
+                         const libsfp_u16_field_t *slope, const libsfp_u16_field_t *ofs);
 
 
 /**
@@ -66,7 +212,103 @@ float libsfp_get_txpower(libsfp_u16_field_t v,
  * @param size  data size
  * @return Checksum
  */
-uint8_t libsfp_calc_csum(void *d, uint16_t size);
+uint8_t libsfp_calc_csum(const void *d, uint16_t size);
+
+/**
+ * @brief Read module registers using read callback
+ *        (split to transactions not longer than handle max_read)
+ * @param h      library handle
+ * @param addr   bank address
+ * @param start  offset in bytes to start reading from
+ * @param count  count of bytes to read
+ * @param data   pointer to buffer to store data
+ * @return 0 on success
+ */
+int libsfp_readregs(libsfp_t *h, uint8_t addr,
+                    uint16_t start, uint16_t count, void *data);
+
+/**
+ * @brief Read A0 bank applying module quirks
+ * @param h   library handle
+ * @param a0  struct to store data
+ * @return 0 on success
+ */
+int libsfp_read_a0(libsfp_t *h, libsfp_A0_t *a0);
+
+int libsfp_field_is_calibrated(const libsfp_field_desc_t *fd);
+void libsfp_field_decode(const libsfp_field_desc_t *fd, const uint8_t *raw,
+                         const libsfp_calibration_fields_t *cal,
+                         libsfp_field_value_t *v);
+
+int libsfp_quirks_identify(libsfp_t *h, libsfp_A0_t *a0);
+uint8_t libsfp_quirks_dmtype(const libsfp_quirk_t *q, uint8_t v);
+int libsfp_quirks_apply(libsfp_t *h, const libsfp_A0_t *a0);
+int libsfp_get_dmtype(libsfp_t *h, uint8_t *dmtype);
+
+uint32_t libsfp_bitrate2speed_mode(uint8_t br);
+uint32_t libsfp_transceiver2speed_mode(const uint8_t *tr);
+
+int libsfp_is_csums_correct(libsfp_t *h, libsfp_A0_t *a0, libsfp_A2_t *a2);
+
+/**
+ * @brief Get monotonic time
+ * @return time in milliseconds
+ */
+uint64_t libsfp_time_ms(void);
+
+/**
+ * @brief Make shadow cache valid (load it or check its freshness)
+ * @param h  library handle
+ * @return 0 on success
+ */
+int libsfp_cache_update(libsfp_t *h);
+
+/**
+ * @brief Read identifier and probe window (cc_base ... cc_ext) of module\n
+ *        (all bytes libsfp_fingerprint depends on)
+ * @param h   library handle
+ * @param a0  A0 bank struct to store data
+ * @return 0 on success
+ */
+int libsfp_cache_probe_read(libsfp_t *h, libsfp_A0_t *a0);
+
+/**
+ * @brief Check shadow cache freshness with probe window already
+ *        read from module and reload cache if needed
+ * @param h   library handle
+ * @param a0  identifier and probe window (cc_base ... cc_ext) of module
+ * @return 0 if cache is fresh, 1 if it was reloaded, -1 on error
+ */
+int libsfp_cache_probe_a0(libsfp_t *h, const libsfp_A0_t *a0);
+
+/**
+ * @brief Read static module data, from shadow cache if enabled
+ * @param h      library handle
+ * @param addr   bank address
+ * @param start  offset in bytes to start reading from
+ * @param count  count of bytes to read
+ * @param data   pointer to buffer to store data
+ * @return 0 on success
+ */
+int libsfp_cache_read(libsfp_t *h, uint8_t addr,
+                      uint16_t start, uint16_t count, void *data);
+
+/**
+ * @brief Check that A2 bank access may succeed\n
+ *        (uses facts remembered in shadow cache if it is enabled)
+ * @param h  library handle
+ * @return 0 if A2 bank may be accessed, -1 otherwise
+ */
+int libsfp_cache_a2_check(libsfp_t *h);
+
+/**
+ * @brief Refresh dynamic A2 section in shadow copy if it is too old
+ * @param h        library handle
+ * @param section  LIBSFP_CACHE_VALUES or LIBSFP_CACHE_STATUS
+ * @param max_age  max acceptable age of data (ms)
+ * @return 0 on success
+ */
+int libsfp_cache_read_dynamic(libsfp_t *h, uint32_t section, uint32_t max_age);
 
 
 
@@ -0,0 +1,332 @@
+/**
+   @file
+   @brief libsfp streaming JSON renderer
+*/
+
+#include <string.h>
+#include "libsfp_int.h"
+#include "libsfp_decode.h"
+#include "libsfp_json.h"
+
+/* Append string literal */
+#define JLIT(p, lit) \
+  do { memcpy(p, lit, sizeof(lit) - 1); p += sizeof(lit) - 1; } while (0)
+
+/* Escape of string bytes: 0 - as is, 'u' - \u00XX, other - \<char> */
+static const char libsfp_json_esc[256] = {
+  [0x00 ... 0x07] = 'u',
+  ['\b'] = 'b', ['\t'] = 't', ['\n'] = 'n', [0x0B] = 'u', ['\f'] = 'f', ['\r'] = 'r',
+  [0x0E ... 0x1F] = 'u',
+  ['"'] = '"', ['\\'] = '\\',
+  [0x7F ... 0xFF] = 'u'
+};
+
+/* Channel object keys and digits after decimal point (finer than LSB) */
+static const struct {
+  char key[16];
+  uint8_t len;
+  uint8_t prec;
+} libsfp_json_ch[LIBSFP_DECODED_CHANNELS] = {
+  {"\"temperature\":{", 15, 4},
+  {"\"vcc\":{", 7, 4},
+  {"\"bias\":{", 8, 3},
+  {"\"tx_power\":{", 12, 4},
+  {"\"rx_power\":{", 12, 4}
+};
+
+static char *libsfp_json_bool(char *p, int v)
+{
+  if (v)
+    JLIT(p, "true");
+  else
+    JLIT(p, "false");
+  return p;
+}
+
+/* Float, inf and nan go as null */
+static char *libsfp_json_float(char *p, float v, uint8_t prec)
+{
+  uint32_t bits;
+
+  memcpy(&bits, &v, sizeof(bits));
+  if (((bits >> 23) & 0xFF) == 0xFF) {
+    JLIT(p, "null");
+    return p;
+  }
+
+  return libsfp_fmt_fixed(p, v, prec);
+}
+
+/* Array of bytes as numbers */
+static char *libsfp_json_bytes(char *p, const uint8_t *b, size_t n)
+{
+  size_t i;
+
+  *p++ = '[';
+  for (i = 0; i < n; ++i) {
+    p = libsfp_fmt_uint(p, b[i]);
+    *p++ = ',';
+  }
+  p[-1] = ']';
+
+  return p;
+}
+
+/* Quoted string without trailing spaces */
+static char *libsfp_json_str(char *p, const char *str)
+{
+  const uint8_t *c = (const uint8_t*)str;
+  size_t n = strlen(str), i;
+  char e;
+
+  while (n && (c[n - 1] == ' '))
+    --n;
+
+  *p++ = '"';
+  for (i = 0; i < n; ++i) {
+    e = libsfp_json_esc[c[i]];
+    if (!e)
+      *p++ = c[i];
+    else if (e != 'u') {
+      *p++ = '\\';
+      *p++ = e;
+    } else {
+      JLIT(p, "\\u00");
+      p = libsfp_fmt_hex(p, c[i], 2, 1);
+    }
+  }
+  *p++ = '"';
+
+  return p;
+}
+
+static char *libsfp_json_channel(char *p, const libsfp_decoded_t *d, uint8_t ch)
+{
+  uint8_t prec = libsfp_json_ch[ch].prec;
+
+  memcpy(p, libsfp_json_ch[ch].key, libsfp_json_ch[ch].len);
+  p += libsfp_json_ch[ch].len;
+
+  JLIT(p, "\"value\":");
+  p = libsfp_json_float(p, d->values[ch], prec);
+  JLIT(p, ",\"alarm_high\":");
+  p = libsfp_json_float(p, d->th[ch].alarm_high, prec);
+  JLIT(p, ",\"alarm_low\":");
+  p = libsfp_json_float(p, d->th[ch].alarm_low, prec);
+  JLIT(p, ",\"warn_high\":");
+  p = libsfp_json_float(p, d->th[ch].warn_high, prec);
+  JLIT(p, ",\"warn_low\":");
+  p = libsfp_json_float(p, d->th[ch].warn_low, prec);
+  JLIT(p, ",\"aw\":");
+  if (d->flags & LIBSFP_DECODED_AWFLAGS)
+    p = libsfp_fmt_uint(p, d->aw[ch]);
+  else
+    JLIT(p, "null");
+  *p++ = '}';
+
+  return p;
+}
+
+static char *libsfp_json_ddm(char *p, const libsfp_decoded_t *d)
+{
+  uint8_t ch;
+
+  if (!(d->flags & LIBSFP_DECODED_DDM)) {
+    JLIT(p, "null");
+    return p;
+  }
+
+  JLIT(p, "{\"excal\":");
+  p = libsfp_json_bool(p, d->flags & LIBSFP_DECODED_EXCAL);
+  JLIT(p, ",\"aw_flags\":");
+  p = libsfp_json_bool(p, d->flags & LIBSFP_DECODED_AWFLAGS);
+  JLIT(p, ",\"checksum\":");
+  p = libsfp_json_bool(p, d->flags & LIBSFP_DECODED_CSUM_DMI);
+  JLIT(p, ",\"status\":");
+  p = libsfp_fmt_uint(p, d->status);
+
+  for (ch = 0; ch < LIBSFP_DECODED_CHANNELS; ++ch) {
+    *p++ = ',';
+    p = libsfp_json_channel(p, d, ch);
+  }
+  *p++ = '}';
+
+  return p;
+}
+
+/* Render object to p, dump is used only for "raw" key */
+static char *libsfp_json_object(char *p, const libsfp_decoded_t *d,
+                                const libsfp_dump_t *dump,
+                                uint32_t port, uint32_t flags)
+{
+  *p++ = '{';
+
+  if (port != LIBSFP_JSON_NO_PORT) {
+    JLIT(p, "\"port\":");
+    p = libsfp_fmt_uint(p, port);
+    *p++ = ',';
+  }
+
+  JLIT(p, "\"identifier\":");
+  p = libsfp_fmt_uint(p, d->identifier);
+  JLIT(p, ",\"ext_identifier\":");
+  p = libsfp_fmt_uint(p, d->ext_identifier);
+  JLIT(p, ",\"connector\":");
+  p = libsfp_fmt_uint(p, d->connector);
+  JLIT(p, ",\"transceiver\":");
+  p = libsfp_json_bytes(p, d->transceiver, sizeof(d->transceiver));
+  JLIT(p, ",\"encoding\":");
+  p = libsfp_fmt_uint(p, d->encoding);
+  JLIT(p, ",\"bitrate\":");
+  p = libsfp_fmt_uint(p, d->bitrate);
+  JLIT(p, ",\"speed_mode\":");
+  p = libsfp_fmt_uint(p, d->spmode);
+  JLIT(p, ",\"rate_identifier\":");
+  p = libsfp_fmt_uint(p, d->rate_identifier);
+  JLIT(p, ",\"br_max\":");
+  p = libsfp_fmt_uint(p, d->br_max);
+  JLIT(p, ",\"br_min\":");
+  p = libsfp_fmt_uint(p, d->br_min);
+
+  JLIT(p, ",\"length_smf\":");
+  p = libsfp_fmt_uint(p, d->length_smf);
+  JLIT(p, ",\"length_50um\":");
+  p = libsfp_fmt_uint(p, d->length_50um);
+  JLIT(p, ",\"length_625um\":");
+  p = libsfp_fmt_uint(p, d->length_625um);
+  JLIT(p, ",\"length_cable\":");
+  p = libsfp_fmt_uint(p, d->length_cable);
+  JLIT(p, ",\"length_om3\":");
+  p = libsfp_fmt_uint(p, d->length_om3);
+
+  JLIT(p, ",\"laser\":");
+  p = libsfp_json_bool(p, d->flags & LIBSFP_DECODED_LASER);
+  JLIT(p, ",\"wavelength\":");
+  if (d->flags & LIBSFP_DECODED_LASER)
+    p = libsfp_fmt_uint(p, d->wavelength);
+  else
+    JLIT(p, "null");
+
+  JLIT(p, ",\"vendor\":");
+  p = libsfp_json_str(p, d->vendor);
+  JLIT(p, ",\"vendor_oui\":");
+  p = libsfp_json_bytes(p, d->vendor_oui, sizeof(d->vendor_oui));
+  JLIT(p, ",\"part_number\":");
+  p = libsfp_json_str(p, d->partnum);
+  JLIT(p, ",\"revision\":");
+  p = libsfp_json_str(p, d->revision);
+  JLIT(p, ",\"serial\":");
+  p = libsfp_json_str(p, d->serial);
+  JLIT(p, ",\"date_code\":");
+  p = libsfp_json_str(p, d->date_code);
+
+  JLIT(p, ",\"options\":");
+  p = libsfp_fmt_uint(p, d->options);
+  JLIT(p, ",\"diag_mon_type\":");
+  p = libsfp_fmt_uint(p, d->diag_mon_type);
+  JLIT(p, ",\"en_options\":");
+  p = libsfp_fmt_uint(p, d->en_options);
+  JLIT(p, ",\"sff8472_comp\":");
+  p = libsfp_fmt_uint(p, d->sff8472_comp);
+
+  JLIT(p, ",\"checksum\":{\"base\":");
+  p = libsfp_json_bool(p, d->flags & LIBSFP_DECODED_CSUM_BASE);
+  JLIT(p, ",\"ext\":");
+  p = libsfp_json_bool(p, d->flags & LIBSFP_DECODED_CSUM_EXT);
+
+  JLIT(p, "},\"ddm\":");
+  p = libsfp_json_ddm(p, d);
+
+  if (dump && (flags & LIBSFP_JSON_RAW)) {
+    JLIT(p, ",\"raw\":{\"a0\":\"");
+    p = libsfp_fmt_hexdump(p, &dump->a0, sizeof(dump->a0), 0);
+    JLIT(p, "\",\"a2\":");
+    /* A2 bank contents is valid only if DDM is implemented */
+    if (d->flags & LIBSFP_DECODED_DDM) {
+      *p++ = '"';
+      p = libsfp_fmt_hexdump(p, &dump->a2, sizeof(dump->a2), 0);
+      *p++ = '"';
+    } else
+      JLIT(p, "null");
+    *p++ = '}';
+  }
+
+  *p++ = '}';
+
+  if (flags & LIBSFP_JSON_NDJSON)
+    *p++ = '\n';
+
+  return p;
+}
+
+static int libsfp_json_render(libsfp_sink_t *s, const libsfp_decoded_t *d,
+                              const libsfp_dump_t *dump,
+                              uint32_t port, uint32_t flags)
+{
+  char *p, *end;
+
+  /* Object goes straight to sink buffer */
+  p = libsfp_sink_space(s, LIBSFP_JSON_MAX);
+  if (!p)
+    return -1;
+
+  end = libsfp_json_object(p, d, dump, port, flags);
+  SK(s)->len += end - p;
+
+  return 0;
+}
+
+/**
+ * @brief Render decoded module information as JSON object
+ * @param s      - output sink
+ * @param d      - decoded information (see libsfp_decode)
+ * @param port   - port number or LIBSFP_JSON_NO_PORT
+ * @param flags  - render flags see LIBSFP_JSON_* (RAW is ignored)
+ * @return 0 on success
+ */
+int libsfp_json_decoded(libsfp_sink_t *s, const libsfp_decoded_t *d,
+                        uint32_t port, uint32_t flags)
+{
+  return libsfp_json_render(s, d, 0, port, flags);
+}
+
+/**
+ * @brief Decode module memory and render it as JSON object
+ * @param s      - output sink
+ * @param dump   - module memory (see libsfp_readinfo)
+ * @param port   - port number or LIBSFP_JSON_NO_PORT
+ * @param flags  - render flags see LIBSFP_JSON_*
+ * @return 0 on success
+ */
+int libsfp_json_dump(libsfp_sink_t *s, const libsfp_dump_t *dump,
+                     uint32_t port, uint32_t flags)
+{
+  libsfp_decoded_t d;
+
+  libsfp_decode(dump, &d);
+
+  return libsfp_json_render(s, &d, dump, port, flags);
+}
+
+/**
+ * @brief Read module information and render it as JSON object\n
+ *        (sink is flushed after object)
+ * @param h      - library handle
+ * @param s      - output sink
+ * @param port   - port number or LIBSFP_JSON_NO_PORT
+ * @param flags  - render flags see LIBSFP_JSON_*
+ * @return 0 on success
+ */
+int libsfp_json_showinfo(libsfp_t *h, libsfp_sink_t *s,
+                         uint32_t port, uint32_t flags)
+{
+  libsfp_dump_t dump;
+
+  if (libsfp_readinfo(h, &dump))
+    return -1;
+
+  if (libsfp_json_dump(s, &dump, port, flags))
+    return -1;
+
+  return libsfp_sink_flush(s);
+}
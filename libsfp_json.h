@@ -0,0 +1,92 @@
+#ifndef LIBSFP_JSON_H__
+#define LIBSFP_JSON_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (JSON renderer of module information)
+
+   Renderer writes one JSON object per module straight into output
+   sink without building intermediate tree. Keys are stable and
+   always present (null if value is not available), values are plain
+   numbers, booleans and strings:
+
+   {"port":N, "identifier":N, "ext_identifier":N, "connector":N,
+    "transceiver":[8 x N], "encoding":N, "bitrate":N (MBit/s),
+    "speed_mode":N (LIBSFP_SPEED_MODE_*), "rate_identifier":N,
+    "br_max":N (%), "br_min":N (%), "length_smf":N, "length_50um":N,
+    "length_625um":N, "length_cable":N, "length_om3":N (m),
+    "laser":B, "wavelength":N (nm), "vendor":S, "vendor_oui":[3 x N],
+    "part_number":S, "revision":S, "serial":S, "date_code":S,
+    "options":N, "diag_mon_type":N, "en_options":N, "sff8472_comp":N,
+    "checksum":{"base":B, "ext":B},
+    "ddm":{"excal":B, "aw_flags":B, "checksum":B, "status":N,
+           "temperature":C (C), "vcc":C (V), "bias":C (mA),
+           "tx_power":C (mW), "rx_power":C (mW)},
+    "raw":{"a0":S, "a2":S}}
+
+   where C is {"value":F, "alarm_high":F, "alarm_low":F,
+   "warn_high":F, "warn_low":F, "aw":N (LIBSFP_DECODED_ALARM_* bits)}.
+
+   "port" is present only if port number is given, "raw" only if
+   LIBSFP_JSON_RAW flag is set. Trailing spaces of strings are cut,
+   bytes out of printable ASCII range are escaped as \\u00XX.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libsfp.h>
+#include <libsfp_decode.h>
+#include <libsfp_sink.h>
+
+/* Render flags */
+#define LIBSFP_JSON_NDJSON   0x01   /**< Terminate object with newline
+                                         (one object per line) */
+#define LIBSFP_JSON_RAW      0x02   /**< Add hex of module memory ("raw") */
+
+#define LIBSFP_JSON_NO_PORT  0xFFFFFFFF   /**< Do not render port number */
+
+#define LIBSFP_JSON_MAX      4096   /**< Max length of one rendered object
+                                         (free sink space required) */
+
+/**
+ * @brief Render decoded module information as JSON object
+ * @param s      - output sink
+ * @param d      - decoded information (see libsfp_decode)
+ * @param port   - port number or LIBSFP_JSON_NO_PORT
+ * @param flags  - render flags see LIBSFP_JSON_* (RAW is ignored)
+ * @return 0 on success
+ */
+int libsfp_json_decoded(libsfp_sink_t *s, const libsfp_decoded_t *d,
+                        uint32_t port, uint32_t flags);
+
+/**
+ * @brief Decode module memory and render it as JSON object
+ * @param s      - output sink
+ * @param dump   - module memory (see libsfp_readinfo)
+ * @param port   - port number or LIBSFP_JSON_NO_PORT
+ * @param flags  - render flags see LIBSFP_JSON_*
+ * @return 0 on success
+ */
+int libsfp_json_dump(libsfp_sink_t *s, const libsfp_dump_t *dump,
+                     uint32_t port, uint32_t flags);
+
+/**
+ * @brief Read module information and render it as JSON object\n
+ *        (sink is flushed after object)
+ * @param h      - library handle
+ * @param s      - output sink
+ * @param port   - port number or LIBSFP_JSON_NO_PORT
+ * @param flags  - render flags see LIBSFP_JSON_*
+ * @return 0 on success
+ */
+int libsfp_json_showinfo(libsfp_t *h, libsfp_sink_t *s,
+                         uint32_t port, uint32_t flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
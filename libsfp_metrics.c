@@ -0,0 +1,507 @@
+/**
+   @file
+   @brief libsfp OpenMetrics exposition of many ports
+*/
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "libsfp_int.h"
+#include "libsfp_decode.h"
+#include "libsfp_metrics.h"
+
+#define LIBSFP_METRICS_TEXT   6144   /**< Max length of cached text of port */
+#define LIBSFP_METRICS_LINE   160    /**< Max length of sample line */
+
+#define LIBSFP_METRICS_VALID  0x01   /**< Port has module snapshot */
+
+/* Segments of cached port text */
+#define LIBSFP_METRICS_SEG_INFO   0    /**< Info line */
+#define LIBSFP_METRICS_SEG_TH     1    /**< Threshold samples (per channel) */
+#define LIBSFP_METRICS_SEG_VALUE  6    /**< Value sample prefix (per channel) */
+#define LIBSFP_METRICS_SEG_AW     11   /**< Alarm and warning samples */
+#define LIBSFP_METRICS_SEGS       13
+
+/** Text with length */
+typedef struct {
+  const char *s;
+  uint16_t len;
+} libsfp_metrics_str_t;
+
+#define MSTR(lit) {lit, sizeof(lit) - 1}
+#define MHDR(name, unit, help) \
+  MSTR("# TYPE " name " gauge\n# UNIT " name " " unit "\n# HELP " name " " help "\n")
+
+typedef struct {
+  libsfp_decoded_t d;               /** Last snapshot */
+  uint32_t state;                   /** see LIBSFP_METRICS_VALID */
+  uint16_t ofs[LIBSFP_METRICS_SEGS + 1];  /** Segment k is ofs[k]..ofs[k+1] */
+  uint16_t digit[2][2*LIBSFP_DECODED_CHANNELS];  /** Flag digits in
+                                                     alarm/warning segments */
+  uint8_t label_len;                /** Port label length */
+  char label[23];                   /** Port label (port="N") */
+  char *text;                       /** Cached text (see LIBSFP_METRICS_SEG_*) */
+} libsfp_metrics_port_t;
+
+typedef struct {
+  libsfp_metrics_port_t *ports;
+  uint32_t nports;
+} libsfp_metrics_int_t;
+
+#define MT(ptr) ((libsfp_metrics_int_t*)(ptr))
+
+static const libsfp_metrics_str_t libsfp_metrics_info_hdr =
+  MSTR("# TYPE sfp_module info\n# HELP sfp_module Module identity\n");
+
+static const libsfp_metrics_str_t libsfp_metrics_eof = MSTR("# EOF\n");
+
+/* Channel families and digits after decimal point (finer than LSB) */
+static const struct {
+  libsfp_metrics_str_t hdr, name;
+  libsfp_metrics_str_t th_hdr, th_name;
+  uint8_t prec;
+} libsfp_metrics_ch[LIBSFP_DECODED_CHANNELS] = {
+  {MHDR("sfp_temperature_celsius", "celsius", "Module temperature"),
+   MSTR("sfp_temperature_celsius{"),
+   MHDR("sfp_temperature_threshold_celsius", "celsius", "Module temperature thresholds"),
+   MSTR("sfp_temperature_threshold_celsius{"), 4},
+  {MHDR("sfp_vcc_volts", "volts", "Supply voltage"),
+   MSTR("sfp_vcc_volts{"),
+   MHDR("sfp_vcc_threshold_volts", "volts", "Supply voltage thresholds"),
+   MSTR("sfp_vcc_threshold_volts{"), 4},
+  {MHDR("sfp_bias_milliamperes", "milliamperes", "TX bias current"),
+   MSTR("sfp_bias_milliamperes{"),
+   MHDR("sfp_bias_threshold_milliamperes", "milliamperes", "TX bias current thresholds"),
+   MSTR("sfp_bias_threshold_milliamperes{"), 3},
+  {MHDR("sfp_tx_power_milliwatts", "milliwatts", "TX power"),
+   MSTR("sfp_tx_power_milliwatts{"),
+   MHDR("sfp_tx_power_threshold_milliwatts", "milliwatts", "TX power thresholds"),
+   MSTR("sfp_tx_power_threshold_milliwatts{"), 4},
+  {MHDR("sfp_rx_power_milliwatts", "milliwatts", "RX power"),
+   MSTR("sfp_rx_power_milliwatts{"),
+   MHDR("sfp_rx_power_threshold_milliwatts", "milliwatts", "RX power thresholds"),
+   MSTR("sfp_rx_power_threshold_milliwatts{"), 4}
+};
+
+static const libsfp_metrics_str_t libsfp_metrics_th[4] = {
+  MSTR(",threshold=\"alarm_high\"} "),
+  MSTR(",threshold=\"alarm_low\"} "),
+  MSTR(",threshold=\"warn_high\"} "),
+  MSTR(",threshold=\"warn_low\"} ")
+};
+
+/* Flag families, bits of high and low flags see LIBSFP_DECODED_ALARM_* */
+static const struct {
+  libsfp_metrics_str_t hdr, name;
+  uint8_t high, low;
+} libsfp_metrics_aw[2] = {
+  {MSTR("# TYPE sfp_alarm gauge\n# HELP sfp_alarm Alarm flags\n"), MSTR("sfp_alarm{"),
+   LIBSFP_DECODED_ALARM_HIGH, LIBSFP_DECODED_ALARM_LOW},
+  {MSTR("# TYPE sfp_warning gauge\n# HELP sfp_warning Warning flags\n"), MSTR("sfp_warning{"),
+   LIBSFP_DECODED_WARN_HIGH, LIBSFP_DECODED_WARN_LOW}
+};
+
+#define MDIR(ch) \
+  {MSTR(",channel=\"" ch "\",direction=\"high\"} "), \
+   MSTR(",channel=\"" ch "\",direction=\"low\"} ")}
+
+static const libsfp_metrics_str_t libsfp_metrics_dir[LIBSFP_DECODED_CHANNELS][2] = {
+  MDIR("temperature"), MDIR("vcc"), MDIR("bias"), MDIR("tx_power"), MDIR("rx_power")
+};
+
+static char *libsfp_metrics_put(char *p, const libsfp_metrics_str_t *str)
+{
+  memcpy(p, str->s, str->len);
+  return p + str->len;
+}
+
+/* Float, inf and nan as OpenMetrics expects them */
+static char *libsfp_metrics_float(char *p, float v, uint8_t prec)
+{
+  uint32_t bits;
+
+  memcpy(&bits, &v, sizeof(bits));
+  if (((bits >> 23) & 0xFF) != 0xFF)
+    return libsfp_fmt_fixed(p, v, prec);
+
+  if (bits & 0x7FFFFF)
+    memcpy(p, "NaN", 3);
+  else
+    memcpy(p, (bits >> 31) ? "-Inf" : "+Inf", 4);
+
+  return p + 3 + !(bits & 0x7FFFFF);
+}
+
+/* Label value without trailing spaces */
+static char *libsfp_metrics_label(char *p, const char *str)
+{
+  const uint8_t *c = (const uint8_t*)str;
+  size_t n = strlen(str), i;
+
+  while (n && (c[n - 1] == ' '))
+    --n;
+
+  *p++ = '"';
+  for (i = 0; i < n; ++i) {
+    if ((c[i] == '"') || (c[i] == '\\')) {
+      *p++ = '\\';
+      *p++ = c[i];
+    } else if (c[i] == '\n') {
+      *p++ = '\\';
+      *p++ = 'n';
+    } else if ((c[i] < 0x20) || (c[i] == 0x7F))
+      *p++ = '?';
+    else if (c[i] >= 0x80) {
+      *p++ = 0xC0 | (c[i] >> 6);
+      *p++ = 0x80 | (c[i] & 0x3F);
+    } else
+      *p++ = c[i];
+  }
+  *p++ = '"';
+
+  return p;
+}
+
+/* Sample: name{port="N"<suffix><value> */
+static char *libsfp_metrics_sample(char *p, const libsfp_metrics_str_t *name,
+                                   const libsfp_metrics_port_t *mp,
+                                   const libsfp_metrics_str_t *suffix)
+{
+  p = libsfp_metrics_put(p, name);
+  memcpy(p, mp->label, mp->label_len);
+  p += mp->label_len;
+  return libsfp_metrics_put(p, suffix);
+}
+
+/* Render cached text of port, only values and flag digits
+   change between module updates */
+static int libsfp_metrics_text(libsfp_metrics_port_t *mp)
+{
+  static const libsfp_metrics_str_t info = MSTR("sfp_module_info{");
+  static const libsfp_metrics_str_t close = MSTR("} ");
+  const libsfp_decoded_t *d = &mp->d;
+  const float *th;
+  char buf[LIBSFP_METRICS_TEXT], *p = buf, *seg, *text;
+  uint8_t ch, i, w;
+
+  mp->ofs[LIBSFP_METRICS_SEG_INFO] = 0;
+
+  p = libsfp_metrics_put(p, &info);
+  memcpy(p, mp->label, mp->label_len);
+  p += mp->label_len;
+  memcpy(p, ",vendor=", 8);
+  p = libsfp_metrics_label(p + 8, d->vendor);
+  memcpy(p, ",part_number=", 13);
+  p = libsfp_metrics_label(p + 13, d->partnum);
+  memcpy(p, ",revision=", 10);
+  p = libsfp_metrics_label(p + 10, d->revision);
+  memcpy(p, ",serial=", 8);
+  p = libsfp_metrics_label(p + 8, d->serial);
+  memcpy(p, "} 1\n", 4);
+  p += 4;
+
+  for (ch = 0; ch < LIBSFP_DECODED_CHANNELS; ++ch) {
+    mp->ofs[LIBSFP_METRICS_SEG_TH + ch] = p - buf;
+    /* Thresholds go as alarm high/low, warning high/low */
+    th = &d->th[ch].alarm_high;
+    for (i = 0; (d->flags & LIBSFP_DECODED_DDM) && (i < 4); ++i) {
+      p = libsfp_metrics_sample(p, &libsfp_metrics_ch[ch].th_name, mp,
+                                &libsfp_metrics_th[i]);
+      p = libsfp_metrics_float(p, th[i], libsfp_metrics_ch[ch].prec);
+      *p++ = '\n';
+    }
+  }
+
+  for (ch = 0; ch < LIBSFP_DECODED_CHANNELS; ++ch) {
+    mp->ofs[LIBSFP_METRICS_SEG_VALUE + ch] = p - buf;
+    p = libsfp_metrics_sample(p, &libsfp_metrics_ch[ch].name, mp, &close);
+  }
+
+  /* Flag samples with digit placeholders */
+  for (w = 0; w < 2; ++w) {
+    mp->ofs[LIBSFP_METRICS_SEG_AW + w] = p - buf;
+    seg = p;
+    for (i = 0; (d->flags & LIBSFP_DECODED_AWFLAGS) &&
+                (i < 2*LIBSFP_DECODED_CHANNELS); ++i) {
+      p = libsfp_metrics_sample(p, &libsfp_metrics_aw[w].name, mp,
+                                &libsfp_metrics_dir[i/2][i%2]);
+      mp->digit[w][i] = p - seg;
+      *p++ = '0';
+      *p++ = '\n';
+    }
+  }
+
+  mp->ofs[LIBSFP_METRICS_SEGS] = p - buf;
+
+  text = realloc(mp->text, p - buf);
+  if (!text)
+    return -1;
+
+  memcpy(text, buf, p - buf);
+  mp->text = text;
+
+  return 0;
+}
+
+/**
+ * @brief Create metrics set
+ * @param nports  - number of ports (port numbers are 0..nports-1)
+ * @return metrics set handle or 0 if error occured
+ */
+libsfp_metrics_t *libsfp_metrics_create(uint32_t nports)
+{
+  libsfp_metrics_int_t *m;
+  libsfp_metrics_port_t *mp;
+  uint32_t i;
+  char *p;
+
+  if (!nports)
+    return 0;
+
+  m = malloc(sizeof(libsfp_metrics_int_t));
+  if (!m)
+    return 0;
+
+  if (posix_memalign((void**)&m->ports, 64, nports*sizeof(libsfp_metrics_port_t))) {
+    free(m);
+    return 0;
+  }
+
+  m->nports = nports;
+
+  /* Port labels never change */
+  for (i = 0; i < nports; ++i) {
+    mp = &m->ports[i];
+    mp->state = 0;
+    mp->text = 0;
+    memcpy(mp->label, "port=\"", 6);
+    p = libsfp_fmt_uint(mp->label + 6, i);
+    *p++ = '"';
+    mp->label_len = p - mp->label;
+  }
+
+  return (libsfp_metrics_t*)m;
+}
+
+/**
+ * @brief Free metrics set and its memory
+ * @param m  - metrics set handle
+ * @return 0 on success
+ */
+int libsfp_metrics_free(libsfp_metrics_t *m)
+{
+  uint32_t i;
+
+  for (i = 0; i < MT(m)->nports; ++i)
+    free(MT(m)->ports[i].text);
+
+  free(MT(m)->ports);
+  free(m);
+  return 0;
+}
+
+/**
+ * @brief Store decoded snapshot of port module
+ * @param m     - metrics set handle
+ * @param port  - port number
+ * @param d     - decoded information (see libsfp_decode)
+ * @return 0 on success
+ */
+int libsfp_metrics_set(libsfp_metrics_t *m, uint32_t port,
+                       const libsfp_decoded_t *d)
+{
+  libsfp_metrics_port_t *mp;
+  int changed;
+
+  if (port >= MT(m)->nports)
+    return -1;
+
+  mp = &MT(m)->ports[port];
+
+  /* Cached text depends on identity strings and thresholds only */
+  changed = (!(mp->state & LIBSFP_METRICS_VALID)) ||
+            ((mp->d.flags ^ d->flags) & (LIBSFP_DECODED_DDM |
+                                         LIBSFP_DECODED_AWFLAGS)) ||
+            memcmp(mp->d.vendor, d->vendor, offsetof(libsfp_decoded_t, date_code) -
+                                            offsetof(libsfp_decoded_t, vendor)) ||
+            memcmp(mp->d.th, d->th, sizeof(d->th));
+
+  mp->d = *d;
+
+  if (changed && libsfp_metrics_text(mp)) {
+    mp->state = 0;
+    return -1;
+  }
+
+  mp->state |= LIBSFP_METRICS_VALID;
+
+  return 0;
+}
+
+/**
+ * @brief Read port module information using library handle and store it\n
+ *        (with LIBSFP_FLAGS_CACHE only diagnostics are read from module)
+ * @param m     - metrics set handle
+ * @param port  - port number
+ * @param h     - library handle of port
+ * @return 0 on success
+ */
+int libsfp_metrics_update(libsfp_metrics_t *m, uint32_t port, libsfp_t *h)
+{
+  libsfp_dump_t dump;
+  libsfp_decoded_t d;
+
+  if (libsfp_readinfo(h, &dump))
+    return -1;
+
+  libsfp_decode(&dump, &d);
+
+  return libsfp_metrics_set(m, port, &d);
+}
+
+/**
+ * @brief Mark port as empty (port is not rendered)
+ * @param m     - metrics set handle
+ * @param port  - port number
+ * @return 0 on success
+ */
+int libsfp_metrics_clear(libsfp_metrics_t *m, uint32_t port)
+{
+  if (port >= MT(m)->nports)
+    return -1;
+
+  MT(m)->ports[port].state = 0;
+
+  return 0;
+}
+
+/**
+ * @brief Get max length of rendered text\n
+ *        (sink buffer of this size never needs flush)
+ * @param m  - metrics set handle
+ * @return length (bytes)
+ */
+size_t libsfp_metrics_size(libsfp_metrics_t *m)
+{
+  size_t size;
+  uint8_t ch;
+
+  size = libsfp_metrics_info_hdr.len + libsfp_metrics_eof.len +
+         libsfp_metrics_aw[0].hdr.len + libsfp_metrics_aw[1].hdr.len;
+
+  for (ch = 0; ch < LIBSFP_DECODED_CHANNELS; ++ch)
+    size += libsfp_metrics_ch[ch].hdr.len + libsfp_metrics_ch[ch].th_hdr.len;
+
+  /* Cached text and values of every port */
+  return size + MT(m)->nports*(LIBSFP_METRICS_TEXT +
+                               LIBSFP_DECODED_CHANNELS*LIBSFP_FMT_FLOAT_MAX);
+}
+
+/* Write segment of cached text */
+static int libsfp_metrics_seg(libsfp_sink_t *s, const libsfp_metrics_port_t *mp,
+                             uint8_t seg)
+{
+  return libsfp_sink_write(s, mp->text + mp->ofs[seg],
+                           mp->ofs[seg + 1] - mp->ofs[seg]);
+}
+
+/* Alarm or warning flags family: cached samples with patched digits */
+static int libsfp_metrics_render_aw(libsfp_metrics_int_t *m, libsfp_sink_t *s, int w)
+{
+  const libsfp_metrics_port_t *mp = m->ports, *end = m->ports + m->nports;
+  const uint8_t high = libsfp_metrics_aw[w].high, low = libsfp_metrics_aw[w].low;
+  uint16_t len;
+  uint8_t ch;
+  char *p;
+
+  if (libsfp_sink_write(s, libsfp_metrics_aw[w].hdr.s, libsfp_metrics_aw[w].hdr.len))
+    return -1;
+
+  for (; mp < end; ++mp) {
+
+    if (!(mp->state & LIBSFP_METRICS_VALID) ||
+        !(mp->d.flags & LIBSFP_DECODED_AWFLAGS))
+      continue;
+
+    len = mp->ofs[LIBSFP_METRICS_SEG_AW + w + 1] - mp->ofs[LIBSFP_METRICS_SEG_AW + w];
+    p = libsfp_sink_space(s, len);
+    if (!p)
+      return -1;
+
+    memcpy(p, mp->text + mp->ofs[LIBSFP_METRICS_SEG_AW + w], len);
+    for (ch = 0; ch < LIBSFP_DECODED_CHANNELS; ++ch) {
+      p[mp->digit[w][2*ch]] = '0' + !!(mp->d.aw[ch] & high);
+      p[mp->digit[w][2*ch + 1]] = '0' + !!(mp->d.aw[ch] & low);
+    }
+
+    SK(s)->len += len;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Render all ports as OpenMetrics text (ends with "# EOF")
+ * @param m  - metrics set handle
+ * @param s  - output sink
+ * @return 0 on success
+ */
+int libsfp_metrics_render(libsfp_metrics_t *m, libsfp_sink_t *s)
+{
+  const libsfp_metrics_port_t *mp, *end = MT(m)->ports + MT(m)->nports;
+  uint16_t len;
+  char *p;
+  uint8_t ch;
+
+  /* Info lines come from cache */
+  if (libsfp_sink_write(s, libsfp_metrics_info_hdr.s, libsfp_metrics_info_hdr.len))
+    return -1;
+
+  for (mp = MT(m)->ports; mp < end; ++mp)
+    if ((mp->state & LIBSFP_METRICS_VALID) &&
+        libsfp_metrics_seg(s, mp, LIBSFP_METRICS_SEG_INFO))
+      return -1;
+
+  /* Values are formatted on every scrape after cached prefix */
+  for (ch = 0; ch < LIBSFP_DECODED_CHANNELS; ++ch) {
+
+    if (libsfp_sink_write(s, libsfp_metrics_ch[ch].hdr.s, libsfp_metrics_ch[ch].hdr.len))
+      return -1;
+
+    for (mp = MT(m)->ports; mp < end; ++mp) {
+
+      if (!(mp->state & LIBSFP_METRICS_VALID) ||
+          !(mp->d.flags & LIBSFP_DECODED_DDM))
+        continue;
+
+      p = libsfp_sink_space(s, LIBSFP_METRICS_LINE);
+      if (!p)
+        return -1;
+
+      len = mp->ofs[LIBSFP_METRICS_SEG_VALUE + ch + 1] - mp->ofs[LIBSFP_METRICS_SEG_VALUE + ch];
+      memcpy(p, mp->text + mp->ofs[LIBSFP_METRICS_SEG_VALUE + ch], len);
+      p = libsfp_metrics_float(p + len, mp->d.values[ch], libsfp_metrics_ch[ch].prec);
+      *p++ = '\n';
+
+      SK(s)->len = p - SK(s)->buf;
+    }
+  }
+
+  /* Threshold samples come from cache (empty for ports without DDM) */
+  for (ch = 0; ch < LIBSFP_DECODED_CHANNELS; ++ch) {
+
+    if (libsfp_sink_write(s, libsfp_metrics_ch[ch].th_hdr.s, libsfp_metrics_ch[ch].th_hdr.len))
+      return -1;
+
+    for (mp = MT(m)->ports; mp < end; ++mp)
+      if ((mp->state & LIBSFP_METRICS_VALID) &&
+          libsfp_metrics_seg(s, mp, LIBSFP_METRICS_SEG_TH + ch))
+        return -1;
+  }
+
+  if (libsfp_metrics_render_aw(MT(m), s, 0) ||
+      libsfp_metrics_render_aw(MT(m), s, 1))
+    return -1;
+
+  return libsfp_sink_write(s, libsfp_metrics_eof.s, libsfp_metrics_eof.len);
+}
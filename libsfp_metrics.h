@@ -0,0 +1,108 @@
+#ifndef LIBSFP_METRICS_H__
+#define LIBSFP_METRICS_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (OpenMetrics exposition of many ports)
+
+   Metrics set keeps last decoded snapshot of every port and renders
+   all ports as OpenMetrics text. Port label, module info line and
+   threshold samples are rendered once when module (vendor, part
+   number, revision, serial or thresholds) changes and are copied to
+   output on every scrape, only DDM values and alarm/warning flags are
+   formatted per scrape.
+
+   Metric families (port label is port number given to update):
+
+   sfp_module_info{port,vendor,part_number,revision,serial} - info\n
+   sfp_temperature_celsius, sfp_vcc_volts, sfp_bias_milliamperes,
+   sfp_tx_power_milliwatts, sfp_rx_power_milliwatts{port} - gauges\n
+   sfp_<channel>_threshold_<unit>{port,threshold} - gauges
+   (threshold is alarm_high, alarm_low, warn_high or warn_low)\n
+   sfp_alarm, sfp_warning{port,channel,direction} - gauges 0/1
+   (direction is high or low)
+
+   Ports without DDM have info line only, flags are rendered only for
+   modules implementing alarm/warning flags. Non-ASCII bytes of labels
+   are converted to UTF-8 (as Latin-1), control characters to '?'.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <libsfp.h>
+#include <libsfp_decode.h>
+#include <libsfp_sink.h>
+
+/** Metrics set handle\n
+ *  Use only pointer to this type
+*/
+typedef struct {
+} libsfp_metrics_t;
+
+/**
+ * @brief Create metrics set
+ * @param nports  - number of ports (port numbers are 0..nports-1)
+ * @return metrics set handle or 0 if error occured
+ */
+libsfp_metrics_t *libsfp_metrics_create(uint32_t nports);
+
+/**
+ * @brief Free metrics set and its memory
+ * @param m  - metrics set handle
+ * @return 0 on success
+ */
+int libsfp_metrics_free(libsfp_metrics_t *m);
+
+/**
+ * @brief Store decoded snapshot of port module
+ * @param m     - metrics set handle
+ * @param port  - port number
+ * @param d     - decoded information (see libsfp_decode)
+ * @return 0 on success
+ */
+int libsfp_metrics_set(libsfp_metrics_t *m, uint32_t port,
+                       const libsfp_decoded_t *d);
+
+/**
+ * @brief Read port module information using library handle and store it\n
+ *        (with LIBSFP_FLAGS_CACHE only diagnostics are read from module)
+ * @param m     - metrics set handle
+ * @param port  - port number
+ * @param h     - library handle of port
+ * @return 0 on success
+ */
+int libsfp_metrics_update(libsfp_metrics_t *m, uint32_t port, libsfp_t *h);
+
+/**
+ * @brief Mark port as empty (port is not rendered)
+ * @param m     - metrics set handle
+ * @param port  - port number
+ * @return 0 on success
+ */
+int libsfp_metrics_clear(libsfp_metrics_t *m, uint32_t port);
+
+/**
+ * @brief Get max length of rendered text\n
+ *        (sink buffer of this size never needs flush)
+ * @param m  - metrics set handle
+ * @return length (bytes)
+ */
+size_t libsfp_metrics_size(libsfp_metrics_t *m);
+
+/**
+ * @brief Render all ports as OpenMetrics text (ends with "# EOF")
+ * @param m  - metrics set handle
+ * @param s  - output sink
+ * @return 0 on success
+ */
+int libsfp_metrics_render(libsfp_metrics_t *m, libsfp_sink_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -10,7 +10,7 @@
  * @param dump  - pointer to struct that store information
  * @return 0 on success
  */
-void libsfp_printinfo(libsfp_t *h, libsfp_dump_t *dump);
+void libsfp_printinfo(libsfp_t *h, const libsfp_dump_t *dump);
 
 
 /**
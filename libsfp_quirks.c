@@ -0,0 +1,431 @@
+/**
+   @file
+   @brief libsfp vendor quirks database
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include "libsfp_int.h"
+#include "libsfp_quirks.h"
+
+#define ARRAY_SIZE(a) (sizeof(a)/sizeof(a[0]))
+
+#define LIBSFP_QUIRK_KEY_LEN  (LIBSFP_LEN_A0_VENDOR_OUI + LIBSFP_LEN_A0_VENDOR_PN)
+
+/* Built-in quirks */
+static const libsfp_quirk_t libsfp_quirks_builtin[] = {
+  /* GPON sticks returning corrupted data on multi-byte reads */
+  {{0xFF, 0xFF, 0xFF}, "V2801F", 0, 1},
+  {{0xFF, 0xFF, 0xFF}, "CPGOS03-0490", 0, 1},
+};
+
+static libsfp_quirk_t *libsfp_quirks_overlay;      /* User overlay */
+static uint32_t libsfp_quirks_noverlay;
+
+/* Perfect hash: every key has its own slot */
+static const libsfp_quirk_t **libsfp_quirks_slots;
+static uint32_t libsfp_quirks_bits;
+static uint32_t libsfp_quirks_seed;
+static int libsfp_quirks_ready;
+static pthread_once_t libsfp_quirks_once = PTHREAD_ONCE_INIT;
+
+/* Make lookup key: OUI and part number padded with spaces
+   (some modules pad part number with zeroes) */
+static void libsfp_quirk_key(uint8_t *key, const uint8_t *oui, const char *pn, size_t pnlen)
+{
+  size_t i;
+
+  memcpy(key, oui, LIBSFP_LEN_A0_VENDOR_OUI);
+  key += LIBSFP_LEN_A0_VENDOR_OUI;
+
+  for (i = 0; i < LIBSFP_LEN_A0_VENDOR_PN; ++i)
+    key[i] = ((i < pnlen) && pn[i]) ? pn[i] : ' ';
+}
+
+static uint32_t libsfp_quirk_hash(const uint8_t *key, uint32_t seed, uint32_t bits)
+{
+  uint32_t i, hash = 2166136261u ^ seed;
+
+  for (i = 0; i < LIBSFP_QUIRK_KEY_LEN; ++i) {
+    hash ^= key[i];
+    hash *= 16777619u;
+  }
+
+  return (hash * 0x9E3779B1u) >> (32 - bits);
+}
+
+static uint32_t libsfp_quirks_count(void)
+{
+  return ARRAY_SIZE(libsfp_quirks_builtin) + libsfp_quirks_noverlay;
+}
+
+static const libsfp_quirk_t *libsfp_quirks_get(uint32_t i)
+{
+  /* Overlay entries go first to override built-in ones */
+  if (i < libsfp_quirks_noverlay)
+    return &libsfp_quirks_overlay[i];
+  return &libsfp_quirks_builtin[i - libsfp_quirks_noverlay];
+}
+
+/* Try to place all keys without collisions */
+static int libsfp_quirks_place(const libsfp_quirk_t **slots, uint32_t seed, uint32_t bits)
+{
+  uint32_t i, n;
+  uint8_t key[LIBSFP_QUIRK_KEY_LEN], skey[LIBSFP_QUIRK_KEY_LEN];
+  const libsfp_quirk_t *q;
+
+  memset(slots, 0, sizeof(*slots) << bits);
+
+  for (i = 0; i < libsfp_quirks_count(); ++i) {
+    q = libsfp_quirks_get(i);
+    libsfp_quirk_key(key, q->oui, q->pn, sizeof(q->pn));
+    n = libsfp_quirk_hash(key, seed, bits);
+
+    if (slots[n]) {
+      /* Duplicate key: keep the first (overlay) entry */
+      libsfp_quirk_key(skey, slots[n]->oui, slots[n]->pn, sizeof(slots[n]->pn));
+      if (!memcmp(key, skey, sizeof(key)))
+        continue;
+      return -1;
+    }
+
+    slots[n] = q;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Build perfect hash table for current quirks set\n
+ *        (search for hash seed that gives no collisions)
+ * @return 0 on success
+ */
+static int libsfp_quirks_build(void)
+{
+  const libsfp_quirk_t **slots;
+  uint32_t bits = 3, seed;
+
+  while ((1u << bits) < 2*libsfp_quirks_count())
+    ++bits;
+
+  for (; bits < 20; ++bits) {
+
+    slots = malloc(sizeof(*slots) << bits);
+    if (!slots)
+      return -1;
+
+    for (seed = 0; seed < 256; ++seed) {
+      if (!libsfp_quirks_place(slots, seed, bits)) {
+        free(libsfp_quirks_slots);
+        libsfp_quirks_slots = slots;
+        libsfp_quirks_bits = bits;
+        libsfp_quirks_seed = seed;
+        libsfp_quirks_ready = 1;
+        return 0;
+      }
+    }
+
+    free(slots);
+  }
+
+  return -1;
+}
+
+/* First build (built-in quirks only, if no overlay was loaded yet) */
+static void libsfp_quirks_init(void)
+{
+  if (!libsfp_quirks_ready)
+    libsfp_quirks_build();
+}
+
+static const libsfp_quirk_t *libsfp_quirk_lookup(const uint8_t *key)
+{
+  const libsfp_quirk_t *q;
+  uint8_t qkey[LIBSFP_QUIRK_KEY_LEN];
+
+  q = libsfp_quirks_slots[libsfp_quirk_hash(key, libsfp_quirks_seed,
+                                            libsfp_quirks_bits)];
+  if (!q)
+    return 0;
+
+  libsfp_quirk_key(qkey, q->oui, q->pn, sizeof(q->pn));
+
+  return memcmp(key, qkey, sizeof(qkey)) ? 0 : q;
+}
+
+/**
+ * @brief Find quirk for module
+ * @param oui  - vendor OUI (3 bytes, as in A0 bank)
+ * @param pn   - vendor part number (16 bytes, as in A0 bank)
+ * @return quirk or 0 if module has no quirks
+ */
+const libsfp_quirk_t *libsfp_quirk_find(const uint8_t *oui, const uint8_t *pn)
+{
+  const libsfp_quirk_t *q;
+  uint8_t key[LIBSFP_QUIRK_KEY_LEN];
+
+  pthread_once(&libsfp_quirks_once, libsfp_quirks_init);
+  if (!libsfp_quirks_ready)
+    return 0;
+
+  libsfp_quirk_key(key, oui, (const char*)pn, LIBSFP_LEN_A0_VENDOR_PN);
+  q = libsfp_quirk_lookup(key);
+  if (q)
+    return q;
+
+  libsfp_quirk_key(key, (const uint8_t*)LIBSFP_QUIRK_ANY_OUI,
+                   (const char*)pn, LIBSFP_LEN_A0_VENDOR_PN);
+  return libsfp_quirk_lookup(key);
+}
+
+/* Parse one overlay line, return 1 if line is empty */
+static int libsfp_quirks_parse(char *s, libsfp_quirk_t *q)
+{
+  char *pn, *opt;
+  unsigned int o[3];
+  size_t len;
+  int n = 0;
+
+  memset(q, 0, sizeof(*q));
+
+  while (isspace((unsigned char)*s))
+    ++s;
+
+  if ((!*s) || (*s == '#'))
+    return 1;
+
+  /* OUI */
+  if (*s == '*') {
+    memcpy(q->oui, LIBSFP_QUIRK_ANY_OUI, sizeof(q->oui));
+    ++s;
+  } else {
+    if ((sscanf(s, "%2x:%2x:%2x%n", &o[0], &o[1], &o[2], &n) != 3) || (!n))
+      return -1;
+    q->oui[0] = o[0];
+    q->oui[1] = o[1];
+    q->oui[2] = o[2];
+    s += n;
+  }
+
+  if (!isspace((unsigned char)*s))
+    return -1;
+  while (isspace((unsigned char)*s))
+    ++s;
+
+  /* Part number */
+  if (*s == '"') {
+    pn = ++s;
+    while (*s && (*s != '"'))
+      ++s;
+    if (!*s)
+      return -1;
+  } else {
+    pn = s;
+    while (*s && !isspace((unsigned char)*s))
+      ++s;
+  }
+
+  len = s - pn;
+  if ((!len) || (len > LIBSFP_LEN_A0_VENDOR_PN))
+    return -1;
+  memcpy(q->pn, pn, len);
+
+  if (*s)
+    ++s;
+
+  /* Quirks */
+  for (opt = strtok(s, ", \t\r\n"); opt; opt = strtok(0, ", \t\r\n")) {
+    if (!strcmp(opt, "skip_a2"))
+      q->flags |= LIBSFP_QUIRK_SKIP_A2;
+    else if (!strcmp(opt, "intcal"))
+      q->flags |= LIBSFP_QUIRK_FORCE_INTCAL;
+    else if (!strcmp(opt, "ddm"))
+      q->flags |= LIBSFP_QUIRK_FORCE_DDM;
+    else if (!strncmp(opt, "chunk=", 6))
+      q->max_read = atoi(opt + 6);
+    else
+      return -1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Load user quirks overlay file\n
+ *        (entries override built-in ones, call before any module access)
+ * @param path  - overlay file path
+ * @return 0 on success
+ */
+int libsfp_quirks_load(const char *path)
+{
+  FILE *f;
+  char line[256];
+  libsfp_quirk_t q, *ov;
+  int r;
+
+  f = fopen(path, "r");
+  if (!f)
+    return -1;
+
+  while (fgets(line, sizeof(line), f)) {
+
+    r = libsfp_quirks_parse(line, &q);
+    if (r > 0)
+      continue;
+    if (r < 0)
+      goto err;
+
+    ov = realloc(libsfp_quirks_overlay,
+                 (libsfp_quirks_noverlay + 1)*sizeof(libsfp_quirk_t));
+    if (!ov)
+      goto err;
+
+    libsfp_quirks_overlay = ov;
+    libsfp_quirks_overlay[libsfp_quirks_noverlay++] = q;
+  }
+
+  fclose(f);
+
+  return libsfp_quirks_build();
+
+err:
+  fclose(f);
+  libsfp_quirks_build();
+  return -1;
+}
+
+/**
+ * @brief Get quirk applied to library handle
+ * @param h  - library handle
+ * @return quirk or 0 if current module has no quirks
+ */
+const libsfp_quirk_t *libsfp_get_quirk(libsfp_t *h)
+{
+  return (H(h)->has_quirk) ? &H(h)->quirk : 0;
+}
+
+/**
+ * @brief Apply quirk to diagnostic monitoring type
+ * @param q  quirk or 0
+ * @param v  diagnostic monitoring type as read from module
+ * @return diagnostic monitoring type to use
+ */
+uint8_t libsfp_quirks_dmtype(const libsfp_quirk_t *q, uint8_t v)
+{
+  if (!q)
+    return v;
+
+  if (q->flags & LIBSFP_QUIRK_FORCE_DDM)
+    v |= LIBSFP_A0_DIAGMON_TYPE_DDM;
+
+  if (q->flags & LIBSFP_QUIRK_SKIP_A2)
+    v &= ~LIBSFP_A0_DIAGMON_TYPE_DDM;
+
+  if (q->flags & LIBSFP_QUIRK_FORCE_INTCAL) {
+    v &= ~LIBSFP_A0_DIAGMON_TYPE_EXCAL;
+    v |= LIBSFP_A0_DIAGMON_TYPE_INCAL;
+  }
+
+  return v;
+}
+
+/**
+ * @brief Get diagnostic monitoring type of module with its quirks applied
+ * @param a0  - A0 bank data
+ * @return diagnostic monitoring type to use (see LIBSFP_A0_DIAGMON_TYPE_*)
+ */
+uint8_t libsfp_quirk_dmtype(const libsfp_A0_t *a0)
+{
+  return libsfp_quirks_dmtype(libsfp_quirk_find(a0->base.vendor_oui,
+                                                a0->base.vendor_pn),
+                              a0->ext.diag_mon_type);
+}
+
+/* Keep copy of module quirk in handle (overlay may be reloaded) */
+static void libsfp_quirks_set(libsfp_t *h, const libsfp_quirk_t *q)
+{
+  H(h)->identified = 1;
+  H(h)->has_quirk = (q != 0);
+  if (q)
+    H(h)->quirk = *q;
+  H(h)->max_read = (q) ? q->max_read : 0;
+}
+
+/**
+ * @brief Read module identity with safe read size and apply quirks
+ *        of the module to library handle
+ * @param h   library handle
+ * @param a0  A0 bank struct to store vendor OUI and part number
+ * @return 0 on success
+ */
+int libsfp_quirks_identify(libsfp_t *h, libsfp_A0_t *a0)
+{
+  /* Read size is not known yet: use safe one */
+  H(h)->identified = 0;
+  H(h)->has_quirk = 0;
+  H(h)->max_read = LIBSFP_QUIRK_SAFE_READ;
+
+  if (READREG_A0(h, LIBSFP_OFS_A0_VENDOR_OUI,
+                 LIBSFP_LEN_A0_VENDOR_OUI + LIBSFP_LEN_A0_VENDOR_PN,
+                 a0->base.vendor_oui))
+    return -1;
+
+  libsfp_quirks_set(h, libsfp_quirk_find(a0->base.vendor_oui,
+                                         a0->base.vendor_pn));
+
+  return 0;
+}
+
+/**
+ * @brief Apply quirks of module to library handle without module
+ *        access (module identity is already known)
+ * @param h   library handle
+ * @param a0  A0 bank data of module
+ * @return 0 on success
+ */
+int libsfp_quirks_apply(libsfp_t *h, const libsfp_A0_t *a0)
+{
+  libsfp_quirks_set(h, libsfp_quirk_find(a0->base.vendor_oui,
+                                         a0->base.vendor_pn));
+  H(h)->dmtype = libsfp_quirks_dmtype(libsfp_get_quirk(h),
+                                      a0->ext.diag_mon_type);
+  return 0;
+}
+
+/**
+ * @brief Get diagnostic monitoring type of current module with quirks
+ *        applied (module is identified once, until shadow cache is
+ *        invalidated, if shadow cache is not used)
+ * @param h       library handle
+ * @param dmtype  place to store diagnostic monitoring type
+ * @return 0 on success
+ */
+int libsfp_get_dmtype(libsfp_t *h, uint8_t *dmtype)
+{
+  libsfp_A0_t a0;
+  uint8_t v;
+
+  if (H(h)->flags & LIBSFP_FLAGS_CACHE) {
+
+    /* Quirks are applied when shadow cache is loaded */
+    if (libsfp_cache_update(h))
+      return -1;
+
+  } else {
+
+    if ((!H(h)->identified) && (libsfp_quirks_identify(h, &a0)))
+      return -1;
+
+    if (READREG_A0(h, LIBSFP_OFS_A0_DIAGMON_TYPE, 1, &v))
+      return -1;
+
+    H(h)->dmtype = libsfp_quirks_dmtype(libsfp_get_quirk(h), v);
+  }
+
+  (*dmtype) = H(h)->dmtype;
+
+  return 0;
+}
@@ -0,0 +1,85 @@
+#ifndef LIBSFP_QUIRKS_H__
+#define LIBSFP_QUIRKS_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (vendor quirks database)
+
+   Quirks are looked up by vendor OUI and part number when module
+   identity is read (shadow cache load, libsfp_readinfo) and change
+   the way library reads the module. Data returned to user (dumps of
+   libsfp_readinfo, READSTATIC data) is always raw module memory, quirks
+   are applied to diagnostic monitoring type only where library decides
+   how to access or decode the module, use libsfp_quirk_dmtype to do
+   the same with dumps.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libsfp.h>
+
+#define LIBSFP_QUIRK_SKIP_A2       0x01  /**< Do not access A2 bank
+                                              (DDM reported but broken) */
+#define LIBSFP_QUIRK_FORCE_INTCAL  0x02  /**< Ignore external calibration
+                                              constants (bogus values) */
+#define LIBSFP_QUIRK_FORCE_DDM     0x04  /**< DDM implemented but
+                                              not reported */
+
+#define LIBSFP_QUIRK_ANY_OUI  "\xFF\xFF\xFF"   /**< OUI matching any vendor */
+
+/** Vendor quirk description */
+typedef struct {
+  uint8_t oui[3];          /** Vendor OUI or LIBSFP_QUIRK_ANY_OUI */
+  char pn[17];             /** Vendor part number (without trailing spaces) */
+  uint32_t flags;          /** Quirk flags see LIBSFP_QUIRK_* */
+  uint16_t max_read;       /** Max bytes per read transaction (0 - no limit) */
+} libsfp_quirk_t;
+
+/**
+ * @brief Find quirk for module
+ * @param oui  - vendor OUI (3 bytes, as in A0 bank)
+ * @param pn   - vendor part number (16 bytes, as in A0 bank)
+ * @return quirk or 0 if module has no quirks
+ */
+const libsfp_quirk_t *libsfp_quirk_find(const uint8_t *oui, const uint8_t *pn);
+
+/**
+ * @brief Load user quirks overlay file\n
+ *        (entries override built-in ones, call before any module access)
+ *
+ * Must not be called concurrently with module access or quirk lookup,
+ * quirks returned by libsfp_quirk_find before the call become invalid.
+ *
+ * File contains lines: OUI PN QUIRKS\n
+ * OUI    - xx:xx:xx or '*' for any vendor\n
+ * PN     - part number, in double quotes if it contains spaces\n
+ * QUIRKS - comma separated list of: skip_a2, intcal, ddm, chunk=N\n
+ * Empty lines and lines starting with '#' are ignored
+ *
+ * @param path  - overlay file path
+ * @return 0 on success
+ */
+int libsfp_quirks_load(const char *path);
+
+/**
+ * @brief Get quirk applied to library handle
+ * @param h  - library handle
+ * @return quirk or 0 if current module has no quirks
+ */
+const libsfp_quirk_t *libsfp_get_quirk(libsfp_t *h);
+
+/**
+ * @brief Get diagnostic monitoring type of module with its quirks applied
+ * @param a0  - A0 bank data
+ * @return diagnostic monitoring type to use (see LIBSFP_A0_DIAGMON_TYPE_*)
+ */
+uint8_t libsfp_quirk_dmtype(const libsfp_A0_t *a0);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+/**
+   @file
+   @brief libsfp hot-plug detection scan of many cages
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "libsfp_int.h"
+#include "libsfp_cachefile.h"
+#include "libsfp_scan.h"
+
+/* Fingerprint window: cc_base ... head of vendor serial number */
+#define LIBSFP_SCAN_OFS  LIBSFP_OFS_A0_CC_BASE
+#define LIBSFP_SCAN_LEN  (LIBSFP_OFS_A0_VENDOR_SN + 8 - LIBSFP_OFS_A0_CC_BASE)
+
+typedef struct {
+  libsfp_t **handles;           /** Cage handles */
+  uint32_t ncages;              /** Number of cages */
+  uint32_t *fingerprints;       /** Last known fingerprints */
+  uint8_t *present;             /** Module presence flags */
+  libsfp_scan_event_cb_t cb;    /** Event callback */
+  void *udata;                  /** Event callback user data */
+} libsfp_scan_int_t;
+
+#define SC(ptr) ((libsfp_scan_int_t*)(ptr))
+
+/**
+ * @brief Create scan for set of cages
+ * @param handles  - array of library handles (one per cage)
+ * @param ncages   - number of cages
+ * @return scan handle or 0 if error occured
+ */
+libsfp_scan_t *libsfp_scan_create(libsfp_t **handles, uint32_t ncages)
+{
+  libsfp_scan_int_t *s;
+
+  s = malloc(sizeof(libsfp_scan_int_t));
+  if (!s)
+    return 0;
+
+  memset(s, 0, sizeof(*s));
+
+  /* Single allocation for all per cage arrays */
+  s->handles = malloc(ncages*(sizeof(libsfp_t*) + sizeof(uint32_t) + 1));
+  if (!s->handles) {
+    free(s);
+    return 0;
+  }
+
+  memcpy(s->handles, handles, ncages*sizeof(libsfp_t*));
+  s->fingerprints = (uint32_t*)(s->handles + ncages);
+  s->present = (uint8_t*)(s->fingerprints + ncages);
+  memset(s->fingerprints, 0, ncages*sizeof(uint32_t));
+  memset(s->present, 0, ncages);
+  s->ncages = ncages;
+
+  return (libsfp_scan_t*)s;
+}
+
+/**
+ * @brief Free scan handle and its memory
+ * @param s  - scan handle
+ * @return 0 on success
+ */
+int libsfp_scan_free(libsfp_scan_t *s)
+{
+  free(SC(s)->handles);
+  free(s);
+  return 0;
+}
+
+/**
+ * @brief Assign event callback
+ * @param s      - scan handle
+ * @param cb     - callback function address
+ * @param udata  - pointer passed to callback
+ * @return 0 on success
+ */
+int libsfp_scan_set_callback(libsfp_scan_t *s, libsfp_scan_event_cb_t cb,
+                             void *udata)
+{
+  SC(s)->cb = cb;
+  SC(s)->udata = udata;
+  return 0;
+}
+
+/**
+ * @brief Read fingerprint window of module
+ * @param h   library handle
+ * @param fp  place to store fingerprint
+ * @return 0 on success, -1 if module is not accessible
+ */
+static int libsfp_scan_fingerprint(libsfp_t *h, uint32_t *fp)
+{
+  libsfp_A0_t a0;
+
+  /* Only fields used by libsfp_fingerprint are read */
+  if (READREG_A0(h, LIBSFP_OFS_A0_IDENTIFIER, 1, &a0.base.identifier))
+    return -1;
+
+  if (READREG_A0(h, LIBSFP_SCAN_OFS, LIBSFP_SCAN_LEN, &a0.base.cc_base))
+    return -1;
+
+  if (READREG_A0(h, LIBSFP_OFS_A0_CC_EXT, 1, &a0.ext.cc_ext))
+    return -1;
+
+  (*fp) = libsfp_fingerprint(&a0);
+
+  return 0;
+}
+
+static void libsfp_scan_event(libsfp_scan_int_t *s, uint32_t cage,
+                              uint32_t event, uint32_t fp)
+{
+  libsfp_cache_invalidate(s->handles[cage]);
+
+  if (s->cb)
+    s->cb(s->udata, cage, event, fp);
+}
+
+/**
+ * @brief Scan all cages once
+ * @param s  - scan handle
+ * @return number of events
+ */
+int libsfp_scan_run(libsfp_scan_t *s)
+{
+  uint32_t i, fp;
+  int events = 0;
+  libsfp_scan_int_t *sc = SC(s);
+
+  for (i = 0; i < sc->ncages; ++i) {
+
+    if (libsfp_scan_fingerprint(sc->handles[i], &fp)) {
+
+      if (sc->present[i]) {
+        sc->present[i] = 0;
+        sc->fingerprints[i] = 0;
+        libsfp_scan_event(sc, i, LIBSFP_SCAN_EVENT_REMOVE, 0);
+        ++events;
+      }
+
+      continue;
+    }
+
+    if (!sc->present[i]) {
+      sc->present[i] = 1;
+      sc->fingerprints[i] = fp;
+      libsfp_scan_event(sc, i, LIBSFP_SCAN_EVENT_INSERT, fp);
+      ++events;
+      continue;
+    }
+
+    if (sc->fingerprints[i] != fp) {
+      sc->fingerprints[i] = fp;
+      libsfp_scan_event(sc, i, LIBSFP_SCAN_EVENT_SWAP, fp);
+      ++events;
+    }
+  }
+
+  return events;
+}
+
+/**
+ * @brief Get last known module fingerprint of cage
+ * @param s            - scan handle
+ * @param cage         - cage number
+ * @param fingerprint  - place to store fingerprint
+ * @return 0 on success, -1 if cage is empty
+ */
+int libsfp_scan_get_fingerprint(libsfp_scan_t *s, uint32_t cage,
+                                uint32_t *fingerprint)
+{
+  if ((cage >= SC(s)->ncages) || !SC(s)->present[cage])
+    return -1;
+
+  (*fingerprint) = SC(s)->fingerprints[cage];
+  return 0;
+}
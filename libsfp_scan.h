@@ -0,0 +1,88 @@
+#ifndef LIBSFP_SCAN_H__
+#define LIBSFP_SCAN_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (hot-plug detection scan of many cages)
+
+   Scan reads only small fingerprint window of every cage (identifier,
+   cc_base, head of serial number and cc_ext), calcs module fingerprint
+   and compares it with previous one. On change the event callback is
+   called and shadow cache of cage handle is invalidated.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libsfp.h>
+
+#define LIBSFP_SCAN_EVENT_INSERT  1   /**< Module inserted to empty cage */
+#define LIBSFP_SCAN_EVENT_REMOVE  2   /**< Module removed from cage */
+#define LIBSFP_SCAN_EVENT_SWAP    3   /**< Module replaced with other one */
+
+/** @brief Callback called on cage module change
+ *
+ *  @param udata        User provided data pointer
+ *                      (see libsfp_scan_set_callback)
+ *  @param cage         Cage number
+ *  @param event        Event see LIBSFP_SCAN_EVENT_* constants
+ *  @param fingerprint  New module fingerprint (0 for remove event)
+ */
+typedef void (*libsfp_scan_event_cb_t)(void *udata, uint32_t cage,
+                                       uint32_t event, uint32_t fingerprint);
+
+/** Scan handle\n
+ *  Use only pointer to this type
+*/
+typedef struct {
+} libsfp_scan_t;
+
+/**
+ * @brief Create scan for set of cages
+ * @param handles  - array of library handles (one per cage)
+ * @param ncages   - number of cages
+ * @return scan handle or 0 if error occured
+ */
+libsfp_scan_t *libsfp_scan_create(libsfp_t **handles, uint32_t ncages);
+
+/**
+ * @brief Free scan handle and its memory
+ * @param s  - scan handle
+ * @return 0 on success
+ */
+int libsfp_scan_free(libsfp_scan_t *s);
+
+/**
+ * @brief Assign event callback
+ * @param s      - scan handle
+ * @param cb     - callback function address
+ * @param udata  - pointer passed to callback
+ * @return 0 on success
+ */
+int libsfp_scan_set_callback(libsfp_scan_t *s, libsfp_scan_event_cb_t cb,
+                             void *udata);
+
+/**
+ * @brief Scan all cages once
+ * @param s  - scan handle
+ * @return number of events
+ */
+int libsfp_scan_run(libsfp_scan_t *s);
+
+/**
+ * @brief Get last known module fingerprint of cage
+ * @param s            - scan handle
+ * @param cage         - cage number
+ * @param fingerprint  - place to store fingerprint
+ * @return 0 on success, -1 if cage is empty
+ */
+int libsfp_scan_get_fingerprint(libsfp_scan_t *s, uint32_t cage,
+                                uint32_t *fingerprint);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
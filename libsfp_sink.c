@@ -0,0 +1,254 @@
+/**
+   @file
+   @brief libsfp buffered output sink
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libsfp_int.h"
+#include "libsfp_sink.h"
+
+#define LIBSFP_SINK_DEF_SIZE  4096   /**< Default growable buffer size */
+
+static libsfp_sink_int_t *libsfp_sink_alloc(void *buf, size_t size, uint8_t growable)
+{
+  libsfp_sink_int_t *s;
+
+  s = malloc(sizeof(libsfp_sink_int_t));
+  if (!s)
+    return 0;
+
+  memset(s, 0, sizeof(libsfp_sink_int_t));
+  s->buf = buf;
+  s->size = size;
+  s->growable = growable;
+
+  return s;
+}
+
+/**
+ * @brief Create output sink with growable buffer
+ * @param size  - initial buffer size
+ * @return sink handle or 0 if error occured
+ */
+libsfp_sink_t *libsfp_sink_create(size_t size)
+{
+  libsfp_sink_int_t *s;
+  char *buf;
+
+  if (!size)
+    size = LIBSFP_SINK_DEF_SIZE;
+
+  buf = malloc(size);
+  if (!buf)
+    return 0;
+
+  s = libsfp_sink_alloc(buf, size, 1);
+  if (!s)
+    free(buf);
+
+  return (libsfp_sink_t*)s;
+}
+
+/**
+ * @brief Create output sink with caller provided buffer\n
+ *        (buffer is flushed when it is full, if flush callback is not
+ *         assigned text that does not fit is lost)
+ * @param buf   - buffer
+ * @param size  - buffer size
+ * @return sink handle or 0 if error occured
+ */
+libsfp_sink_t *libsfp_sink_create_static(void *buf, size_t size)
+{
+  if ((!buf) || (!size))
+    return 0;
+
+  return (libsfp_sink_t*)libsfp_sink_alloc(buf, size, 0);
+}
+
+/**
+ * @brief Free output sink (caller provided buffer is not freed)
+ * @param s  - sink handle
+ * @return 0 on success
+ */
+int libsfp_sink_free(libsfp_sink_t *s)
+{
+  if (SK(s)->growable)
+    free(SK(s)->buf);
+  free(s);
+  return 0;
+}
+
+/**
+ * @brief Assign flush callback
+ * @param s      - sink handle
+ * @param flush  - callback or 0 to keep text in buffer
+ * @param udata  - user data pointer for callback
+ * @return 0 on success
+ */
+int libsfp_sink_set_flush(libsfp_sink_t *s, libsfp_sink_flush_cb_t flush, void *udata)
+{
+  SK(s)->flush = flush;
+  SK(s)->udata = udata;
+  return 0;
+}
+
+/**
+ * @brief Flush callback writing text to stdio stream
+ * @param udata  - stream (FILE*)
+ * @param data   - text
+ * @param len    - text length
+ * @return 0 on success
+ */
+int libsfp_sink_flush_file(void *udata, const char *data, size_t len)
+{
+  return (fwrite(data, 1, len, (FILE*)udata) == len) ? 0 : -1;
+}
+
+/**
+ * @brief Pass collected text to flush callback and empty buffer
+ * @param s  - sink handle
+ * @return 0 on success
+ */
+int libsfp_sink_flush(libsfp_sink_t *s)
+{
+  int r = 0;
+
+  if ((!SK(s)->flush) || (!SK(s)->len))
+    return 0;
+
+  if (SK(s)->flush(SK(s)->udata, SK(s)->buf, SK(s)->len)) {
+    SK(s)->error = 1;
+    r = -1;
+  }
+
+  SK(s)->len = 0;
+
+  return r;
+}
+
+/**
+ * @brief Make place for n bytes at buffer end
+ *        (grow or flush buffer)
+ * @param s  - sink handle
+ * @param n  - number of bytes
+ * @return 0 on success, -1 if there is no place (sink error is set)
+ */
+int libsfp_sink_reserve(libsfp_sink_t *s, size_t n)
+{
+  size_t size;
+  char *buf;
+
+  if (SK(s)->size - SK(s)->len >= n)
+    return 0;
+
+  if (SK(s)->growable) {
+    size = SK(s)->size*2;
+    if (size < SK(s)->len + n)
+      size = SK(s)->len + n;
+
+    buf = realloc(SK(s)->buf, size);
+    if (buf) {
+      SK(s)->buf = buf;
+      SK(s)->size = size;
+      return 0;
+    }
+  } else
+    if (SK(s)->flush) {
+      libsfp_sink_flush(s);
+      if (SK(s)->size >= n)
+        return 0;
+    }
+
+  SK(s)->error = 1;
+  return -1;
+}
+
+/**
+ * @brief Append data to sink
+ * @param s     - sink handle
+ * @param data  - data
+ * @param len   - data length
+ * @return 0 on success, -1 if data was lost
+ */
+int libsfp_sink_write(libsfp_sink_t *s, const void *data, size_t len)
+{
+  char *p;
+
+  /* Data larger than static buffer goes to flush callback directly */
+  if ((!SK(s)->growable) && (SK(s)->flush) && (len > SK(s)->size)) {
+    if (libsfp_sink_flush(s))
+      return -1;
+    if (SK(s)->flush(SK(s)->udata, data, len)) {
+      SK(s)->error = 1;
+      return -1;
+    }
+    return 0;
+  }
+
+  p = libsfp_sink_space(s, len);
+  if (!p)
+    return -1;
+
+  memcpy(p, data, len);
+  SK(s)->len += len;
+
+  return 0;
+}
+
+/**
+ * @brief Empty buffer and clear error state
+ * @param s  - sink handle
+ * @return 0 on success
+ */
+int libsfp_sink_reset(libsfp_sink_t *s)
+{
+  SK(s)->len = 0;
+  SK(s)->error = 0;
+  return 0;
+}
+
+/**
+ * @brief Get collected text
+ * @param s  - sink handle
+ * @return text (not zero terminated)
+ */
+const char *libsfp_sink_data(libsfp_sink_t *s)
+{
+  return SK(s)->buf;
+}
+
+/**
+ * @brief Get collected text length
+ * @param s  - sink handle
+ * @return length
+ */
+size_t libsfp_sink_len(libsfp_sink_t *s)
+{
+  return SK(s)->len;
+}
+
+/**
+ * @brief Check if some text was lost (buffer overflow or flush error)
+ *        since last reset
+ * @param s  - sink handle
+ * @return 0 if no text was lost
+ */
+int libsfp_sink_error(libsfp_sink_t *s)
+{
+  return SK(s)->error;
+}
+
+/**
+ * @brief Assign output sink to library handle\n
+ *        (print callbacks are not used while sink is assigned)
+ * @param h  - library handle
+ * @param s  - sink handle or 0 to use print callbacks
+ * @return 0 on success
+ */
+int libsfp_set_output_sink(libsfp_t *h, libsfp_sink_t *s)
+{
+  H(h)->sink = s;
+  return 0;
+}
@@ -0,0 +1,140 @@
+#ifndef LIBSFP_SINK_H__
+#define LIBSFP_SINK_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (buffered output sink)
+
+   Output sink collects printed text in one buffer. Buffer is either
+   growable (allocated by library) or provided by caller. When output
+   sink is assigned to library handle printers append text to it
+   directly instead of calling print callbacks, and whole module
+   information is passed to flush callback with one call.
+
+   Sink text layout is the same as of default print callbacks.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <libsfp.h>
+
+/** @brief Callback to write out collected text
+ *
+ *  @param udata  User provided data pointer (see libsfp_sink_set_flush).
+ *  @param data   Text (not zero terminated).
+ *  @param len    Text length.
+ *  @return 0 on success
+ */
+typedef int (*libsfp_sink_flush_cb_t)(void *udata, const char *data, size_t len);
+
+/** Output sink handle\n
+ *  Use only pointer to this type
+*/
+typedef struct {
+} libsfp_sink_t;
+
+/**
+ * @brief Create output sink with growable buffer
+ * @param size  - initial buffer size
+ * @return sink handle or 0 if error occured
+ */
+libsfp_sink_t *libsfp_sink_create(size_t size);
+
+/**
+ * @brief Create output sink with caller provided buffer\n
+ *        (buffer is flushed when it is full, if flush callback is not
+ *         assigned text that does not fit is lost)
+ * @param buf   - buffer
+ * @param size  - buffer size
+ * @return sink handle or 0 if error occured
+ */
+libsfp_sink_t *libsfp_sink_create_static(void *buf, size_t size);
+
+/**
+ * @brief Free output sink (caller provided buffer is not freed)
+ * @param s  - sink handle
+ * @return 0 on success
+ */
+int libsfp_sink_free(libsfp_sink_t *s);
+
+/**
+ * @brief Assign flush callback
+ * @param s      - sink handle
+ * @param flush  - callback or 0 to keep text in buffer
+ * @param udata  - user data pointer for callback
+ * @return 0 on success
+ */
+int libsfp_sink_set_flush(libsfp_sink_t *s, libsfp_sink_flush_cb_t flush, void *udata);
+
+/**
+ * @brief Flush callback writing text to stdio stream
+ * @param udata  - stream (FILE*)
+ * @param data   - text
+ * @param len    - text length
+ * @return 0 on success
+ */
+int libsfp_sink_flush_file(void *udata, const char *data, size_t len);
+
+/**
+ * @brief Append data to sink
+ * @param s     - sink handle
+ * @param data  - data
+ * @param len   - data length
+ * @return 0 on success, -1 if data was lost
+ */
+int libsfp_sink_write(libsfp_sink_t *s, const void *data, size_t len);
+
+/**
+ * @brief Pass collected text to flush callback and empty buffer
+ * @param s  - sink handle
+ * @return 0 on success
+ */
+int libsfp_sink_flush(libsfp_sink_t *s);
+
+/**
+ * @brief Empty buffer and clear error state
+ * @param s  - sink handle
+ * @return 0 on success
+ */
+int libsfp_sink_reset(libsfp_sink_t *s);
+
+/**
+ * @brief Get collected text
+ * @param s  - sink handle
+ * @return text (not zero terminated)
+ */
+const char *libsfp_sink_data(libsfp_sink_t *s);
+
+/**
+ * @brief Get collected text length
+ * @param s  - sink handle
+ * @return length
+ */
+size_t libsfp_sink_len(libsfp_sink_t *s);
+
+/**
+ * @brief Check if some text was lost (buffer overflow or flush error)
+ *        since last reset
+ * @param s  - sink handle
+ * @return 0 if no text was lost
+ */
+int libsfp_sink_error(libsfp_sink_t *s);
+
+/**
+ * @brief Assign output sink to library handle\n
+ *        (print callbacks are not used while sink is assigned)
+ * @param h  - library handle
+ * @param s  - sink handle or 0 to use print callbacks
+ * @return 0 on success
+ */
+int libsfp_set_output_sink(libsfp_t *h, libsfp_sink_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
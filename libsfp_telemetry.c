@@ -0,0 +1,327 @@
+/**
+   @file
+   @brief libsfp structure of arrays diagnostics store of many ports
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "libsfp_int.h"
+#include "libsfp_telemetry.h"
+
+#define LIBSFP_TELEMETRY_LINE  64   /**< Cache line size */
+
+_Static_assert(LIBSFP_TELEMETRY_BUS_ALIGN*sizeof(uint16_t) % LIBSFP_TELEMETRY_LINE == 0,
+               "bus region of 16 bit array must fill whole cache lines");
+
+typedef struct {
+  libsfp_u16_field_t *raw[LIBSFP_CAL_CHANNELS];  /** Raw values per channel */
+  uint16_t *flags[3];           /** Alarms, warnings and status */
+  uint64_t *ts;                 /** Capture timestamps (0 - empty slot) */
+  uint32_t nbuses;              /** Number of buses */
+  uint32_t nports;              /** Ports per bus */
+  uint32_t stride;              /** Ports per bus with padding */
+  uint32_t size;                /** Slots in every array */
+} libsfp_telemetry_int_t;
+
+#define TL(ptr) ((libsfp_telemetry_int_t*)(ptr))
+
+/**
+ * @brief Create telemetry store
+ * @param nbuses         - number of buses
+ * @param ports_per_bus  - number of ports on every bus
+ * @return telemetry store handle or 0 if error occured
+ */
+libsfp_telemetry_t *libsfp_telemetry_create(uint32_t nbuses, uint32_t ports_per_bus)
+{
+  libsfp_telemetry_int_t *t;
+  uint8_t *p;
+  size_t size;
+  uint32_t i;
+
+  if ((!nbuses) || (!ports_per_bus))
+    return 0;
+
+  t = malloc(sizeof(libsfp_telemetry_int_t));
+  if (!t)
+    return 0;
+
+  t->nbuses = nbuses;
+  t->nports = ports_per_bus;
+  t->stride = (ports_per_bus + LIBSFP_TELEMETRY_BUS_ALIGN - 1) &
+              ~(LIBSFP_TELEMETRY_BUS_ALIGN - 1);
+  t->size = nbuses*t->stride;
+
+  /* Single aligned block: every array size is multiple of cache line */
+  size = (size_t)t->size*(LIBSFP_CAL_CHANNELS*sizeof(libsfp_u16_field_t) +
+                          3*sizeof(uint16_t) + sizeof(uint64_t));
+  if (posix_memalign((void**)&p, LIBSFP_TELEMETRY_LINE, size)) {
+    free(t);
+    return 0;
+  }
+  memset(p, 0, size);
+
+  t->ts = (uint64_t*)p;
+  p += (size_t)t->size*sizeof(uint64_t);
+
+  for (i = 0; i < LIBSFP_CAL_CHANNELS; ++i) {
+    t->raw[i] = (libsfp_u16_field_t*)p;
+    p += (size_t)t->size*sizeof(libsfp_u16_field_t);
+  }
+
+  for (i = 0; i < 3; ++i) {
+    t->flags[i] = (uint16_t*)p;
+    p += (size_t)t->size*sizeof(uint16_t);
+  }
+
+  return (libsfp_telemetry_t*)t;
+}
+
+/**
+ * @brief Free telemetry store and its memory
+ * @param t  - telemetry store handle
+ * @return 0 on success
+ */
+int libsfp_telemetry_free(libsfp_telemetry_t *t)
+{
+  free(TL(t)->ts);
+  free(t);
+  return 0;
+}
+
+/**
+ * @brief Get number of slots in every array (including padding)
+ * @param t  - telemetry store handle
+ * @return number of slots
+ */
+uint32_t libsfp_telemetry_size(libsfp_telemetry_t *t)
+{
+  return TL(t)->size;
+}
+
+/**
+ * @brief Get distance between first slots of neighbour buses
+ * @param t  - telemetry store handle
+ * @return number of slots
+ */
+uint32_t libsfp_telemetry_stride(libsfp_telemetry_t *t)
+{
+  return TL(t)->stride;
+}
+
+/**
+ * @brief Get slot of port
+ * @param t     - telemetry store handle
+ * @param bus   - bus number
+ * @param port  - port number on bus
+ * @return slot or -1 if there is no such port
+ */
+int32_t libsfp_telemetry_index(libsfp_telemetry_t *t, uint32_t bus, uint32_t port)
+{
+  if ((bus >= TL(t)->nbuses) || (port >= TL(t)->nports))
+    return -1;
+  return bus*TL(t)->stride + port;
+}
+
+/**
+ * @brief Store diagnostics of port
+ * @param t          - telemetry store handle
+ * @param bus        - bus number
+ * @param port       - port number on bus
+ * @param dg         - diagnostics section as read from module
+ * @param timestamp  - capture time of diagnostics (ms, monotonic clock)
+ * @return 0 on success
+ */
+int libsfp_telemetry_store(libsfp_telemetry_t *t, uint32_t bus, uint32_t port,
+                           const libsfp_rtdiagnostics_fields_t *dg,
+                           uint64_t timestamp)
+{
+  int32_t i = libsfp_telemetry_index(t, bus, port);
+
+  if (i < 0)
+    return -1;
+
+  TL(t)->raw[LIBSFP_CAL_CH_TEMP][i] = dg->temperature;
+  TL(t)->raw[LIBSFP_CAL_CH_VOLTAGE][i] = dg->voltage;
+  TL(t)->raw[LIBSFP_CAL_CH_BIAS][i] = dg->bias_current;
+  TL(t)->raw[LIBSFP_CAL_CH_TXPOWER][i] = dg->tx_power;
+  TL(t)->raw[LIBSFP_CAL_CH_RXPOWER][i] = dg->rx_power;
+
+  TL(t)->flags[LIBSFP_TELEMETRY_ALARMS][i] = (dg->alarms[0] << 8) | dg->alarms[1];
+  TL(t)->flags[LIBSFP_TELEMETRY_WARNINGS][i] = (dg->warnings[0] << 8) | dg->warnings[1];
+  TL(t)->flags[LIBSFP_TELEMETRY_STATUS][i] = (dg->status << 8) | dg->estatus;
+
+  /* Zero timestamp marks empty slot */
+  TL(t)->ts[i] = (timestamp) ? timestamp : 1;
+
+  return 0;
+}
+
+/**
+ * @brief Read diagnostics of port module using library handle and store it
+ * @param t        - telemetry store handle
+ * @param bus      - bus number
+ * @param port     - port number on bus
+ * @param h        - library handle of port
+ * @param max_age  - max acceptable age of diagnostics (ms)
+ * @return 0 on success
+ */
+int libsfp_telemetry_update(libsfp_telemetry_t *t, uint32_t bus, uint32_t port,
+                            libsfp_t *h, uint32_t max_age)
+{
+  libsfp_rtdiagnostics_fields_t dg;
+  uint64_t ts;
+
+  if (libsfp_read_diagnostics_aged(h, max_age, &dg, &ts))
+    return -1;
+
+  return libsfp_telemetry_store(t, bus, port, &dg, ts);
+}
+
+/**
+ * @brief Mark port as empty
+ * @param t     - telemetry store handle
+ * @param bus   - bus number
+ * @param port  - port number on bus
+ * @return 0 on success
+ */
+int libsfp_telemetry_clear(libsfp_telemetry_t *t, uint32_t bus, uint32_t port)
+{
+  int32_t i = libsfp_telemetry_index(t, bus, port);
+  uint32_t n;
+
+  if (i < 0)
+    return -1;
+
+  for (n = 0; n < LIBSFP_CAL_CHANNELS; ++n)
+    memset(&TL(t)->raw[n][i], 0, sizeof(libsfp_u16_field_t));
+  for (n = 0; n < 3; ++n)
+    TL(t)->flags[n][i] = 0;
+  TL(t)->ts[i] = 0;
+
+  return 0;
+}
+
+/**
+ * @brief Get raw values array of channel\n
+ *        (big endian as in A2 bank, may be passed to libsfp_cal_batch)
+ * @param t   - telemetry store handle
+ * @param ch  - channel see LIBSFP_CAL_CH_*
+ * @return array of libsfp_telemetry_size elements or 0 if channel is wrong
+ */
+const libsfp_u16_field_t *libsfp_telemetry_raw(libsfp_telemetry_t *t, uint32_t ch)
+{
+  return (ch < LIBSFP_CAL_CHANNELS) ? TL(t)->raw[ch] : 0;
+}
+
+/**
+ * @brief Get flags array
+ * @param t     - telemetry store handle
+ * @param type  - flags type see LIBSFP_TELEMETRY_ALARMS, WARNINGS, STATUS
+ * @return array of libsfp_telemetry_size elements or 0 if type is wrong
+ */
+const uint16_t *libsfp_telemetry_flags(libsfp_telemetry_t *t, uint32_t type)
+{
+  return (type <= LIBSFP_TELEMETRY_STATUS) ? TL(t)->flags[type] : 0;
+}
+
+/**
+ * @brief Get timestamps array (ms, monotonic clock, 0 - empty slot)
+ * @param t  - telemetry store handle
+ * @return array of libsfp_telemetry_size elements
+ */
+const uint64_t *libsfp_telemetry_timestamps(libsfp_telemetry_t *t)
+{
+  return TL(t)->ts;
+}
+
+/* Append slots of block matches that are not empty */
+static uint32_t libsfp_telemetry_collect(libsfp_telemetry_int_t *t, uint32_t base,
+                                         uint32_t m, uint32_t *idx, uint32_t max,
+                                         uint32_t cnt)
+{
+  uint32_t i;
+
+  /* Timestamps are touched only for matched slots */
+  for (; m; m &= m - 1) {
+    i = base + __builtin_ctz(m);
+    if (!t->ts[i])
+      continue;
+    if (idx && (cnt < max))
+      idx[cnt] = i;
+    ++cnt;
+  }
+
+  return cnt;
+}
+
+/**
+ * @brief Find ports with raw channel value out of range
+ * @param t     - telemetry store handle
+ * @param ch    - channel see LIBSFP_CAL_CH_*
+ * @param lo    - min allowed raw value (signed for temperature)
+ * @param hi    - max allowed raw value (signed for temperature)
+ * @param idx   - array to store slots of found ports or 0
+ * @param max   - size of idx array
+ * @return number of found ports (may be more than max)
+ */
+uint32_t libsfp_telemetry_scan_range(libsfp_telemetry_t *t, uint32_t ch,
+                                     int32_t lo, int32_t hi,
+                                     uint32_t *idx, uint32_t max)
+{
+  const uint8_t *d;
+  uint32_t base, i, m, cnt = 0;
+  int32_t v;
+
+  if (ch >= LIBSFP_CAL_CHANNELS)
+    return 0;
+
+  /* Arrays are padded to whole blocks of 32 slots */
+  for (base = 0; base < TL(t)->size; base += LIBSFP_TELEMETRY_BUS_ALIGN) {
+
+    d = TL(t)->raw[ch][base].d;
+    m = 0;
+
+    for (i = 0; i < LIBSFP_TELEMETRY_BUS_ALIGN; ++i) {
+      v = (d[2*i] << 8) | d[2*i + 1];
+      if (ch == LIBSFP_CAL_CH_TEMP)
+        v = (int16_t)v;
+      m |= (uint32_t)((v < lo) | (v > hi)) << i;
+    }
+
+    if (m)
+      cnt = libsfp_telemetry_collect(TL(t), base, m, idx, max, cnt);
+  }
+
+  return cnt;
+}
+
+/**
+ * @brief Find ports with any of alarm or warning flags set
+ * @param t         - telemetry store handle
+ * @param alarms    - alarm flags mask (see LIBSFP_TELEMETRY_ALARMS)
+ * @param warnings  - warning flags mask (see LIBSFP_TELEMETRY_WARNINGS)
+ * @param idx       - array to store slots of found ports or 0
+ * @param max       - size of idx array
+ * @return number of found ports (may be more than max)
+ */
+uint32_t libsfp_telemetry_scan_flags(libsfp_telemetry_t *t,
+                                     uint16_t alarms, uint16_t warnings,
+                                     uint32_t *idx, uint32_t max)
+{
+  const uint16_t *a = TL(t)->flags[LIBSFP_TELEMETRY_ALARMS];
+  const uint16_t *w = TL(t)->flags[LIBSFP_TELEMETRY_WARNINGS];
+  uint32_t base, i, m, cnt = 0;
+
+  for (base = 0; base < TL(t)->size; base += LIBSFP_TELEMETRY_BUS_ALIGN) {
+
+    m = 0;
+
+    for (i = 0; i < LIBSFP_TELEMETRY_BUS_ALIGN; ++i)
+      m |= (uint32_t)(((a[base + i] & alarms) | (w[base + i] & warnings)) != 0) << i;
+
+    if (m)
+      cnt = libsfp_telemetry_collect(TL(t), base, m, idx, max, cnt);
+  }
+
+  return cnt;
+}
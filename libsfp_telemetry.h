@@ -0,0 +1,170 @@
+#ifndef LIBSFP_TELEMETRY_H__
+#define LIBSFP_TELEMETRY_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (structure of arrays diagnostics store of many ports)
+
+   Telemetry store keeps diagnostics of many ports in separate
+   contiguous arrays (one per channel, flags and timestamps), so scan
+   of one channel over all ports reads only that channel. Every array
+   is 64 byte aligned. Ports are grouped by bus, each bus region is
+   padded to LIBSFP_TELEMETRY_BUS_ALIGN ports so writers of different
+   buses never share cache line.
+
+   Slot of port is bus*stride + port (see libsfp_telemetry_index),
+   slots of empty ports have zero timestamp.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libsfp.h>
+#include <libsfp_cal.h>
+
+#define LIBSFP_TELEMETRY_BUS_ALIGN  32  /**< Bus region alignment (ports) */
+
+/* Flags arrays */
+#define LIBSFP_TELEMETRY_ALARMS    0  /**< Alarm flags (A2 bytes 112-113,
+                                           byte 112 is high byte) */
+#define LIBSFP_TELEMETRY_WARNINGS  1  /**< Warning flags (A2 bytes 116-117,
+                                           byte 116 is high byte) */
+#define LIBSFP_TELEMETRY_STATUS    2  /**< Status (A2 byte 110, high byte)
+                                           and extended status (A2 byte 118) */
+
+/** Telemetry store handle\n
+ *  Use only pointer to this type
+*/
+typedef struct {
+} libsfp_telemetry_t;
+
+/**
+ * @brief Create telemetry store
+ * @param nbuses         - number of buses
+ * @param ports_per_bus  - number of ports on every bus
+ * @return telemetry store handle or 0 if error occured
+ */
+libsfp_telemetry_t *libsfp_telemetry_create(uint32_t nbuses, uint32_t ports_per_bus);
+
+/**
+ * @brief Free telemetry store and its memory
+ * @param t  - telemetry store handle
+ * @return 0 on success
+ */
+int libsfp_telemetry_free(libsfp_telemetry_t *t);
+
+/**
+ * @brief Get number of slots in every array (including padding)
+ * @param t  - telemetry store handle
+ * @return number of slots
+ */
+uint32_t libsfp_telemetry_size(libsfp_telemetry_t *t);
+
+/**
+ * @brief Get distance between first slots of neighbour buses
+ * @param t  - telemetry store handle
+ * @return number of slots
+ */
+uint32_t libsfp_telemetry_stride(libsfp_telemetry_t *t);
+
+/**
+ * @brief Get slot of port
+ * @param t     - telemetry store handle
+ * @param bus   - bus number
+ * @param port  - port number on bus
+ * @return slot or -1 if there is no such port
+ */
+int32_t libsfp_telemetry_index(libsfp_telemetry_t *t, uint32_t bus, uint32_t port);
+
+/**
+ * @brief Store diagnostics of port
+ * @param t          - telemetry store handle
+ * @param bus        - bus number
+ * @param port       - port number on bus
+ * @param dg         - diagnostics section as read from module
+ * @param timestamp  - capture time of diagnostics (ms, monotonic clock)
+ * @return 0 on success
+ */
+int libsfp_telemetry_store(libsfp_telemetry_t *t, uint32_t bus, uint32_t port,
+                           const libsfp_rtdiagnostics_fields_t *dg,
+                           uint64_t timestamp);
+
+/**
+ * @brief Read diagnostics of port module using library handle and store it
+ * @param t        - telemetry store handle
+ * @param bus      - bus number
+ * @param port     - port number on bus
+ * @param h        - library handle of port
+ * @param max_age  - max acceptable age of diagnostics (ms)
+ * @return 0 on success
+ */
+int libsfp_telemetry_update(libsfp_telemetry_t *t, uint32_t bus, uint32_t port,
+                            libsfp_t *h, uint32_t max_age);
+
+/**
+ * @brief Mark port as empty
+ * @param t     - telemetry store handle
+ * @param bus   - bus number
+ * @param port  - port number on bus
+ * @return 0 on success
+ */
+int libsfp_telemetry_clear(libsfp_telemetry_t *t, uint32_t bus, uint32_t port);
+
+/**
+ * @brief Get raw values array of channel\n
+ *        (big endian as in A2 bank, may be passed to libsfp_cal_batch)
+ * @param t   - telemetry store handle
+ * @param ch  - channel see LIBSFP_CAL_CH_*
+ * @return array of libsfp_telemetry_size elements or 0 if channel is wrong
+ */
+const libsfp_u16_field_t *libsfp_telemetry_raw(libsfp_telemetry_t *t, uint32_t ch);
+
+/**
+ * @brief Get flags array
+ * @param t     - telemetry store handle
+ * @param type  - flags type see LIBSFP_TELEMETRY_ALARMS, WARNINGS, STATUS
+ * @return array of libsfp_telemetry_size elements or 0 if type is wrong
+ */
+const uint16_t *libsfp_telemetry_flags(libsfp_telemetry_t *t, uint32_t type);
+
+/**
+ * @brief Get timestamps array (ms, monotonic clock, 0 - empty slot)
+ * @param t  - telemetry store handle
+ * @return array of libsfp_telemetry_size elements
+ */
+const uint64_t *libsfp_telemetry_timestamps(libsfp_telemetry_t *t);
+
+/**
+ * @brief Find ports with raw channel value out of range
+ * @param t     - telemetry store handle
+ * @param ch    - channel see LIBSFP_CAL_CH_*
+ * @param lo    - min allowed raw value (signed for temperature)
+ * @param hi    - max allowed raw value (signed for temperature)
+ * @param idx   - array to store slots of found ports or 0
+ * @param max   - size of idx array
+ * @return number of found ports (may be more than max)
+ */
+uint32_t libsfp_telemetry_scan_range(libsfp_telemetry_t *t, uint32_t ch,
+                                     int32_t lo, int32_t hi,
+                                     uint32_t *idx, uint32_t max);
+
+/**
+ * @brief Find ports with any of alarm or warning flags set
+ * @param t         - telemetry store handle
+ * @param alarms    - alarm flags mask (see LIBSFP_TELEMETRY_ALARMS)
+ * @param warnings  - warning flags mask (see LIBSFP_TELEMETRY_WARNINGS)
+ * @param idx       - array to store slots of found ports or 0
+ * @param max       - size of idx array
+ * @return number of found ports (may be more than max)
+ */
+uint32_t libsfp_telemetry_scan_flags(libsfp_telemetry_t *t,
+                                     uint16_t alarms, uint16_t warnings,
+                                     uint32_t *idx, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
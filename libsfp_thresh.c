@@ -0,0 +1,256 @@
+/**
+   @file
+   @brief libsfp software alarm and warning thresholds evaluation
+*/
+
+#include <string.h>
+#include "libsfp_int.h"
+#include "libsfp_thresh.h"
+
+/* Raw value of channel (temperature is signed) */
+static int32_t libsfp_thresh_raw(uint32_t ch, libsfp_u16_field_t f)
+{
+  int32_t v = (f.d[0] << 8) | f.d[1];
+  return (ch == LIBSFP_CAL_CH_TEMP) ? (int16_t)v : v;
+}
+
+static float libsfp_thresh_value(const libsfp_cal_t *c, uint32_t ch, int32_t raw)
+{
+  switch (ch) {
+  case LIBSFP_CAL_CH_TEMP:
+    return libsfp_cal_temp(c, raw);
+  case LIBSFP_CAL_CH_VOLTAGE:
+    return libsfp_cal_voltage(c, raw);
+  case LIBSFP_CAL_CH_BIAS:
+    return libsfp_cal_bias(c, raw);
+  case LIBSFP_CAL_CH_TXPOWER:
+    return libsfp_cal_txpower(c, raw);
+  }
+  return libsfp_cal_rxpower(c, raw);
+}
+
+/* Convert value to raw level (conversion is assumed to be monotonic)\n
+   high: greatest raw not above value, low: least raw not below value */
+static int32_t libsfp_thresh_level(const libsfp_cal_t *c, uint32_t ch,
+                                   float v, int high)
+{
+  int32_t lo = (ch == LIBSFP_CAL_CH_TEMP) ? -32768 : 0;
+  int32_t hi = lo + 65535, m;
+
+  if (high) {
+    if (libsfp_thresh_value(c, ch, lo) > v)
+      return lo - 1;
+    while (lo < hi) {
+      m = lo + (hi - lo + 1)/2;
+      if (libsfp_thresh_value(c, ch, m) <= v)
+        lo = m;
+      else
+        hi = m - 1;
+    }
+  } else {
+    if (libsfp_thresh_value(c, ch, hi) < v)
+      return hi + 1;
+    while (lo < hi) {
+      m = lo + (hi - lo)/2;
+      if (libsfp_thresh_value(c, ch, m) >= v)
+        hi = m;
+      else
+        lo = m + 1;
+    }
+  }
+
+  return lo;
+}
+
+/**
+ * @brief Init thresholds from A2 bank (no hysteresis and debounce)
+ * @param t   - thresholds
+ * @param th  - thresholds section of A2 bank
+ * @return 0 on success
+ */
+int libsfp_thresh_init(libsfp_thresh_t *t, const libsfp_thresholds_fields_t *th)
+{
+  const libsfp_u16_field_t *f = &th->temp_alarm_high;
+  uint32_t ch, cond;
+
+  /* A2 thresholds are in the same (raw) domain as diagnostics */
+  for (ch = 0; ch < LIBSFP_CAL_CHANNELS; ++ch)
+    for (cond = 0; cond < 4; ++cond, ++f)
+      t->set[ch][cond] = t->clr[ch][cond] = libsfp_thresh_raw(ch, *f);
+
+  t->mask = (1u << LIBSFP_THRESH_BITS) - 1;
+  t->debounce = 1;
+
+  return 0;
+}
+
+/**
+ * @brief Init thresholds from module
+ * @param h  - library handle
+ * @param t  - thresholds
+ * @return 0 on success
+ */
+int libsfp_get_thresh(libsfp_t *h, libsfp_thresh_t *t)
+{
+  libsfp_thresholds_fields_t th;
+
+  if (READSTATIC_A2(h, LIBSFP_OFS_A2_AW_THRESHOLDS, sizeof(th), &th))
+    return -1;
+
+  return libsfp_thresh_init(t, &th);
+}
+
+/**
+ * @brief Set threshold (operator override)
+ * @param t     - thresholds
+ * @param c     - calibration of module
+ * @param ch    - channel see LIBSFP_CAL_CH_*
+ * @param cond  - condition see LIBSFP_THRESH_*
+ * @param v     - threshold value (C, V, mA, mW)
+ * @return 0 on success
+ */
+int libsfp_thresh_set(libsfp_thresh_t *t, const libsfp_cal_t *c,
+                      uint32_t ch, uint32_t cond, float v)
+{
+  if ((ch >= LIBSFP_CAL_CHANNELS) || (cond > LIBSFP_THRESH_WARN_LOW))
+    return -1;
+
+  t->set[ch][cond] = t->clr[ch][cond] =
+    libsfp_thresh_level(c, ch, v, !(cond & 1));
+
+  return 0;
+}
+
+/**
+ * @brief Set hysteresis of channel thresholds\n
+ *        (call after thresholds of channel are set)
+ * @param t     - thresholds
+ * @param c     - calibration of module
+ * @param ch    - channel see LIBSFP_CAL_CH_*
+ * @param hyst  - hysteresis (C, V, mA, mW)
+ * @return 0 on success
+ */
+int libsfp_thresh_set_hysteresis(libsfp_thresh_t *t, const libsfp_cal_t *c,
+                                 uint32_t ch, float hyst)
+{
+  int32_t lo = (ch == LIBSFP_CAL_CH_TEMP) ? -32768 : 0;
+  int32_t set, clr;
+  uint32_t cond;
+  float v;
+
+  if (ch >= LIBSFP_CAL_CHANNELS)
+    return -1;
+
+  for (cond = 0; cond < 4; ++cond) {
+
+    set = t->set[ch][cond];
+    clr = set;
+
+    /* Thresholds out of raw range have no hysteresis */
+    if ((set >= lo) && (set <= lo + 65535)) {
+      v = libsfp_thresh_value(c, ch, set);
+      if (cond & 1) {
+        clr = libsfp_thresh_level(c, ch, v + hyst, 0);
+        if (clr < set)
+          clr = set;
+      } else {
+        clr = libsfp_thresh_level(c, ch, v - hyst, 1);
+        if (clr > set)
+          clr = set;
+      }
+    }
+
+    t->clr[ch][cond] = clr;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Set debounce of thresholds
+ * @param t         - thresholds
+ * @param debounce  - samples in a row to change condition
+ *                    (1 - no debounce, up to 255)
+ * @return 0 on success
+ */
+int libsfp_thresh_set_debounce(libsfp_thresh_t *t, uint32_t debounce)
+{
+  if ((!debounce) || (debounce > 255))
+    return -1;
+
+  t->debounce = debounce;
+
+  return 0;
+}
+
+/* Active conditions: levels of conditions from state are clear levels */
+static uint32_t libsfp_thresh_active(const libsfp_thresh_t *t, uint32_t state,
+                                     const libsfp_rtdiagnostics_fields_t *dg)
+{
+  const libsfp_u16_field_t *f = &dg->temperature;
+  const int32_t *l;
+  uint32_t ch, bit, m = 0;
+  int32_t v;
+
+  for (ch = 0; ch < LIBSFP_CAL_CHANNELS; ++ch) {
+
+    v = libsfp_thresh_raw(ch, f[ch]);
+    bit = ch*4;
+
+    l = (state & (1u << (bit + 0))) ? t->clr[ch] : t->set[ch];
+    m |= (uint32_t)(v > l[LIBSFP_THRESH_ALARM_HIGH]) << (bit + 0);
+    l = (state & (1u << (bit + 1))) ? t->clr[ch] : t->set[ch];
+    m |= (uint32_t)(v < l[LIBSFP_THRESH_ALARM_LOW]) << (bit + 1);
+    l = (state & (1u << (bit + 2))) ? t->clr[ch] : t->set[ch];
+    m |= (uint32_t)(v > l[LIBSFP_THRESH_WARN_HIGH]) << (bit + 2);
+    l = (state & (1u << (bit + 3))) ? t->clr[ch] : t->set[ch];
+    m |= (uint32_t)(v < l[LIBSFP_THRESH_WARN_LOW]) << (bit + 3);
+  }
+
+  return m & t->mask;
+}
+
+/**
+ * @brief Classify sample without hysteresis and debounce
+ * @param t   - thresholds
+ * @param dg  - diagnostics section as read from module
+ * @return condition bits
+ */
+uint32_t libsfp_thresh_check(const libsfp_thresh_t *t,
+                             const libsfp_rtdiagnostics_fields_t *dg)
+{
+  return libsfp_thresh_active(t, 0, dg);
+}
+
+/**
+ * @brief Classify sample of port and update its state
+ * @param t   - thresholds
+ * @param s   - port state (zero filled at start)
+ * @param dg  - diagnostics section as read from module
+ * @return reported condition bits
+ */
+uint32_t libsfp_thresh_eval(const libsfp_thresh_t *t, libsfp_thresh_state_t *s,
+                            const libsfp_rtdiagnostics_fields_t *dg)
+{
+  uint32_t diff, bit, i;
+
+  diff = libsfp_thresh_active(t, s->state, dg) ^ s->state;
+
+  /* Conditions that match state restart debounce */
+  for (i = 0; i < LIBSFP_THRESH_BITS; ++i) {
+
+    bit = 1u << i;
+
+    if (!(diff & bit)) {
+      s->cnt[i] = 0;
+      continue;
+    }
+
+    if (++s->cnt[i] >= t->debounce) {
+      s->state ^= bit;
+      s->cnt[i] = 0;
+    }
+  }
+
+  return s->state;
+}
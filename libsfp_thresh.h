@@ -0,0 +1,126 @@
+#ifndef LIBSFP_THRESH_H__
+#define LIBSFP_THRESH_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (software alarm and warning thresholds evaluation)
+
+   Thresholds (from A2 bank or set by operator in C, V, mA, mW) are
+   converted once to raw A/D domain, then every sample is classified
+   by integer compares only. Condition is cleared when value returns
+   beyond threshold by hysteresis and is changed only after it is
+   seen in debounce number of samples in a row.
+
+   Condition bits: channel*4 + condition, channels are LIBSFP_CAL_CH_*,
+   conditions are LIBSFP_THRESH_ALARM_HIGH ... LIBSFP_THRESH_WARN_LOW
+   (same order as thresholds in A2 bank).
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libsfp.h>
+#include <libsfp_cal.h>
+
+/* Conditions */
+#define LIBSFP_THRESH_ALARM_HIGH  0
+#define LIBSFP_THRESH_ALARM_LOW   1
+#define LIBSFP_THRESH_WARN_HIGH   2
+#define LIBSFP_THRESH_WARN_LOW    3
+
+#define LIBSFP_THRESH_BITS  (LIBSFP_CAL_CHANNELS*4)   /**< Number of condition bits */
+
+/** Condition bit of channel */
+#define LIBSFP_THRESH_BIT(ch, cond)  (1u << ((ch)*4 + (cond)))
+
+/** Compiled thresholds (raw domain, signed for temperature) */
+typedef struct {
+  int32_t set[LIBSFP_CAL_CHANNELS][4];  /** Levels that set condition */
+  int32_t clr[LIBSFP_CAL_CHANNELS][4];  /** Levels that clear condition */
+  uint32_t mask;                        /** Enabled condition bits */
+  uint8_t debounce;                     /** Samples in a row to change
+                                            condition (1 - no debounce,
+                                            default) */
+} libsfp_thresh_t;
+
+/** Per port evaluation state */
+typedef struct {
+  uint32_t state;                       /** Reported condition bits */
+  uint8_t cnt[LIBSFP_THRESH_BITS];      /** Debounce counters */
+} libsfp_thresh_state_t;
+
+/**
+ * @brief Init thresholds from A2 bank (no hysteresis and debounce)
+ * @param t   - thresholds
+ * @param th  - thresholds section of A2 bank
+ * @return 0 on success
+ */
+int libsfp_thresh_init(libsfp_thresh_t *t, const libsfp_thresholds_fields_t *th);
+
+/**
+ * @brief Init thresholds from module
+ * @param h  - library handle
+ * @param t  - thresholds
+ * @return 0 on success
+ */
+int libsfp_get_thresh(libsfp_t *h, libsfp_thresh_t *t);
+
+/**
+ * @brief Set threshold (operator override)
+ * @param t     - thresholds
+ * @param c     - calibration of module
+ * @param ch    - channel see LIBSFP_CAL_CH_*
+ * @param cond  - condition see LIBSFP_THRESH_*
+ * @param v     - threshold value (C, V, mA, mW)
+ * @return 0 on success
+ */
+int libsfp_thresh_set(libsfp_thresh_t *t, const libsfp_cal_t *c,
+                      uint32_t ch, uint32_t cond, float v);
+
+/**
+ * @brief Set hysteresis of channel thresholds\n
+ *        (call after thresholds of channel are set)
+ * @param t     - thresholds
+ * @param c     - calibration of module
+ * @param ch    - channel see LIBSFP_CAL_CH_*
+ * @param hyst  - hysteresis (C, V, mA, mW)
+ * @return 0 on success
+ */
+int libsfp_thresh_set_hysteresis(libsfp_thresh_t *t, const libsfp_cal_t *c,
+                                 uint32_t ch, float hyst);
+
+/**
+ * @brief Set debounce of thresholds
+ * @param t         - thresholds
+ * @param debounce  - samples in a row to change condition
+ *                    (1 - no debounce, up to 255)
+ * @return 0 on success
+ */
+int libsfp_thresh_set_debounce(libsfp_thresh_t *t, uint32_t debounce);
+
+/**
+ * @brief Classify sample without hysteresis and debounce
+ * @param t   - thresholds
+ * @param dg  - diagnostics section as read from module
+ * @return condition bits
+ */
+uint32_t libsfp_thresh_check(const libsfp_thresh_t *t,
+                             const libsfp_rtdiagnostics_fields_t *dg);
+
+/**
+ * @brief Classify sample of port and update its state
+ * @param t   - thresholds
+ * @param s   - port state (zero filled at start)
+ * @param dg  - diagnostics section as read from module
+ * @return reported condition bits
+ */
+uint32_t libsfp_thresh_eval(const libsfp_thresh_t *t, libsfp_thresh_state_t *s,
+                            const libsfp_rtdiagnostics_fields_t *dg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -130,6 +130,12 @@ typedef struct {
   uint8_t vendor_control[8];
 } __attribute__((packed)) libsfp_A2_t;
 
+/** Struct to present full module memory (both banks) */
+typedef struct {
+  libsfp_A0_t a0;                       /** A0 bank */
+  libsfp_A2_t a2;                       /** A2 bank */
+} __attribute__((packed)) libsfp_dump_t;
+
 
 
 #endif
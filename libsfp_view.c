@@ -0,0 +1,158 @@
+/**
+   @file
+   @brief libsfp lazy decoded view of module memory
+*/
+
+#include <string.h>
+#include "libsfp_int.h"
+#include "libsfp_view.h"
+
+_Static_assert(LIBSFP_FIELD_COUNT <= 64, "view bitmap is too small");
+
+/* Field IDs in dense order */
+#define LIBSFP_VIEW_ID(name, id, ...) id,
+static const uint16_t libsfp_view_ids[LIBSFP_FIELD_COUNT] = {
+  LIBSFP_FIELDS(LIBSFP_VIEW_ID)
+};
+#undef LIBSFP_VIEW_ID
+
+/**
+ * @brief Init view over raw bank buffers
+ * @param v   - view
+ * @param a0  - A0 bank data (at least 96 bytes)
+ * @param a2  - A2 bank data (at least 128 bytes) or 0
+ * @return 0 on success
+ */
+int libsfp_view_init(libsfp_view_t *v, const uint8_t *a0, const uint8_t *a2)
+{
+  v->a0 = a0;
+  v->a2 = a2;
+  v->ddm_only = 0;
+  v->valid = 0;
+  return 0;
+}
+
+/**
+ * @brief Init view over module memory dump\n
+ *        (A2 fields are present while A0 diagnostic monitoring type
+ *        reports DDM, refresh of the type drops decoded A2 fields)
+ * @param v     - view
+ * @param dump  - module memory (see libsfp_readinfo)
+ * @return 0 on success
+ */
+int libsfp_view_init_dump(libsfp_view_t *v, const libsfp_dump_t *dump)
+{
+  libsfp_view_init(v, (const uint8_t*)&dump->a0, (const uint8_t*)&dump->a2);
+  v->ddm_only = 1;
+  return 0;
+}
+
+/**
+ * @brief Get field value (decoded on first access)
+ * @param v   - view
+ * @param id  - field ID see LIBSFP_FIELD_*
+ * @return value or 0 if field is unknown or its bank is not present
+ */
+const libsfp_field_value_t *libsfp_view_get(libsfp_view_t *v, uint32_t id)
+{
+  const libsfp_field_desc_t *fd;
+  const libsfp_calibration_fields_t *cal = 0;
+  const uint8_t *bank;
+  uint8_t dmtype = 0;
+  int slot;
+
+  slot = libsfp_field_slot(id);
+  if (slot < 0)
+    return 0;
+
+  if (v->valid & (1ULL << slot))
+    return &v->values[slot];
+
+  fd = libsfp_field_desc(id);
+  bank = (fd->bank == LIBSFP_FIELD_BANK_A0) ? v->a0 : v->a2;
+  if (!bank)
+    return 0;
+
+  if (fd->bank == LIBSFP_FIELD_BANK_A2)
+    dmtype = libsfp_quirk_dmtype((const libsfp_A0_t*)v->a0);
+
+  if (v->ddm_only && (fd->bank == LIBSFP_FIELD_BANK_A2) &&
+      (!(dmtype & LIBSFP_A0_DIAGMON_TYPE_DDM)))
+    return 0;
+
+  if (libsfp_field_is_calibrated(fd) && (dmtype & LIBSFP_A0_DIAGMON_TYPE_EXCAL))
+    cal = (const libsfp_calibration_fields_t*)
+          (v->a2 + LIBSFP_OFS_A2_EXT_CAL_CONSTANTS);
+
+  libsfp_field_decode(fd, bank + fd->ofs, cal, &v->values[slot]);
+  v->valid |= 1ULL << slot;
+
+  return &v->values[slot];
+}
+
+static int libsfp_view_overlap(uint16_t ofs1, uint16_t len1,
+                               uint16_t ofs2, uint16_t len2)
+{
+  return (ofs1 < ofs2 + len2) && (ofs2 < ofs1 + len1);
+}
+
+/* Check that A0 bytes hold diagnostic monitoring type (or vendor OUI
+ * and part number which select module quirks of the type) */
+static int libsfp_view_dmtype(uint16_t ofs, uint16_t len)
+{
+  return libsfp_view_overlap(LIBSFP_OFS_A0_DIAGMON_TYPE,
+                             LIBSFP_LEN_A0_DIAGMON_TYPE, ofs, len) ||
+         libsfp_view_overlap(LIBSFP_OFS_A0_VENDOR_OUI,
+                             LIBSFP_LEN_A0_VENDOR_OUI +
+                             LIBSFP_LEN_A0_VENDOR_PN, ofs, len);
+}
+
+/* Check that field value depends on bytes of bank */
+static int libsfp_view_depends(const libsfp_view_t *v,
+                               const libsfp_field_desc_t *fd, uint8_t bank,
+                               uint16_t ofs, uint16_t len)
+{
+  if ((fd->bank == bank) && libsfp_view_overlap(fd->ofs, fd->len, ofs, len))
+    return 1;
+
+  /* Presence of A2 bank of dump depends on DDM bit of the type */
+  if (v->ddm_only && (fd->bank == LIBSFP_FIELD_BANK_A2) &&
+      (bank == LIBSFP_FIELD_BANK_A0) && libsfp_view_dmtype(ofs, len))
+    return 1;
+
+  if (!libsfp_field_is_calibrated(fd))
+    return 0;
+
+  /* Calibrated values also depend on calibration type and constants */
+  if (bank == LIBSFP_FIELD_BANK_A0)
+    return libsfp_view_dmtype(ofs, len);
+
+  return libsfp_view_overlap(LIBSFP_OFS_A2_EXT_CAL_CONSTANTS,
+                             LIBSFP_LEN_A2_EXT_CAL_CONSTANTS, ofs, len);
+}
+
+/**
+ * @brief Drop decoded values that depend on refreshed bytes
+ * @param v     - view
+ * @param bank  - bank see LIBSFP_FIELD_BANK_*
+ * @param ofs   - offset of refreshed bytes
+ * @param len   - number of refreshed bytes
+ * @return 0 on success
+ */
+int libsfp_view_invalidate(libsfp_view_t *v, uint8_t bank,
+                           uint16_t ofs, uint16_t len)
+{
+  uint64_t valid = v->valid;
+  int slot;
+
+  while (valid) {
+    slot = __builtin_ctzll(valid);
+    valid &= valid - 1;
+
+    if (libsfp_view_depends(v, libsfp_field_desc(libsfp_view_ids[slot]),
+                            bank, ofs, len))
+      v->valid &= ~(1ULL << slot);
+  }
+
+  return 0;
+}
@@ -0,0 +1,73 @@
+#ifndef LIBSFP_VIEW_H__
+#define LIBSFP_VIEW_H__
+
+/**
+   @file
+   @brief libsfp public header file \n
+          (lazy decoded view of module memory)
+
+   View decodes field (see libsfp_fields.h) on first access and keeps
+   decoded value until bytes it depends on are invalidated. View does
+   not copy bank data: buffers must stay valid while view is used.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libsfp_fields.h>
+
+/** Lazy view of module memory\n
+ *  Do not access members directly
+ */
+typedef struct {
+  const uint8_t *a0;        /** A0 bank data */
+  const uint8_t *a2;        /** A2 bank data or 0 */
+  uint32_t ddm_only;        /** A2 bank is present only while A0 reports DDM */
+  uint64_t valid;           /** Bitmap of decoded fields (dense numbers) */
+  libsfp_field_value_t values[LIBSFP_FIELD_COUNT];  /** Decoded values */
+} libsfp_view_t;
+
+/**
+ * @brief Init view over raw bank buffers
+ * @param v   - view
+ * @param a0  - A0 bank data (at least 96 bytes)
+ * @param a2  - A2 bank data (at least 128 bytes) or 0
+ * @return 0 on success
+ */
+int libsfp_view_init(libsfp_view_t *v, const uint8_t *a0, const uint8_t *a2);
+
+/**
+ * @brief Init view over module memory dump\n
+ *        (A2 fields are present while A0 diagnostic monitoring type
+ *        reports DDM, refresh of the type drops decoded A2 fields)
+ * @param v     - view
+ * @param dump  - module memory (see libsfp_readinfo)
+ * @return 0 on success
+ */
+int libsfp_view_init_dump(libsfp_view_t *v, const libsfp_dump_t *dump);
+
+/**
+ * @brief Get field value (decoded on first access)
+ * @param v   - view
+ * @param id  - field ID see LIBSFP_FIELD_*
+ * @return value or 0 if field is unknown or its bank is not present
+ */
+const libsfp_field_value_t *libsfp_view_get(libsfp_view_t *v, uint32_t id);
+
+/**
+ * @brief Drop decoded values that depend on refreshed bytes
+ * @param v     - view
+ * @param bank  - bank see LIBSFP_FIELD_BANK_*
+ * @param ofs   - offset of refreshed bytes
+ * @param len   - number of refreshed bytes
+ * @return 0 on success
+ */
+int libsfp_view_invalidate(libsfp_view_t *v, uint8_t bank,
+                           uint16_t ofs, uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,458 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "libsfp.h"
+#include "libsfp_cal.h"
+#include "libsfp_dbm.h"
+#include "libsfp_sink.h"
+#include "libsfp_json.h"
+#include "libsfp_metrics.h"
+#include "libsfp_cbor.h"
+
+/* Benchmark of float and fixed point DDM conversions
+ * (build with "make sfp-bench") */
+
+#define ROUNDS 64
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec*1e9 + ts.tv_nsec;
+}
+
+/* Sample external calibration: slopes/offsets and RX polynomial */
+static void make_cal(libsfp_calibration_fields_t *cl)
+{
+  /* Rx_PWR(4..0) = 0, 0, 1e-6, 0.95, 2.5 */
+  const uint32_t rx[5] = {0x00000000, 0x00000000, 0x358637BD,
+                          0x3F733333, 0x40200000};
+  libsfp_u16_field_t *f = &cl->txi_slope;
+  const uint16_t so[8] = {0x0100, 0x0010, 0x0110, 0xFFF0,
+                          0x00FF, 0x0080, 0x0101, 0x0000};
+  int i;
+
+  memset(cl, 0, sizeof(*cl));
+
+  for (i = 0; i < 5; ++i) {
+    cl->rx_pwr[i].d[0] = rx[i] >> 24;
+    cl->rx_pwr[i].d[1] = rx[i] >> 16;
+    cl->rx_pwr[i].d[2] = rx[i] >> 8;
+    cl->rx_pwr[i].d[3] = rx[i];
+  }
+
+  for (i = 0; i < 8; ++i) {
+    f[i].d[0] = so[i] >> 8;
+    f[i].d[1] = so[i];
+  }
+}
+
+/* Exact RX power (nW) for checking rounding of fixed point path */
+static double rx_exact(const libsfp_calibration_fields_t *cl, uint32_t raw)
+{
+  union { uint32_t u; float f; } v;
+  double p = 0;
+  int i;
+
+  if (!cl)
+    return raw*100.0;
+
+  for (i = 0; i < 5; ++i) {
+    v.u = ((uint32_t)cl->rx_pwr[i].d[0] << 24) | (cl->rx_pwr[i].d[1] << 16) |
+          (cl->rx_pwr[i].d[2] << 8) | cl->rx_pwr[i].d[3];
+    p = p*raw + v.f;
+  }
+
+  return p*100.0;
+}
+
+static void bench(const char *name, const libsfp_calibration_fields_t *cl)
+{
+  libsfp_cal_t c;
+  libsfp_calfx_t cx;
+  double t0, tf, tx, d, maxd[5] = {0, 0, 0, 0, 0};
+  volatile float fsum = 0;
+  volatile int32_t isum = 0;
+  uint32_t raw;
+  int r;
+
+  libsfp_cal_init(&c, cl);
+  libsfp_calfx_init(&cx, cl);
+
+  t0 = now_ns();
+  for (r = 0; r < ROUNDS; ++r)
+    for (raw = 0; raw < 65536; ++raw)
+      fsum += libsfp_cal_temp(&c, raw) + libsfp_cal_voltage(&c, raw) +
+              libsfp_cal_bias(&c, raw) + libsfp_cal_txpower(&c, raw) +
+              libsfp_cal_rxpower(&c, raw);
+  tf = now_ns() - t0;
+
+  t0 = now_ns();
+  for (r = 0; r < ROUNDS; ++r)
+    for (raw = 0; raw < 65536; ++raw)
+      isum += libsfp_calfx_temp(&cx, raw) + libsfp_calfx_voltage(&cx, raw) +
+              libsfp_calfx_bias(&cx, raw) + libsfp_calfx_txpower(&cx, raw) +
+              libsfp_calfx_rxpower(&cx, raw);
+  tx = now_ns() - t0;
+
+  /* Max difference in units of fixed point result
+   * (RX power against exact value) */
+  for (raw = 0; raw < 65536; ++raw) {
+    d = libsfp_calfx_temp(&cx, raw) - libsfp_cal_temp(&c, raw)*1e3;
+    if (d*d > maxd[0]*maxd[0]) maxd[0] = d;
+    d = libsfp_calfx_voltage(&cx, raw) - libsfp_cal_voltage(&c, raw)*1e6;
+    if (d*d > maxd[1]*maxd[1]) maxd[1] = d;
+    d = libsfp_calfx_bias(&cx, raw) - libsfp_cal_bias(&c, raw)*1e3;
+    if (d*d > maxd[2]*maxd[2]) maxd[2] = d;
+    d = libsfp_calfx_txpower(&cx, raw) - libsfp_cal_txpower(&c, raw)*1e6;
+    if (d*d > maxd[3]*maxd[3]) maxd[3] = d;
+    d = libsfp_calfx_rxpower(&cx, raw) - rx_exact(cl, raw);
+    if (d*d > maxd[4]*maxd[4]) maxd[4] = d;
+  }
+
+  printf("%s calibration:\n", name);
+  printf("  float : %6.2f ns/sample (5 channels)\n", tf/(ROUNDS*65536.0));
+  printf("  fixed : %6.2f ns/sample (5 channels)\n", tx/(ROUNDS*65536.0));
+  printf("  max diff: temp %.3f mC, vcc %.3f uV, bias %.3f uA, "
+         "tx %.3f nW, rx %.3f nW (exact)\n",
+         maxd[0], maxd[1], maxd[2], maxd[3], maxd[4]);
+}
+
+static void bench_dbm(void)
+{
+  static float mw[65536], dbm[65536];
+  static int32_t mdbm[65536];
+  static libsfp_u16_field_t raw[65536];
+  double t0, tl, tf, tx, d, maxf = 0, maxx = 0;
+  volatile float fsum = 0;
+  uint32_t i;
+  int r;
+
+  for (i = 0; i < 65536; ++i) {
+    mw[i] = i*0.0001f;
+    raw[i].d[0] = i >> 8;
+    raw[i].d[1] = i;
+  }
+
+  t0 = now_ns();
+  for (r = 0; r < ROUNDS; ++r)
+    for (i = 1; i < 65536; ++i)
+      fsum += 10.0f*log10f(mw[i]);
+  tl = now_ns() - t0;
+
+  t0 = now_ns();
+  for (r = 0; r < ROUNDS; ++r)
+    libsfp_dbm_batch(mw, dbm, 65536);
+  tf = now_ns() - t0;
+
+  t0 = now_ns();
+  for (r = 0; r < ROUNDS; ++r)
+    libsfp_raw2mdbm_batch(raw, mdbm, 65536);
+  tx = now_ns() - t0;
+
+  /* Error against libm */
+  for (i = 1; i < 65536; ++i) {
+    d = fabs(dbm[i] - 10.0*log10(mw[i]));
+    if (d > maxf) maxf = d;
+    d = fabs(mdbm[i] - 10000.0*log10(i*0.0001));
+    if (d > maxx) maxx = d;
+  }
+
+  printf("dBm conversion:\n");
+  printf("  log10f: %6.2f ns/sample\n", tl/(ROUNDS*65535.0));
+  printf("  float : %6.2f ns/sample, max error %.6f dB\n",
+         tf/(ROUNDS*65536.0), maxf);
+  printf("  fixed : %6.2f ns/sample, max error %.3f milli-dB\n",
+         tx/(ROUNDS*65536.0), maxx);
+}
+
+#define PORTS 10000
+
+static void bench_batch(const libsfp_calibration_fields_t *cl)
+{
+  static const char *names[] = {"auto", "scalar", "sse2", "avx2", "neon"};
+  static libsfp_cal_t cal[PORTS];
+  static libsfp_u16_field_t raw[LIBSFP_CAL_CHANNELS][PORTS];
+  static float ref[LIBSFP_CAL_CHANNELS][PORTS], res[LIBSFP_CAL_CHANNELS][PORTS];
+  const libsfp_u16_field_t *rp[LIBSFP_CAL_CHANNELS];
+  float *refp[LIBSFP_CAL_CHANNELS], *resp[LIBSFP_CAL_CHANNELS];
+  double t0, t;
+  uint32_t i, ch, impl, seed = 1;
+  int r, c;
+
+  for (ch = 0; ch < LIBSFP_CAL_CHANNELS; ++ch) {
+    for (i = 0; i < PORTS; ++i) {
+      seed = seed*1103515245 + 12345;
+      raw[ch][i].d[0] = seed >> 24;
+      raw[ch][i].d[1] = seed >> 16;
+    }
+    rp[ch] = raw[ch];
+    refp[ch] = ref[ch];
+    resp[ch] = res[ch];
+  }
+
+  for (i = 0; i < PORTS; ++i)
+    libsfp_cal_init(&cal[i], (i & 1) ? cl : 0);
+
+  printf("Batch conversion (%u ports, 5 channels):\n", PORTS);
+
+  for (c = 0; c < 2; ++c) {
+
+    libsfp_cal_batch_set_impl(LIBSFP_CAL_IMPL_SCALAR);
+    libsfp_cal_batch(c ? cal : 0, rp, refp, PORTS);
+
+    for (impl = LIBSFP_CAL_IMPL_SCALAR; impl <= LIBSFP_CAL_IMPL_NEON; ++impl) {
+
+      if (libsfp_cal_batch_set_impl(impl))
+        continue;
+
+      memset(res, 0, sizeof(res));
+
+      t0 = now_ns();
+      for (r = 0; r < ROUNDS; ++r)
+        libsfp_cal_batch(c ? cal : 0, rp, resp, PORTS);
+      t = now_ns() - t0;
+
+      printf("  %-6s: %8.2f us (%s calibration), %s\n", names[impl],
+             t/(ROUNDS*1e3), c ? "per port" : "internal",
+             memcmp(res, ref, sizeof(res)) ? "MISMATCH" : "identical");
+    }
+  }
+
+  libsfp_cal_batch_set_impl(LIBSFP_CAL_IMPL_AUTO);
+}
+
+/* Module image served by read callback */
+static uint8_t image[2][256];
+
+static int read_image(void *udata, uint8_t addr, uint16_t start,
+                      uint16_t count, void *data)
+{
+  memcpy(data, &image[addr != LIBSFP_DEF_A0_ADDRESS][start], count);
+  return 0;
+}
+
+static void make_image(const libsfp_calibration_fields_t *cl)
+{
+  libsfp_A0_t *a0 = (libsfp_A0_t*)image[0];
+  libsfp_A2_t *a2 = (libsfp_A2_t*)image[1];
+  uint32_t i, seed = 7;
+
+  for (i = 0; i < sizeof(image); ++i) {
+    seed = seed*1103515245 + 12345;
+    image[i/256][i%256] = seed >> 24;
+  }
+
+  memcpy(a0->base.vendor_name, "BENCH VENDOR    ", LIBSFP_LEN_A0_VENDOR_NAME);
+  memcpy(a0->base.vendor_pn, "SFP-BENCH-1G    ", LIBSFP_LEN_A0_VENDOR_PN);
+  memcpy(a0->ext.vendor_sn, "0123456789ABCDEF", LIBSFP_LEN_A0_VENDOR_SN);
+  memcpy(a0->ext.date_code, "24010100", sizeof(a0->ext.date_code));
+  a0->base.identifier = 0x03;
+  a0->ext.diag_mon_type = LIBSFP_A0_DIAGMON_TYPE_DDM | LIBSFP_A0_DIAGMON_TYPE_EXCAL;
+  a2->cl = *cl;
+}
+
+static int discard(void *udata, const char *data, size_t len)
+{
+  *(size_t*)udata += len;
+  return 0;
+}
+
+/* NDJSON of many modules from memory (no module reads) */
+static void bench_json(void)
+{
+  libsfp_dump_t dump;
+  libsfp_sink_t *s;
+  size_t total = 0;
+  double t0, t;
+  int r;
+
+  s = libsfp_sink_create(256*1024);
+  if (!s)
+    return;
+
+  memcpy(&dump.a0, image[0], sizeof(dump.a0));
+  memcpy(&dump.a2, image[1], sizeof(dump.a2));
+  libsfp_sink_set_flush(s, discard, &total);
+
+  t0 = now_ns();
+  for (r = 0; r < 10000; ++r) {
+    if (libsfp_sink_len(s) > 252*1024)
+      libsfp_sink_flush(s);
+    libsfp_json_dump(s, &dump, r, LIBSFP_JSON_NDJSON);
+  }
+  libsfp_sink_flush(s);
+  t = now_ns() - t0;
+
+  printf("libsfp_json_dump of 10000 modules:\n");
+  printf("  total : %8.2f ms, %.2f us/module, %.0f MB/s\n",
+         t/1e6, t/(10000*1e3), total*1e3/t);
+
+  libsfp_sink_free(s);
+}
+
+/* OpenMetrics scrape of 128 ports (diagnostics change between scrapes) */
+static void bench_metrics(void)
+{
+  libsfp_dump_t dump;
+  libsfp_decoded_t d;
+  libsfp_metrics_t *m;
+  libsfp_sink_t *s;
+  char *buf;
+  size_t size;
+  double t0, t;
+  uint32_t i;
+  int r;
+
+  memcpy(&dump.a0, image[0], sizeof(dump.a0));
+  memcpy(&dump.a2, image[1], sizeof(dump.a2));
+  libsfp_decode(&dump, &d);
+
+  m = libsfp_metrics_create(128);
+  if (!m)
+    return;
+
+  for (i = 0; i < 128; ++i)
+    libsfp_metrics_set(m, i, &d);
+
+  size = libsfp_metrics_size(m);
+  buf = malloc(size);
+  s = (buf) ? libsfp_sink_create_static(buf, size) : 0;
+  if (!s) {
+    free(buf);
+    libsfp_metrics_free(m);
+    return;
+  }
+
+  t0 = now_ns();
+  for (r = 0; r < ROUNDS*16; ++r) {
+    d.values[LIBSFP_DECODED_TEMP] += 0.125f;
+    for (i = 0; i < 128; ++i)
+      libsfp_metrics_set(m, i, &d);
+    libsfp_sink_reset(s);
+    libsfp_metrics_render(m, s);
+  }
+  t = now_ns() - t0;
+
+  printf("libsfp_metrics_render of 128 ports (with 128 updates):\n");
+  printf("  scrape: %8.2f us, %zu bytes\n", t/(ROUNDS*16*1e3), libsfp_sink_len(s));
+
+  libsfp_sink_free(s);
+  free(buf);
+  libsfp_metrics_free(m);
+}
+
+/* CBOR stream of one module: identity record, then samples with
+   changing temperature and rx power */
+static void bench_cbor(void)
+{
+  libsfp_dump_t dump;
+  libsfp_cbor_state_t st;
+  libsfp_cbor_reader_t rd;
+  libsfp_cbor_item_t it;
+  libsfp_sink_t *s;
+  size_t ident;
+  double t0, te, td;
+  uint32_t items = 0;
+  int r;
+
+  s = libsfp_sink_create(10000*LIBSFP_CBOR_MAX);
+  if (!s)
+    return;
+
+  memcpy(&dump.a0, image[0], sizeof(dump.a0));
+  memcpy(&dump.a2, image[1], sizeof(dump.a2));
+
+  libsfp_cbor_identity(s, &dump, 0, &st);
+  ident = libsfp_sink_len(s);
+  libsfp_sink_reset(s);
+
+  t0 = now_ns();
+  for (r = 0; r < 10000; ++r) {
+    dump.a2.dg.temperature.d[1] += 1;
+    dump.a2.dg.rx_power.d[1] += 3;
+    libsfp_cbor_sample(s, &dump, 0, 1700000000000ull + r*1000, &st);
+  }
+  te = now_ns() - t0;
+
+  t0 = now_ns();
+  libsfp_cbor_reader_init(&rd, libsfp_sink_data(s), libsfp_sink_len(s));
+  while (libsfp_cbor_read_record(&rd) > 0)
+    while (!libsfp_cbor_read_item(&rd, &it))
+      ++items;
+  td = now_ns() - t0;
+
+  printf("libsfp_cbor of 10000 samples (2 changed fields):\n");
+  printf("  record: %zu bytes identity, %.1f bytes/sample\n",
+         ident, libsfp_sink_len(s)/10000.0);
+  printf("  encode: %6.2f ns/sample, decode %6.2f ns/sample (%u items)\n",
+         te/10000, td/10000, items);
+
+  libsfp_sink_free(s);
+}
+
+static void bench_print(const libsfp_calibration_fields_t *cl)
+{
+  libsfp_t *h;
+  libsfp_sink_t *s;
+  size_t total = 0;
+  double t0, t;
+  int r;
+
+  make_image(cl);
+
+  h = libsfp_create();
+  s = libsfp_sink_create(0);
+  if ((!h) || (!s))
+    return;
+
+  libsfp_set_readreg_callback(h, read_image);
+  libsfp_set_flags(h, LIBSFP_FLAGS_PRINT_LONGOPT | LIBSFP_FLAGS_PRINT_HEXOUTPUT |
+                      LIBSFP_FLAGS_PRINT_UNKNOWN | LIBSFP_FLAGS_PRINT_CALIBRATIONS |
+                      LIBSFP_FLAGS_PRINT_THRESHOLDS | LIBSFP_FLAGS_PRINT_BITOPTIONS |
+                      LIBSFP_FLAGS_PRINT_CSUM | LIBSFP_FLAGS_PRINT_VENDOR |
+                      LIBSFP_FLAGS_CACHE);
+  libsfp_sink_set_flush(s, discard, &total);
+  libsfp_set_output_sink(h, s);
+
+  t0 = now_ns();
+  for (r = 0; r < ROUNDS*16; ++r)
+    libsfp_showinfo(h);
+  t = now_ns() - t0;
+
+  printf("libsfp_showinfo text (verbose, cached module data):\n");
+  printf("  sink  : %8.2f us/module, %zu bytes\n",
+         t/(ROUNDS*16*1e3), total/(ROUNDS*16));
+
+  total = 0;
+  t0 = now_ns();
+  for (r = 0; r < ROUNDS*16; ++r)
+    libsfp_json_showinfo(h, s, r, LIBSFP_JSON_NDJSON);
+  t = now_ns() - t0;
+
+  printf("  json  : %8.2f us/module, %zu bytes\n",
+         t/(ROUNDS*16*1e3), total/(ROUNDS*16));
+
+  bench_json();
+  bench_metrics();
+  bench_cbor();
+
+  libsfp_sink_free(s);
+  libsfp_free(h);
+}
+
+int main(int argc, char **argv)
+{
+  libsfp_calibration_fields_t cl;
+
+  bench("Internal", 0);
+  make_cal(&cl);
+  bench("External", &cl);
+  bench_dbm();
+  bench_batch(&cl);
+  bench_print(&cl);
+
+  return 0;
+}
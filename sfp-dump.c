@@ -4,6 +4,8 @@
 #include <string.h>
 #include <getopt.h>
 #include "libsfp.h"
+#include "libsfp_sink.h"
+#include "libsfp_json.h"
 
 #define ERR(format, ...) \
    fprintf(stderr, "ERR: "format"\n", ##__VA_ARGS__)
@@ -15,6 +17,7 @@ typedef struct {
   char *file1, *file2;
   uint32_t flags;
   int html;
+  int json;
 } prm_t;
 
 int read_sfp_dump(void *udata, uint8_t bank_addr, uint16_t start,
@@ -80,15 +83,17 @@ int print_help()
   printf("-b -- show bit fields\n");
   printf("-m -- show checksum's field\n");
   printf("-n -- show vendor spec. fields\n");
-  printf("-H -- output in HTML\n\n");
+  printf("-H -- output in HTML\n");
+  printf("-j -- output in JSON (with '-x' adds hex of module memory)\n\n");
 }
 
 int parse_args(int argc, char **argv, prm_t *prm)
 {
    prm->html = 0;
+   prm->json = 0;
   
    int opt;
-   while ((opt = getopt(argc, argv, "hvxuctbsmnH")) != -1) {
+   while ((opt = getopt(argc, argv, "hvxuctbsmnHj")) != -1) {
      switch (opt) {
        case 'h':
          print_help();
@@ -128,6 +133,11 @@ int parse_args(int argc, char **argv, prm_t *prm)
        break;
        case 'H':
          prm->html = 1;
+         prm->json = 0;
+       break;
+       case 'j':
+         prm->json = 1;
+         prm->html = 0;
        break;
        default:
          ERR("Wrong option");
@@ -159,6 +169,7 @@ int main(int argc, char **argv)
   int ret = 0 ;
   prm_t prm;
   libsfp_print_callbacks_t callbacks;
+  libsfp_sink_t *sink = 0;
 
   /* Set default parameters */
   memset(&prm, 0, sizeof(prm));
@@ -186,6 +197,16 @@ int main(int argc, char **argv)
     callbacks.newline = printnewline_html;
     callbacks.value = printvalue_html;
     libsfp_set_print_callbacks( handle, &callbacks );
+  } else {
+    /* Text or JSON goes to stdout with one write */
+    sink = libsfp_sink_create(0);
+    if (!sink) {
+      ERR("Can't create output sink!");
+      ret = -1;
+      goto exit;
+    }
+    libsfp_sink_set_flush(sink, libsfp_sink_flush_file, stdout);
+    libsfp_set_output_sink(handle, sink);
   }
 
   /* Normaly we do not need set this (it's a default values)
@@ -195,7 +216,15 @@ int main(int argc, char **argv)
   */
 
   /* Read and show information */
-  if (libsfp_showinfo(handle)) {
+  if (prm.json) {
+    if (libsfp_json_showinfo(handle, sink, LIBSFP_JSON_NO_PORT,
+                             LIBSFP_JSON_NDJSON |
+                             ((prm.flags & LIBSFP_FLAGS_PRINT_HEXOUTPUT) ?
+                              LIBSFP_JSON_RAW : 0))) {
+      ret = -2;
+      goto exit;
+    }
+  } else if (libsfp_showinfo(handle)) {
     /*ERR("Can't read information!");*/
     ret = -2;
     goto exit;
@@ -208,6 +237,9 @@ exit:
   if (handle)
     libsfp_free(handle);
 
+  if (sink)
+    libsfp_sink_free(sink);
+
   if ( prm.html )
     printf( "</table>\n" );
 
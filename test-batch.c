@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <string.h>
+#include "libsfp.h"
+#include "libsfp_cal.h"
+
+/* Batch conversion: every implementation supported by CPU must give
+ * results bit identical to scalar one */
+
+#define PORTS  65539   /* All raw values and a tail shorter than vector */
+
+static libsfp_cal_t cal[PORTS];
+static libsfp_u16_field_t raw[LIBSFP_CAL_CHANNELS][PORTS];
+static float ref[LIBSFP_CAL_CHANNELS][PORTS], res[LIBSFP_CAL_CHANNELS][PORTS];
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+  seed = seed*1103515245 + 12345;
+  return seed >> 8;
+}
+
+/* Random calibration constants (IEEE coefficients of sane magnitude) */
+static void make_cal(libsfp_calibration_fields_t *cl)
+{
+  uint8_t *b = (uint8_t*)cl;
+  uint32_t i, u;
+
+  for (i = 0; i < sizeof(*cl); ++i)
+    b[i] = rnd();
+
+  for (i = 0; i < 5; ++i) {
+    u = (rnd() & 0x807FFFFF) | ((0x60 + rnd() % 0x20) << 23);
+    cl->rx_pwr[i].d[0] = u >> 24;
+    cl->rx_pwr[i].d[1] = u >> 16;
+    cl->rx_pwr[i].d[2] = u >> 8;
+    cl->rx_pwr[i].d[3] = u;
+  }
+}
+
+int main(void)
+{
+  static const char *names[] = {"auto", "scalar", "sse2", "avx2", "neon"};
+  const libsfp_u16_field_t *rp[LIBSFP_CAL_CHANNELS];
+  float *refp[LIBSFP_CAL_CHANNELS], *resp[LIBSFP_CAL_CHANNELS];
+  libsfp_calibration_fields_t cl;
+  uint32_t i, ch, impl;
+  int c, fails = 0;
+
+  for (ch = 0; ch < LIBSFP_CAL_CHANNELS; ++ch) {
+    for (i = 0; i < PORTS; ++i) {
+      raw[ch][i].d[0] = (i + ch*4099) >> 8;
+      raw[ch][i].d[1] = i + ch*4099;
+    }
+    rp[ch] = raw[ch];
+    refp[ch] = ref[ch];
+    resp[ch] = res[ch];
+  }
+
+  for (i = 0; i < PORTS; ++i) {
+    make_cal(&cl);
+    libsfp_cal_init(&cal[i], (i % 3) ? &cl : 0);
+  }
+
+  for (c = 0; c < 2; ++c) {
+
+    if (libsfp_cal_batch_set_impl(LIBSFP_CAL_IMPL_SCALAR))
+      return 1;
+    libsfp_cal_batch(c ? cal : 0, rp, refp, PORTS);
+
+    for (impl = LIBSFP_CAL_IMPL_AUTO; impl <= LIBSFP_CAL_IMPL_NEON; ++impl) {
+
+      if (libsfp_cal_batch_set_impl(impl)) {
+        printf("SKIP: %s is not supported\n", names[impl]);
+        continue;
+      }
+
+      memset(res, 0, sizeof(res));
+      libsfp_cal_batch(c ? cal : 0, rp, resp, PORTS);
+
+      if (memcmp(res, ref, sizeof(res))) {
+        printf("FAIL: %s differs from scalar (%s calibration)\n",
+               names[impl], c ? "per port" : "internal");
+        ++fails;
+      }
+    }
+  }
+
+  return (fails) ? 1 : 0;
+}
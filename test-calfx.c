@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "libsfp.h"
+#include "libsfp_cal.h"
+
+/* Fixed point DDM conversions against scalar reference
+ * (exact values computed in double precision) */
+
+/* RX polynomials Rx_PWR(4..0) as IEEE-754 words */
+static const uint32_t rx_tbl[][5] = {
+  {0x00000000, 0x00000000, 0x358637BD, 0x3F733333, 0x40200000},
+  {0xB0ABCDEF, 0x2F123456, 0xB5A00000, 0x3F800000, 0xC0200000},
+  {0x00000000, 0x00000000, 0x00000000, 0x3F800000, 0x00000000},
+  {0x00000000, 0x2A000000, 0x00000000, 0x3E4CCCCD, 0x00000000},
+  /* Saturated: large negative and positive coefficients */
+  {0xAEDBE6FF, 0x00000000, 0x00000000, 0xC47A0000, 0x00000000},
+  {0x00000000, 0x00000000, 0x00000000, 0x447A0000, 0xCDEE6B28},
+  {0xF149F2CA, 0x00000000, 0x00000000, 0x00000000, 0x00000000},
+};
+
+/* Slopes and offsets: txi, tx, t, v */
+static const uint16_t so_tbl[][8] = {
+  {0x0100, 0x0010, 0x0110, 0xFFF0, 0x00FF, 0x0080, 0x0101, 0x0000},
+  {0x0080, 0x8000, 0x0200, 0x7FFF, 0xFFFF, 0x0001, 0x0001, 0xFF00},
+};
+
+static void make_cal(libsfp_calibration_fields_t *cl,
+                     const uint32_t *rx, const uint16_t *so)
+{
+  libsfp_u16_field_t *f = &cl->txi_slope;
+  int i;
+
+  memset(cl, 0, sizeof(*cl));
+
+  for (i = 0; i < 5; ++i) {
+    cl->rx_pwr[i].d[0] = rx[i] >> 24;
+    cl->rx_pwr[i].d[1] = rx[i] >> 16;
+    cl->rx_pwr[i].d[2] = rx[i] >> 8;
+    cl->rx_pwr[i].d[3] = rx[i];
+  }
+
+  for (i = 0; i < 8; ++i) {
+    f[i].d[0] = so[i] >> 8;
+    f[i].d[1] = so[i];
+  }
+}
+
+/* Exact linear conversion (raw units), so - slope and offset
+ * or 0 if module is internally calibrated */
+static double lin_exact(const uint16_t *so, int32_t raw)
+{
+  if (!so)
+    return raw;
+
+  return so[0]/256.0*raw + (int16_t)so[1];
+}
+
+/* Exact RX power (nW) */
+static double rx_exact(const uint32_t *rx, uint32_t raw)
+{
+  union { uint32_t u; float f; } v;
+  double p = 0;
+  int i;
+
+  if (!rx)
+    return raw*100.0;
+
+  for (i = 0; i < 5; ++i) {
+    v.u = rx[i];
+    p = p*raw + v.f;
+  }
+
+  return p*100.0;
+}
+
+static int check(const char *name, double maxd, double bound)
+{
+  if (maxd <= bound)
+    return 0;
+
+  printf("FAIL: %s max error %.6f, bound %.6f\n", name, maxd, bound);
+  return 1;
+}
+
+static int test(const uint32_t *rx, const uint16_t *so)
+{
+  libsfp_calibration_fields_t cl;
+  libsfp_calfx_t cx;
+  double ref, maxd[5] = {0, 0, 0, 0, 0};
+  uint32_t raw, sat = 0;
+  int32_t v;
+  int fails = 0;
+
+  if (rx)
+    make_cal(&cl, rx, so);
+
+  libsfp_calfx_init(&cx, (rx) ? &cl : 0);
+
+  for (raw = 0; raw < 65536; ++raw) {
+    ref = lin_exact((so) ? so + 4 : 0, (int16_t)raw)*1000/256;
+    maxd[0] = fmax(maxd[0], fabs(libsfp_calfx_temp(&cx, raw) - ref));
+    maxd[1] = fmax(maxd[1], fabs(libsfp_calfx_voltage(&cx, raw) -
+                                 lin_exact((so) ? so + 6 : 0, raw)*100));
+    maxd[2] = fmax(maxd[2], fabs(libsfp_calfx_bias(&cx, raw) -
+                                 lin_exact((so) ? so + 0 : 0, raw)*2));
+    maxd[3] = fmax(maxd[3], fabs(libsfp_calfx_txpower(&cx, raw) -
+                                 lin_exact((so) ? so + 2 : 0, raw)*100));
+
+    /* Results out of range saturate */
+    ref = rx_exact(rx, raw);
+    v = libsfp_calfx_rxpower(&cx, raw);
+    if (fabs(ref) < INT32_MAX)
+      maxd[4] = fmax(maxd[4], fabs(v - ref));
+    else if (((ref >= INT32_MAX + 1.0) && (v != INT32_MAX)) ||
+             ((ref <= INT32_MIN - 1.0) && (v != INT32_MIN)))
+      ++sat;
+  }
+
+  /* Linear channels are rounded once */
+  fails += check("temp (mC)", maxd[0], 0.5);
+  fails += check("vcc (uV)", maxd[1], 0.5);
+  fails += check("bias (uA)", maxd[2], 0.5);
+  fails += check("tx (nW)", maxd[3], 0.5);
+
+  /* RX power terms keep 16 fraction bits, sum is rounded once */
+  fails += check("rx (nW)", maxd[4], 0.5 + 5.0/65536);
+
+  if (sat) {
+    printf("FAIL: rx (nW) %u values not saturated\n", sat);
+    ++fails;
+  }
+
+  return fails;
+}
+
+int main(void)
+{
+  uint32_t i, j;
+  int fails;
+
+  fails = test(0, 0);
+
+  for (i = 0; i < sizeof(rx_tbl)/sizeof(rx_tbl[0]); ++i)
+    for (j = 0; j < sizeof(so_tbl)/sizeof(so_tbl[0]); ++j)
+      fails += test(rx_tbl[i], so_tbl[j]);
+
+  return (fails) ? 1 : 0;
+}
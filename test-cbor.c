@@ -0,0 +1,293 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libsfp.h"
+#include "libsfp_decode.h"
+#include "libsfp_cbor.h"
+
+/* CBOR records of example dump are read back as encoded, truncated
+ * and malformed input is rejected */
+
+#define PORT  7
+#define TS    1234567890123ull
+
+static libsfp_dump_t dump;
+static libsfp_decoded_t dec;
+
+static int load_dump(void)
+{
+  const char *dir = getenv("srcdir");
+  char path[256];
+  FILE *f;
+  size_t n;
+
+  snprintf(path, sizeof(path), "%s/dumps/example.bin", (dir) ? dir : ".");
+  f = fopen(path, "rb");
+  if (!f) {
+    printf("FAIL: can't open %s\n", path);
+    return -1;
+  }
+
+  n = fread(&dump, 1, sizeof(dump), f);
+  fclose(f);
+
+  if (n != sizeof(dump)) {
+    printf("FAIL: %s is %zu bytes\n", path, n);
+    return -1;
+  }
+
+  return libsfp_decode(&dump, &dec);
+}
+
+static int expect_int(const char *name, const libsfp_cbor_item_t *it, int64_t v)
+{
+  if ((it->type == LIBSFP_CBOR_VAL_INT) && (it->value.i == v))
+    return 0;
+
+  printf("FAIL: %s: type %u value %lld, expected %lld\n", name, it->type,
+         (long long)it->value.i, (long long)v);
+  return 1;
+}
+
+/* Text is sent without trailing spaces */
+static int expect_text(const char *name, const libsfp_cbor_item_t *it, const char *s)
+{
+  size_t n = strlen(s);
+
+  while (n && (s[n - 1] == ' '))
+    --n;
+
+  if ((it->type == LIBSFP_CBOR_VAL_TEXT) && (it->len == n) &&
+      (!memcmp(it->value.s, s, n)))
+    return 0;
+
+  printf("FAIL: %s: type %u \"%.*s\", expected \"%s\"\n", name, it->type,
+         (int)it->len, (const char*)it->value.s, s);
+  return 1;
+}
+
+static int expect_float(const char *name, const libsfp_cbor_item_t *it, float f)
+{
+  if ((it->type == LIBSFP_CBOR_VAL_FLOAT) && (it->value.f == f))
+    return 0;
+
+  printf("FAIL: %s: type %u value %g, expected %g\n", name, it->type,
+         it->value.f, f);
+  return 1;
+}
+
+/* Read record and check its items, found counts checked items */
+static int check_record(libsfp_cbor_reader_t *r, int type, int *items, int *found)
+{
+  libsfp_cbor_item_t it;
+  int n, i, fails = 0;
+
+  *items = *found = 0;
+
+  n = libsfp_cbor_read_record(r);
+  if (n <= 0) {
+    printf("FAIL: record type %d: read_record %d\n", type, n);
+    return 1;
+  }
+
+  *items = n;
+
+  for (i = 0; i < n; ++i) {
+
+    if (libsfp_cbor_read_item(r, &it)) {
+      printf("FAIL: record type %d: item %d of %d\n", type, i, n);
+      return fails + 1;
+    }
+
+    switch (it.key) {
+    case LIBSFP_CBOR_KEY_TYPE:
+      fails += expect_int("record type", &it, type);
+      break;
+    case LIBSFP_CBOR_KEY_PORT:
+      fails += expect_int("port", &it, PORT);
+      break;
+    case LIBSFP_CBOR_KEY_TIMESTAMP:
+      fails += expect_int("timestamp", &it, TS);
+      break;
+    case LIBSFP_FIELD_VENDOR_NAME:
+      fails += expect_text("vendor name", &it, dec.vendor);
+      break;
+    case LIBSFP_FIELD_VENDOR_PN:
+      fails += expect_text("vendor PN", &it, dec.partnum);
+      break;
+    case LIBSFP_FIELD_DIAGMON_TYPE:
+      fails += expect_int("diagnostic monitoring type", &it,
+                          dump.a0.ext.diag_mon_type);
+      break;
+    case LIBSFP_FIELD_TEMPERATURE:
+      fails += expect_float("temperature", &it, dec.values[0]);
+      break;
+    default:
+      continue;
+    }
+
+    ++*found;
+  }
+
+  if (!libsfp_cbor_read_item(r, &it)) {
+    printf("FAIL: record type %d: item past end\n", type);
+    ++fails;
+  }
+
+  return fails;
+}
+
+/* Parse all records: 0 if data is well formed sequence of records,
+ * strings of read items must be inside of input */
+static int parse(const uint8_t *data, size_t len)
+{
+  libsfp_cbor_reader_t r;
+  libsfp_cbor_item_t it;
+  int n;
+
+  libsfp_cbor_reader_init(&r, data, len);
+
+  while ((n = libsfp_cbor_read_record(&r)) > 0)
+    while (n--) {
+      if (libsfp_cbor_read_item(&r, &it))
+        return -1;
+      if ((it.len) && ((it.value.s < data) ||
+                       (it.len > (size_t)(data + len - it.value.s)))) {
+        printf("FAIL: string of key %d is out of input\n", it.key);
+        return 0;
+      }
+    }
+
+  return n;
+}
+
+static int test_roundtrip(void)
+{
+  libsfp_sink_t *s;
+  libsfp_cbor_state_t st;
+  libsfp_cbor_reader_t r;
+  size_t ends[3];
+  const uint8_t *data;
+  size_t len, i, k;
+  int items, found, fails = 0;
+
+  s = libsfp_sink_create(0);
+  if (!s)
+    return 1;
+
+  /* Identity, full sample, sample with changed temperature only */
+  libsfp_cbor_identity(s, &dump, PORT, &st);
+  ends[0] = libsfp_sink_len(s);
+  libsfp_cbor_sample(s, &dump, PORT, TS, &st);
+  ends[1] = libsfp_sink_len(s);
+  dump.a2.dg.temperature.d[1] ^= 0x40;
+  libsfp_decode(&dump, &dec);
+  libsfp_cbor_sample(s, &dump, PORT, TS, &st);
+  ends[2] = libsfp_sink_len(s);
+
+  data = (const uint8_t*)libsfp_sink_data(s);
+  len = libsfp_sink_len(s);
+
+  libsfp_cbor_reader_init(&r, data, len);
+
+  fails += check_record(&r, LIBSFP_CBOR_REC_IDENTITY, &items, &found);
+  if (found != 5) {
+    printf("FAIL: identity record has %d of 5 checked items\n", found);
+    ++fails;
+  }
+
+  /* Skipped rest of record */
+  libsfp_cbor_read_record(&r);
+
+  fails += check_record(&r, LIBSFP_CBOR_REC_SAMPLE, &items, &found);
+  if ((items != 4) || (found != 4)) {
+    printf("FAIL: last sample has %d items (%d checked), expected 4\n",
+           items, found);
+    ++fails;
+  }
+
+  if (libsfp_cbor_read_record(&r)) {
+    printf("FAIL: records past end\n");
+    ++fails;
+  }
+
+  if (parse(data, len)) {
+    printf("FAIL: records are not well formed\n");
+    ++fails;
+  }
+
+  /* Truncated input: only cuts at record ends leave valid sequence */
+  for (i = 1, k = 0; i < len; ++i) {
+
+    if ((k < 3) && (i == ends[k])) {
+      if (parse(data, i)) {
+        printf("FAIL: %zu records are not well formed\n", k + 1);
+        ++fails;
+      }
+      ++k;
+      continue;
+    }
+
+    if (!parse(data, i)) {
+      printf("FAIL: record truncated to %zu of %zu bytes accepted\n", i, len);
+      ++fails;
+    }
+  }
+
+  libsfp_sink_free(s);
+
+  return fails;
+}
+
+static int test_malformed(void)
+{
+  static const struct {
+    const char *name;
+    uint8_t len;
+    uint8_t d[12];
+  } bad[] = {
+    {"not a map",             1, {0x01}},
+    {"array record",          3, {0x81, 0x01, 0x01}},
+    {"text key",              4, {0xA1, 0x61, 'a', 0x01}},
+    {"float key",             4, {0xA1, 0xF9, 0x3C, 0x00}},
+    {"array value",           3, {0xA1, 0x01, 0x80}},
+    {"map value",             3, {0xA1, 0x01, 0xA0}},
+    {"tag value",             4, {0xA1, 0x01, 0xC1, 0x01}},
+    {"simple true value",     3, {0xA1, 0x01, 0xF5}},
+    {"key over 31 bits",      7, {0xA1, 0x1A, 0x80, 0x00, 0x00, 0x00, 0x01}},
+    {"integer over 63 bits", 11, {0xA1, 0x01, 0x3B, 0x80, 0, 0, 0, 0, 0, 0, 0}},
+    {"reserved length",       4, {0xA1, 0x01, 0x1C, 0x00}},
+    {"indefinite string",     5, {0xA1, 0x01, 0x5F, 0x41, 0x00}},
+    {"indefinite map",        4, {0xBF, 0x01, 0x01, 0xFF}},
+    {"string past end",       5, {0xA1, 0x01, 0x43, 'a', 'b'}},
+    {"string length 2^32-1",  8, {0xA1, 0x01, 0x7A, 0xFF, 0xFF, 0xFF, 0xFF, 'a'}},
+    {"string length 2^63",   12, {0xA1, 0x01, 0x5B, 0x80, 0, 0, 0, 0, 0, 0, 0, 'a'}},
+    {"map count past end",    5, {0xA3, 0x01, 0x01, 0x02, 0x02}},
+    {"map count 2^32-1",      9, {0xBA, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x01, 0x02, 0x02}},
+    {"length past end",       4, {0xA1, 0x01, 0x19, 0x01}},
+  };
+  uint32_t i;
+  int fails = 0;
+
+  for (i = 0; i < sizeof(bad)/sizeof(bad[0]); ++i) {
+    if (!parse(bad[i].d, bad[i].len)) {
+      printf("FAIL: %s accepted\n", bad[i].name);
+      ++fails;
+    }
+  }
+
+  return fails;
+}
+
+int main(void)
+{
+  int fails = 0;
+
+  if (load_dump())
+    return 1;
+
+  fails += test_malformed();
+  fails += test_roundtrip();
+
+  return (fails) ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "libsfp.h"
+#include "libsfp_dbm.h"
+
+/* dBm conversions against libm 10*log10 over their input ranges */
+
+static int check(const char *name, double maxd, double bound)
+{
+  if (maxd <= bound)
+    return 0;
+
+  printf("FAIL: %s max error %.6f, bound %.6f\n", name, maxd, bound);
+  return 1;
+}
+
+static float float_of(uint32_t u)
+{
+  float f;
+  memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+/* Float conversion: every value in [1, 2) and every 61st one
+ * from the floor (0.1 uW) up to FLT_MAX */
+static int test_dbm(void)
+{
+  uint32_t u, lo, hi;
+  double maxd = 0;
+  float mw = 1e-4f;
+  int fails = 0;
+
+  memcpy(&lo, &mw, sizeof(lo));
+  hi = 0x7F7FFFFF;
+
+  for (u = 0x3F800000; u < 0x40000000; ++u)
+    maxd = fmax(maxd, fabs(libsfp_dbm(float_of(u)) -
+                           10.0*log10(float_of(u))));
+
+  for (u = lo; u <= hi - 61; u += 61)
+    maxd = fmax(maxd, fabs(libsfp_dbm(float_of(u)) -
+                           10.0*log10(float_of(u))));
+
+  fails += check("dbm (dB)", maxd, 0.0001);
+
+  /* Below floor, zero, negative and NaN */
+  if ((libsfp_dbm(9.99e-5f) != LIBSFP_DBM_FLOOR) ||
+      (libsfp_dbm(0.0f) != LIBSFP_DBM_FLOOR) ||
+      (libsfp_dbm(-1.0f) != LIBSFP_DBM_FLOOR) ||
+      (libsfp_dbm(NAN) != LIBSFP_DBM_FLOOR)) {
+    printf("FAIL: dbm floor\n");
+    ++fails;
+  }
+
+  return fails;
+}
+
+/* Fixed point conversions: every raw value, every nW value up
+ * to 2^24 and every 61st one up to INT32_MAX */
+static int test_mdbm(void)
+{
+  double maxd = 0;
+  int64_t v;
+  int fails = 0;
+
+  for (v = 1; v < 65536; ++v)
+    maxd = fmax(maxd, fabs(libsfp_raw2mdbm(v) - 10000.0*log10(v*1e-4)));
+
+  fails += check("raw2mdbm (milli-dB)", maxd, 1.0);
+
+  maxd = 0;
+  for (v = 100; v < (1 << 24); ++v)
+    maxd = fmax(maxd, fabs(libsfp_nw2mdbm(v) - 10000.0*log10(v*1e-6)));
+  for (; v <= INT32_MAX; v += 61)
+    maxd = fmax(maxd, fabs(libsfp_nw2mdbm(v) - 10000.0*log10(v*1e-6)));
+  maxd = fmax(maxd, fabs(libsfp_nw2mdbm(INT32_MAX) -
+                         10000.0*log10(INT32_MAX*1e-6)));
+
+  fails += check("nw2mdbm (milli-dB)", maxd, 1.0);
+
+  if ((libsfp_raw2mdbm(0) != LIBSFP_MDBM_FLOOR) ||
+      (libsfp_nw2mdbm(99) != LIBSFP_MDBM_FLOOR) ||
+      (libsfp_nw2mdbm(-1) != LIBSFP_MDBM_FLOOR)) {
+    printf("FAIL: mdbm floor\n");
+    ++fails;
+  }
+
+  return fails;
+}
+
+int main(void)
+{
+  int fails = 0;
+
+  fails += test_dbm();
+  fails += test_mdbm();
+
+  return (fails) ? 1 : 0;
+}
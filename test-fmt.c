@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include "libsfp_int.h"
+
+/* Locale-free fixed point formatting against printf "%.*f" */
+
+static const float edge[] = {
+  0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 1.5f, 2.5f, -2.5f, 0.125f, 0.375f,
+  9.9995f, 9.99949f, 99.995f, 0.05f, 0.15f, 0.25f, 0.35f, 1e-5f, -1e-5f,
+  123456.789f, 16777215.0f, 16777216.0f, 1099511627776.0f,
+  2199023255552.0f, 1e20f, -3e38f, FLT_MAX, -FLT_MAX, FLT_MIN,
+  FLT_TRUE_MIN, -FLT_TRUE_MIN, 1e-30f
+};
+
+static int check(float v, uint8_t prec)
+{
+  char exp[LIBSFP_FMT_FLOAT_MAX*2], got[LIBSFP_FMT_FLOAT_MAX + 1], *end;
+
+  snprintf(exp, sizeof(exp), "%.*f", prec, v);
+  end = libsfp_fmt_fixed(got, v, prec);
+  *end = 0;
+
+  if (!strcmp(got, exp))
+    return 0;
+
+  printf("FAIL: %a prec %u: \"%s\", printf \"%s\"\n", v, prec, got, exp);
+  return 1;
+}
+
+int main(void)
+{
+  uint32_t bits, k;
+  uint8_t prec;
+  float v;
+  int fails = 0;
+
+  for (prec = 0; prec <= LIBSFP_FMT_PREC_MAX; ++prec) {
+
+    for (k = 0; k < sizeof(edge)/sizeof(edge[0]); ++k)
+      fails += check(edge[k], prec);
+
+    fails += check(NAN, prec);
+    fails += check(-NAN, prec);
+    fails += check(INFINITY, prec);
+    fails += check(-INFINITY, prec);
+
+    /* Ties and their neighbours: (k + 0.5)/10^prec */
+    for (k = 0; k < 20000; ++k) {
+      v = (k + 0.5f)/powf(10, prec);
+      fails += check(v, prec);
+      fails += check(nextafterf(v, 0), prec);
+      fails += check(nextafterf(v, INFINITY), prec);
+    }
+
+    /* Spread over all bit patterns (both signs, all exponents) */
+    for (bits = 0; bits < 0xFFFFFFFF - 16381; bits += 16381) {
+      memcpy(&v, &bits, sizeof(v));
+      fails += check(v, prec);
+    }
+
+    if (fails > 20)
+      break;
+  }
+
+  return (fails) ? 1 : 0;
+}
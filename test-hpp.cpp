@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <libsfp.hpp>
+#include <libsfp_decode.h>
+
+/* C++ views of example dump give the same raw and converted values
+ * as libsfp_decode */
+
+static int fails;
+
+static void expect(const char *name, bool ok)
+{
+  if (ok)
+    return;
+
+  printf("FAIL: %s\n", name);
+  ++fails;
+}
+
+/* Decoded string without trailing spaces */
+static std::string_view trimmed(const char *s)
+{
+  std::string_view v(s);
+  while ((!v.empty()) && (v.back() == ' '))
+    v.remove_suffix(1);
+  return v;
+}
+
+static uint16_t be16(const libsfp_u16_field_t &f)
+{
+  return static_cast<uint16_t>((f.d[0] << 8) | f.d[1]);
+}
+
+static void test_a0(const libsfp_dump_t &dump, const libsfp_decoded_t &d)
+{
+  libsfp::a0_view a0 = libsfp::view_a0(dump);
+  std::array<uint8_t, 3> oui = a0.vendor_oui();
+
+  expect("a0 data", a0.data() == reinterpret_cast<const std::byte*>(&dump.a0));
+  expect("identifier", a0.identifier() == d.identifier);
+  expect("ext identifier", a0.ext_identifier() == d.ext_identifier);
+  expect("connector", a0.connector() == d.connector);
+  expect("encoding", a0.encoding() == d.encoding);
+  expect("options", a0.options() == d.options);
+  expect("en options", a0.en_options() == d.en_options);
+  expect("wavelength", a0.wavelength() == d.wavelength);
+  expect("length smf", a0.length_smf() == d.length_smf);
+  expect("length om3", a0.length_om3() == d.length_om3);
+  expect("vendor oui", !std::memcmp(oui.data(), d.vendor_oui, oui.size()));
+  expect("transceiver", !std::memcmp(a0.transceiver().data(), d.transceiver,
+                                     sizeof(d.transceiver)));
+  expect("vendor", a0.vendor() == trimmed(d.vendor));
+  expect("part number", a0.partnum() == trimmed(d.partnum));
+  expect("revision", a0.revision() == trimmed(d.revision));
+  expect("serial", a0.serial() == trimmed(d.serial));
+  expect("has ddm", a0.has_ddm() == !!(d.flags & LIBSFP_DECODED_DDM));
+  expect("base checksum", a0.csum_base_ok() == !!(d.flags & LIBSFP_DECODED_CSUM_BASE));
+  expect("ext checksum", a0.csum_ext_ok() == !!(d.flags & LIBSFP_DECODED_CSUM_EXT));
+}
+
+static void test_a2(const libsfp_dump_t &dump, const libsfp_decoded_t &d)
+{
+  static const libsfp::channel chs[] = {
+    libsfp::channel::temp, libsfp::channel::voltage, libsfp::channel::bias,
+    libsfp::channel::txpower, libsfp::channel::rxpower
+  };
+  libsfp::a2_view a2 = libsfp::view_a2(dump);
+  libsfp_cal_t c = a2.cal(libsfp::view_a0(dump).external_cal());
+  const libsfp_u16_field_t *v = &dump.a2.dg.temperature;
+  const libsfp_u16_field_t *th = &dump.a2.th.temp_alarm_high;
+  char name[64];
+  uint32_t ch;
+
+  expect("a2 data", a2.data() == reinterpret_cast<const std::byte*>(&dump.a2));
+  expect("status", a2.status() == d.status);
+  expect("dmi checksum", a2.csum_dmi_ok() == !!(d.flags & LIBSFP_DECODED_CSUM_DMI));
+
+  for (ch = 0; ch < LIBSFP_CAL_CHANNELS; ++ch) {
+    snprintf(name, sizeof(name), "raw value of channel %u", ch);
+    expect(name, a2.raw(chs[ch]) == be16(v[ch]));
+    snprintf(name, sizeof(name), "thresholds of channel %u", ch);
+    expect(name, (a2.threshold(chs[ch], libsfp::condition::alarm_high) == be16(th[4*ch])) &&
+                 (a2.threshold(chs[ch], libsfp::condition::alarm_low) == be16(th[4*ch + 1])) &&
+                 (a2.threshold(chs[ch], libsfp::condition::warn_high) == be16(th[4*ch + 2])) &&
+                 (a2.threshold(chs[ch], libsfp::condition::warn_low) == be16(th[4*ch + 3])));
+  }
+
+  expect("temperature", a2.temperature(c) == d.values[LIBSFP_CAL_CH_TEMP]);
+  expect("voltage", a2.voltage(c) == d.values[LIBSFP_CAL_CH_VOLTAGE]);
+  expect("bias", a2.bias(c) == d.values[LIBSFP_CAL_CH_BIAS]);
+  expect("tx power", a2.txpower(c) == d.values[LIBSFP_CAL_CH_TXPOWER]);
+  expect("rx power", a2.rxpower(c) == d.values[LIBSFP_CAL_CH_RXPOWER]);
+}
+
+/* Views of short buffers are empty */
+static void test_from(const libsfp_dump_t &dump)
+{
+  std::span<const std::byte> a0 = std::as_bytes(std::span<const libsfp_A0_t, 1>(&dump.a0, 1));
+  std::span<const std::byte> a2 = std::as_bytes(std::span<const libsfp_A2_t, 1>(&dump.a2, 1));
+
+  expect("a0 view of bank", libsfp::a0_view::from(a0).has_value());
+  expect("a0 view of short buffer", !libsfp::a0_view::from(a0.first(libsfp::a0_view::min_size - 1)));
+  expect("a2 view of bank", libsfp::a2_view::from(a2).has_value());
+  expect("a2 view of short buffer", !libsfp::a2_view::from(a2.first(libsfp::a2_view::min_size - 1)));
+}
+
+static void test_handle(void)
+{
+  libsfp::handle h;
+  libsfp_t *p = h.get();
+  libsfp::handle m(std::move(h));
+
+  expect("moved handle", (!h) && m && (m.get() == p));
+
+  h = std::move(m);
+  expect("move assigned handle", h && (!m) && (h.get() == p));
+
+  libsfp_free(h.release());
+  expect("released handle", !h);
+}
+
+int main(void)
+{
+  const char *dir = getenv("srcdir");
+  char path[256];
+  libsfp_dump_t dump;
+  libsfp_decoded_t d;
+  FILE *f;
+  size_t n;
+
+  snprintf(path, sizeof(path), "%s/dumps/example.bin", (dir) ? dir : ".");
+  f = fopen(path, "rb");
+  if (!f) {
+    printf("FAIL: can't open %s\n", path);
+    return 1;
+  }
+
+  n = fread(&dump, 1, sizeof(dump), f);
+  fclose(f);
+
+  if ((n != sizeof(dump)) || libsfp_decode(&dump, &d)) {
+    printf("FAIL: can't decode %s\n", path);
+    return 1;
+  }
+
+  test_a0(dump, d);
+  test_a2(dump, d);
+  test_from(dump);
+  test_handle();
+
+  return (fails) ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include "libsfp.h"
+#include "libsfp_decode.h"
+#include "libsfp_metrics.h"
+
+/* OpenMetrics text of example dump matches dumps/example.metrics,
+ * rendered text never exceeds libsfp_metrics_size() */
+
+#define NPORTS  12
+
+static size_t load(const char *name, void *buf, size_t size)
+{
+  const char *dir = getenv("srcdir");
+  char path[256];
+  FILE *f;
+  size_t n;
+
+  snprintf(path, sizeof(path), "%s/dumps/%s", (dir) ? dir : ".", name);
+  f = fopen(path, "rb");
+  if (!f) {
+    printf("FAIL: can't open %s\n", path);
+    return 0;
+  }
+
+  n = fread(buf, 1, size, f);
+  fclose(f);
+
+  return n;
+}
+
+static int check_size(libsfp_metrics_t *m, const char *name)
+{
+  libsfp_sink_t *s;
+  size_t len;
+
+  s = libsfp_sink_create(0);
+  if ((!s) || libsfp_metrics_render(m, s)) {
+    printf("FAIL: %s: render\n", name);
+    libsfp_sink_free(s);
+    return 1;
+  }
+
+  len = libsfp_sink_len(s);
+  libsfp_sink_free(s);
+
+  if (len <= libsfp_metrics_size(m))
+    return 0;
+
+  printf("FAIL: %s: %zu bytes rendered, size %zu\n", name, len,
+         libsfp_metrics_size(m));
+  return 1;
+}
+
+/* Port 1 of 3 has example module, others are empty */
+static int test_golden(void)
+{
+  static char exp[8192];
+  libsfp_dump_t dump;
+  libsfp_decoded_t d;
+  libsfp_metrics_t *m;
+  libsfp_sink_t *s;
+  size_t n, len;
+  int fails = 0;
+
+  if ((load("example.bin", &dump, sizeof(dump)) != sizeof(dump)) ||
+      (!(n = load("example.metrics", exp, sizeof(exp)))))
+    return 1;
+
+  m = libsfp_metrics_create(3);
+  s = libsfp_sink_create(0);
+  if ((!m) || (!s))
+    return 1;
+
+  libsfp_decode(&dump, &d);
+  libsfp_metrics_set(m, 1, &d);
+
+  /* Second scrape renders cached text */
+  libsfp_metrics_render(m, s);
+  libsfp_sink_reset(s);
+  libsfp_metrics_render(m, s);
+  len = libsfp_sink_len(s);
+
+  if ((len != n) || memcmp(libsfp_sink_data(s), exp, n)) {
+    printf("FAIL: example text differs from dumps/example.metrics:\n%.*s",
+           (int)len, libsfp_sink_data(s));
+    ++fails;
+  }
+
+  fails += check_size(m, "example");
+
+  libsfp_sink_free(s);
+  libsfp_metrics_free(m);
+
+  return fails;
+}
+
+/* Longest labels (every byte escaped or two byte UTF-8) and values */
+static int test_size(void)
+{
+  static const float values[] = {-FLT_MAX, FLT_MAX, -1e-5f, NAN, -INFINITY};
+  static const uint8_t label[] = {'"', '\\', 0xFF};
+  libsfp_decoded_t d;
+  libsfp_metrics_t *m;
+  float *f;
+  char name[32];
+  uint32_t i, k, port;
+  int fails = 0;
+
+  m = libsfp_metrics_create(NPORTS);
+  if (!m)
+    return 1;
+
+  for (i = 0; i < sizeof(values)/sizeof(values[0]); ++i) {
+    for (k = 0; k < sizeof(label); ++k) {
+
+      memset(&d, 0, sizeof(d));
+      memset(d.vendor, label[k], sizeof(d.vendor) - 1);
+      memset(d.partnum, label[k], sizeof(d.partnum) - 1);
+      memset(d.revision, label[k], sizeof(d.revision) - 1);
+      memset(d.serial, label[k], sizeof(d.serial) - 1);
+      memset(d.aw, 0x0F, sizeof(d.aw));
+      d.flags = LIBSFP_DECODED_DDM | LIBSFP_DECODED_AWFLAGS;
+
+      for (f = d.values; f < d.values + LIBSFP_DECODED_CHANNELS; ++f)
+        *f = values[i];
+      for (f = &d.th[0].alarm_high; f < (float*)(d.th + LIBSFP_DECODED_CHANNELS); ++f)
+        *f = values[i];
+
+      for (port = 0; port < NPORTS; ++port)
+        libsfp_metrics_set(m, port, &d);
+
+      snprintf(name, sizeof(name), "value %g label %02x", values[i], label[k]);
+      fails += check_size(m, name);
+    }
+  }
+
+  libsfp_metrics_free(m);
+
+  return fails;
+}
+
+int main(void)
+{
+  int fails = 0;
+
+  fails += test_golden();
+  fails += test_size();
+
+  return (fails) ? 1 : 0;
+}
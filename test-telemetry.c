@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <string.h>
+#include "libsfp.h"
+#include "libsfp_telemetry.h"
+
+/* Telemetry store keeps status (A2 byte 110) and extended status
+ * (A2 byte 118) of module read through library handle */
+
+/* Module image served by read callback */
+static uint8_t image[2][256];
+
+static int read_image(void *udata, uint8_t addr, uint16_t start,
+                      uint16_t count, void *data)
+{
+  (void)udata;
+  memcpy(data, &image[addr != LIBSFP_DEF_A0_ADDRESS][start], count);
+  return 0;
+}
+
+static int test(uint32_t flags)
+{
+  libsfp_telemetry_t *t;
+  libsfp_t *h;
+  const uint16_t *st;
+  int32_t i;
+  int fails = 0;
+
+  h = libsfp_create();
+  t = libsfp_telemetry_create(1, 4);
+  if ((!h) || (!t))
+    return 1;
+
+  libsfp_set_readreg_callback(h, read_image);
+  libsfp_set_flags(h, flags);
+
+  i = libsfp_telemetry_index(t, 0, 2);
+  st = libsfp_telemetry_flags(t, LIBSFP_TELEMETRY_STATUS);
+
+  if ((i < 0) || (!st) || libsfp_telemetry_update(t, 0, 2, h, 0)) {
+    printf("FAIL: telemetry update (flags %x)\n", flags);
+    ++fails;
+  } else if (st[i] != ((image[1][LIBSFP_OFS_A2_STATUSCONTROL] << 8) |
+                       image[1][LIBSFP_OFS_A2_EXT_STATUS_CONTROL])) {
+    printf("FAIL: status flags %04x (flags %x)\n", st[i], flags);
+    ++fails;
+  }
+
+  libsfp_telemetry_free(t);
+  libsfp_free(h);
+
+  return fails;
+}
+
+int main(void)
+{
+  int fails = 0;
+
+  image[0][LIBSFP_OFS_A0_IDENTIFIER] = 0x03;
+  image[0][LIBSFP_OFS_A0_DIAGMON_TYPE] = LIBSFP_A0_DIAGMON_TYPE_DDM;
+  image[1][LIBSFP_OFS_A2_STATUSCONTROL] = 0x82;
+  image[1][LIBSFP_OFS_A2_EXT_STATUS_CONTROL] = 0x05;
+
+  fails += test(0);
+  fails += test(LIBSFP_FLAGS_CACHE);
+
+  return (fails) ? 1 : 0;
+}
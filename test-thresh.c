@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <string.h>
+#include "libsfp.h"
+#include "libsfp_cal.h"
+#include "libsfp_thresh.h"
+
+/* Threshold classification: raise and clear with hysteresis, debounce
+ * and operator overrides of A2 thresholds (internal calibration,
+ * temperature in 1/256 C) */
+
+#define AH  LIBSFP_THRESH_BIT(LIBSFP_CAL_CH_TEMP, LIBSFP_THRESH_ALARM_HIGH)
+#define AL  LIBSFP_THRESH_BIT(LIBSFP_CAL_CH_TEMP, LIBSFP_THRESH_ALARM_LOW)
+#define WH  LIBSFP_THRESH_BIT(LIBSFP_CAL_CH_TEMP, LIBSFP_THRESH_WARN_HIGH)
+#define WL  LIBSFP_THRESH_BIT(LIBSFP_CAL_CH_TEMP, LIBSFP_THRESH_WARN_LOW)
+
+static libsfp_cal_t cal;
+static libsfp_thresholds_fields_t th;
+
+static void set_u16(libsfp_u16_field_t *f, uint16_t v)
+{
+  f->d[0] = v >> 8;
+  f->d[1] = v;
+}
+
+/* A2 thresholds: temperature 70/-10 alarm, 60/0 warning,
+ * other channels never trigger */
+static void make_thresholds(void)
+{
+  libsfp_u16_field_t *f = &th.temp_alarm_high;
+  int i;
+
+  for (i = 4; i < 4*LIBSFP_CAL_CHANNELS; i += 2) {
+    set_u16(&f[i], 0xFFFF);
+    set_u16(&f[i + 1], 0);
+  }
+
+  set_u16(&th.temp_alarm_high, 70*256);
+  set_u16(&th.temp_alarm_low, (uint16_t)(-10*256));
+  set_u16(&th.temp_warn_high, 60*256);
+  set_u16(&th.temp_warn_low, 0);
+}
+
+/* Diagnostics sample with temperature raw value */
+static void sample(libsfp_rtdiagnostics_fields_t *dg, int32_t raw)
+{
+  memset(dg, 0, sizeof(*dg));
+  set_u16(&dg->temperature, (uint16_t)raw);
+  set_u16(&dg->voltage, 33000);
+  set_u16(&dg->bias_current, 3000);
+  set_u16(&dg->tx_power, 5000);
+  set_u16(&dg->rx_power, 5000);
+}
+
+static int expect(const char *name, uint32_t got, uint32_t exp)
+{
+  if (got == exp)
+    return 0;
+
+  printf("FAIL: %s: conditions %05x, expected %05x\n", name, got, exp);
+  return 1;
+}
+
+/* Feed temperature samples (C) and check reported state after each */
+static int feed(const char *name, const libsfp_thresh_t *t,
+                libsfp_thresh_state_t *s, const float *temp,
+                const uint32_t *exp, int n)
+{
+  libsfp_rtdiagnostics_fields_t dg;
+  char step[64];
+  int i, fails = 0;
+
+  for (i = 0; i < n; ++i) {
+    sample(&dg, (int32_t)(temp[i]*256));
+    snprintf(step, sizeof(step), "%s sample %d (%.2f C)", name, i, temp[i]);
+    fails += expect(step, libsfp_thresh_eval(t, s, &dg), exp[i]);
+  }
+
+  return fails;
+}
+
+static int test_check(void)
+{
+  libsfp_thresh_t t;
+  libsfp_rtdiagnostics_fields_t dg;
+  int fails = 0;
+
+  libsfp_thresh_init(&t, &th);
+
+  sample(&dg, 50*256);
+  fails += expect("check 50 C", libsfp_thresh_check(&t, &dg), 0);
+  sample(&dg, 70*256);
+  fails += expect("check 70 C", libsfp_thresh_check(&t, &dg), WH);
+  sample(&dg, 70*256 + 1);
+  fails += expect("check above 70 C", libsfp_thresh_check(&t, &dg), AH | WH);
+  sample(&dg, -1);
+  fails += expect("check below 0 C", libsfp_thresh_check(&t, &dg), WL);
+  sample(&dg, -11*256);
+  fails += expect("check -11 C", libsfp_thresh_check(&t, &dg), AL | WL);
+
+  return fails;
+}
+
+static int test_hysteresis(void)
+{
+  static const float temp[] = {71, 68.5, 68, 59, 58, -1, 1.5, 2};
+  static const uint32_t exp[] = {AH | WH, AH | WH, WH, WH, 0, WL, WL, 0};
+  libsfp_thresh_t t;
+  libsfp_thresh_state_t s;
+
+  libsfp_thresh_init(&t, &th);
+  libsfp_thresh_set_hysteresis(&t, &cal, LIBSFP_CAL_CH_TEMP, 2);
+  memset(&s, 0, sizeof(s));
+
+  return feed("hysteresis", &t, &s, temp, exp, sizeof(temp)/sizeof(temp[0]));
+}
+
+static int test_debounce(void)
+{
+  /* Single sample blips restart counting in both directions */
+  static const float temp[] = {65, 65, 71, 71, 50, 71, 71, 71, 50, 50, 71, 50, 50, 50};
+  static const uint32_t exp[] = {0, 0, WH, WH, WH, WH, WH, AH | WH, AH | WH,
+                                 AH | WH, AH | WH, AH | WH, AH | WH, 0};
+  libsfp_thresh_t t;
+  libsfp_thresh_state_t s;
+  int fails = 0;
+
+  libsfp_thresh_init(&t, &th);
+
+  if ((!libsfp_thresh_set_debounce(&t, 0)) ||
+      (!libsfp_thresh_set_debounce(&t, 256)) ||
+      (t.debounce != 1)) {
+    printf("FAIL: debounce out of range accepted\n");
+    ++fails;
+  }
+
+  if (libsfp_thresh_set_debounce(&t, 3)) {
+    printf("FAIL: debounce 3 rejected\n");
+    return fails + 1;
+  }
+
+  memset(&s, 0, sizeof(s));
+
+  return fails + feed("debounce", &t, &s, temp, exp, sizeof(temp)/sizeof(temp[0]));
+}
+
+static int test_override(void)
+{
+  libsfp_thresh_t t;
+  libsfp_rtdiagnostics_fields_t dg;
+  int fails = 0;
+
+  libsfp_thresh_init(&t, &th);
+
+  /* Operator alarm at 50.1 C: greatest raw not above it is 12825 */
+  libsfp_thresh_set(&t, &cal, LIBSFP_CAL_CH_TEMP, LIBSFP_THRESH_ALARM_HIGH, 50.1);
+  sample(&dg, 12825);
+  fails += expect("override at level", libsfp_thresh_check(&t, &dg), 0);
+  sample(&dg, 12826);
+  fails += expect("override above level", libsfp_thresh_check(&t, &dg), AH);
+
+  /* A2 warning threshold stays in effect */
+  sample(&dg, 65*256);
+  fails += expect("override keeps A2 warning", libsfp_thresh_check(&t, &dg), AH | WH);
+
+  /* Low override: alarm below 5 C */
+  libsfp_thresh_set(&t, &cal, LIBSFP_CAL_CH_TEMP, LIBSFP_THRESH_ALARM_LOW, 5);
+  sample(&dg, 5*256);
+  fails += expect("low override at level", libsfp_thresh_check(&t, &dg), 0);
+  sample(&dg, 5*256 - 1);
+  fails += expect("low override below level", libsfp_thresh_check(&t, &dg), AL);
+
+  if (libsfp_thresh_set(&t, &cal, LIBSFP_CAL_CHANNELS, 0, 1) != -1) {
+    printf("FAIL: override of unknown channel accepted\n");
+    ++fails;
+  }
+
+  return fails;
+}
+
+int main(void)
+{
+  int fails = 0;
+
+  libsfp_cal_init(&cal, 0);
+  make_thresholds();
+
+  fails += test_check();
+  fails += test_hysteresis();
+  fails += test_debounce();
+  fails += test_override();
+
+  return (fails) ? 1 : 0;
+}